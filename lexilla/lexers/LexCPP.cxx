@@ -15,6 +15,7 @@
 #include <string_view>
 #include <vector>
 #include <map>
+#include <memory>
 #include <algorithm>
 #include <iterator>
 #include <functional>
@@ -32,6 +33,7 @@
 #include "LexerModule.h"
 #include "OptionSet.h"
 #include "SparseState.h"
+#include "LexerCheckpoints.h"
 #include "SubStyles.h"
 
 using namespace Scintilla;
@@ -237,6 +239,10 @@ struct PPDefinition {
 	PPDefinition(Sci_Position line_, const std::string &key_, const std::string &value_, bool isUndef_ = false, const std::string &arguments_="") :
 		line(line_), key(key_), value(value_), isUndef(isUndef_), arguments(arguments_) {
 	}
+	bool operator==(const PPDefinition &other) const noexcept {
+		return (line == other.line) && (key == other.key) && (value == other.value) &&
+			(isUndef == other.isUndef) && (arguments == other.arguments);
+	}
 };
 
 constexpr int inactiveFlag = 0x40;
@@ -504,6 +510,8 @@ class LexerCPP : public ILexer5 {
 	CharacterSet setWordStart;
 	PPStates vlls;
 	std::vector<PPDefinition> ppDefineHistory;
+	// Definitions from before the most recent change on lines that have not been lexed again
+	std::vector<PPDefinition> ppDefinePrevious;
 	WordList keywords;
 	WordList keywords2;
 	WordList keywords3;
@@ -527,6 +535,8 @@ class LexerCPP : public ILexer5 {
 	};
 	typedef std::map<std::string, SymbolValue> SymbolTable;
 	SymbolTable preprocessorDefinitionsStart;
+	// Checkpoints share tables with lexing which copies a shared table before changing it
+	Checkpoints<std::shared_ptr<SymbolTable>> ppCheckpoints;
 	OptionsCPP options;
 	OptionSetCPP osCPP;
 	EscapeSequence escapeSeq;
@@ -697,6 +707,7 @@ Sci_Position SCI_METHOD LexerCPP::PropertySet(const char *key, const char *val)
 				setWord.Add('$');
 			}
 		}
+		ppCheckpoints.Clear();
 		return 0;
 	}
 	return -1;
@@ -740,6 +751,7 @@ Sci_Position SCI_METHOD LexerCPP::WordListSet(int n, const char *wl) {
 			if (n == 4) {
 				// Rebuild preprocessorDefinitions
 				preprocessorDefinitionsStart.clear();
+				ppCheckpoints.Clear();
 				for (int nDefinition = 0; nDefinition < ppDefinitions.Length(); nDefinition++) {
 					const char *cpDefinition = ppDefinitions.WordAt(nDefinition);
 					const char *cpEquals = strchr(cpDefinition, '=');
@@ -821,28 +833,45 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 	StyleContext sc(startPos, length, initStyle, styler);
 	LinePPState preproc = vlls.ForLine(lineCurrent);
 
-	bool definitionsChanged = false;
-
 	// Truncate ppDefineHistory before current line
 
-	if (!options.updatePreprocessor)
+	if (!options.updatePreprocessor) {
 		ppDefineHistory.clear();
-
-	const std::vector<PPDefinition>::iterator itInvalid = std::find_if(
-		ppDefineHistory.begin(), ppDefineHistory.end(),
-		[lineCurrent](const PPDefinition &p) noexcept { return p.line >= lineCurrent; });
-	if (itInvalid != ppDefineHistory.end()) {
-		ppDefineHistory.erase(itInvalid, ppDefineHistory.end());
-		definitionsChanged = true;
+		ppDefinePrevious.clear();
 	}
 
-	SymbolTable preprocessorDefinitions = preprocessorDefinitionsStart;
-	for (const PPDefinition &ppDef : ppDefineHistory) {
-		if (ppDef.isUndef)
-			preprocessorDefinitions.erase(ppDef.key);
+	const Sci_Position lineStartLex = lineCurrent;
+	const auto lineBefore = [](Sci_Position line) noexcept {
+		return [line](const PPDefinition &p) noexcept { return p.line < line; };
+	};
+	const std::vector<PPDefinition>::iterator itInvalid = std::partition_point(
+		ppDefineHistory.begin(), ppDefineHistory.end(), lineBefore(lineCurrent));
+	// Keep the truncated definitions to see whether lexing converges on the same ones
+	ppDefinePrevious.erase(ppDefinePrevious.begin(), std::partition_point(
+		ppDefinePrevious.begin(), ppDefinePrevious.end(), lineBefore(lineCurrent)));
+	ppDefinePrevious.insert(ppDefinePrevious.begin(), itInvalid, ppDefineHistory.end());
+	ppDefineHistory.erase(itInvalid, ppDefineHistory.end());
+
+	// Start from the nearest checkpoint and apply the definitions made after it
+	ppCheckpoints.InvalidateAfter(lineCurrent);
+	std::shared_ptr<SymbolTable> preprocessorDefinitions;
+	const Sci_Position lineCheckpoint = ppCheckpoints.Restore(lineCurrent, preprocessorDefinitions);
+	if (!preprocessorDefinitions)
+		preprocessorDefinitions = std::make_shared<SymbolTable>(preprocessorDefinitionsStart);
+	const auto definitionsToChange = [&preprocessorDefinitions]() -> SymbolTable & {
+		if (preprocessorDefinitions.use_count() > 1)
+			preprocessorDefinitions = std::make_shared<SymbolTable>(*preprocessorDefinitions);
+		return *preprocessorDefinitions;
+	};
+	for (std::vector<PPDefinition>::const_iterator itDef = std::partition_point(
+		ppDefineHistory.cbegin(), ppDefineHistory.cend(), lineBefore(lineCheckpoint));
+		itDef != ppDefineHistory.cend(); ++itDef) {
+		if (itDef->isUndef)
+			definitionsToChange().erase(itDef->key);
 		else
-			preprocessorDefinitions[ppDef.key] = SymbolValue(ppDef.value, ppDef.arguments);
+			definitionsToChange()[itDef->key] = SymbolValue(itDef->value, itDef->arguments);
 	}
+	ppCheckpoints.SaveStart(lineCurrent, preprocessorDefinitions);
 
 	std::string rawStringTerminator = rawStringTerminators.ValueAt(lineCurrent-1);
 	SparseState<std::string> rawSTNew(lineCurrent);
@@ -873,6 +902,7 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 			lastWordWasUUID = false;
 			isIncludePreprocessor = false;
 			inRERange = false;
+			ppCheckpoints.Save(lineCurrent, preprocessorDefinitions);
 			if (preproc.IsInactive()) {
 				activitySet = inactiveFlag;
 				sc.SetState(sc.state | activitySet);
@@ -1330,11 +1360,11 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 							const bool isIfDef = sc.Match("ifdef");
 							const int startRest = isIfDef ? 5 : 6;
 							const std::string restOfLine = GetRestOfLine(styler, sc.currentPos + startRest + 1, false);
-							const bool foundDef = preprocessorDefinitions.find(restOfLine) != preprocessorDefinitions.end();
+							const bool foundDef = preprocessorDefinitions->find(restOfLine) != preprocessorDefinitions->end();
 							preproc.StartSection(isIfDef == foundDef);
 						} else if (sc.Match("if")) {
 							const std::string restOfLine = GetRestOfLine(styler, sc.currentPos + 2, true);
-							const bool ifGood = EvaluateExpression(restOfLine, preprocessorDefinitions);
+							const bool ifGood = EvaluateExpression(restOfLine, *preprocessorDefinitions);
 							preproc.StartSection(ifGood);
 						} else if (sc.Match("else")) {
 							// #else is shown as active if either preceding or following section is active
@@ -1367,7 +1397,7 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 									assert(sc.state == (SCE_C_PREPROCESSOR | inactiveFlag));
 									// Similar to #if
 									std::string restOfLine = GetRestOfLine(styler, sc.currentPos + 4, true);
-									const bool ifGood = EvaluateExpression(restOfLine, preprocessorDefinitions);
+									const bool ifGood = EvaluateExpression(restOfLine, *preprocessorDefinitions);
 									if (ifGood) {
 										preproc.InvertCurrentLevel();
 										activitySet = preproc.ActiveState();
@@ -1408,9 +1438,8 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 									std::string value;
 									if (startValue < restOfLine.length())
 										value = restOfLine.substr(startValue);
-									preprocessorDefinitions[key] = SymbolValue(value, args);
+									definitionsToChange()[key] = SymbolValue(value, args);
 									ppDefineHistory.push_back(PPDefinition(lineCurrent, key, value, false, args));
-									definitionsChanged = true;
 								} else {
 									// Value
 									size_t startValue = endName;
@@ -1419,9 +1448,8 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 									std::string value = restOfLine.substr(startValue);
 									if (OnlySpaceOrTab(value))
 										value = "1";	// No value defaults to 1
-									preprocessorDefinitions[key] = value;
+									definitionsToChange()[key] = value;
 									ppDefineHistory.push_back(PPDefinition(lineCurrent, key, value));
-									definitionsChanged = true;
 								}
 							}
 						} else if (sc.Match("undef")) {
@@ -1430,9 +1458,8 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 								Tokens tokens = Tokenize(restOfLine);
 								if (!tokens.empty()) {
 									const std::string key = tokens[0];
-									preprocessorDefinitions.erase(key);
+									definitionsToChange().erase(key);
 									ppDefineHistory.push_back(PPDefinition(lineCurrent, key, "", true));
-									definitionsChanged = true;
 								}
 							}
 						}
@@ -1457,6 +1484,17 @@ void SCI_METHOD LexerCPP::Lex(Sci_PositionU startPos, Sci_Position length, int i
 		continuationLine = false;
 		sc.Forward();
 	}
+	// Later lines can only be styled differently when the definitions on the lines lexed
+	// differ from before so lexing has not converged.
+	const std::vector<PPDefinition>::const_iterator itLexed = std::partition_point(
+		ppDefineHistory.cbegin(), ppDefineHistory.cend(), lineBefore(lineStartLex));
+	const std::vector<PPDefinition>::const_iterator itLexedEnd = std::partition_point(
+		itLexed, ppDefineHistory.cend(), lineBefore(lineCurrent));
+	const std::vector<PPDefinition>::iterator itPreviousEnd = std::partition_point(
+		ppDefinePrevious.begin(), ppDefinePrevious.end(), lineBefore(lineCurrent));
+	const bool definitionsChanged = !std::equal(itLexed, itLexedEnd,
+		ppDefinePrevious.begin(), itPreviousEnd);
+	ppDefinePrevious.erase(ppDefinePrevious.begin(), itPreviousEnd);
 	const bool rawStringsChanged = rawStringTerminators.Merge(rawSTNew, lineCurrent);
 	if (definitionsChanged || rawStringsChanged)
 		styler.ChangeLexerState(startPos, startPos + length);
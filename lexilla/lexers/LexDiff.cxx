@@ -161,4 +161,4 @@ static const char *const emptyWordListDesc[] = {
 	0
 };
 
-LexerModule lmDiff(SCLEX_DIFF, ColouriseDiffDoc, "diff", FoldDiffDoc, emptyWordListDesc);
+LexerModule lmDiff(SCLEX_DIFF, ColouriseDiffDoc, "diff", FoldDiffDoc, emptyWordListDesc, nullptr, 0, lcLineChunks);
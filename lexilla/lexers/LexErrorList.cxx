@@ -412,4 +412,4 @@ const char *const emptyWordListDesc[] = {
 
 }
 
-LexerModule lmErrorList(SCLEX_ERRORLIST, ColouriseErrorListDoc, "errorlist", 0, emptyWordListDesc);
+LexerModule lmErrorList(SCLEX_ERRORLIST, ColouriseErrorListDoc, "errorlist", 0, emptyWordListDesc, nullptr, 0, lcLineChunks);
@@ -142,4 +142,4 @@ static const char *const emptyWordListDesc[] = {
 	0
 };
 
-LexerModule lmMake(SCLEX_MAKEFILE, ColouriseMakeDoc, "makefile", 0, emptyWordListDesc);
+LexerModule lmMake(SCLEX_MAKEFILE, ColouriseMakeDoc, "makefile", 0, emptyWordListDesc, nullptr, 0, lcLineChunks);
@@ -172,4 +172,4 @@ static const char *const emptyWordListDesc[] = {
 	0
 };
 
-LexerModule lmProps(SCLEX_PROPERTIES, ColourisePropsDoc, "props", FoldPropsDoc, emptyWordListDesc);
+LexerModule lmProps(SCLEX_PROPERTIES, ColourisePropsDoc, "props", FoldPropsDoc, emptyWordListDesc, nullptr, 0, lcLineChunks);
@@ -19,6 +19,85 @@ using namespace Lexilla;
 
 namespace Lexilla {
 
+void LexAccessor::SetWindow(Sci_Position position, Sci_Position size) noexcept {
+	startPos = position - size / 8;
+	if (startPos + size > lenDoc)
+		startPos = lenDoc - size;
+	if (startPos < 0)
+		startPos = 0;
+	endPos = startPos + size;
+	if (endPos > lenDoc)
+		endPos = lenDoc;
+}
+
+bool LexAccessor::FillDirect(Sci_Position position, Sci_Position size) {
+	SetWindow(position, size);
+	if (endPos <= startPos)
+		return false;
+	text = pAccess5->ContiguousRangePointer(startPos, endPos - startPos);
+	return text != nullptr;
+}
+
+void LexAccessor::Fill(Sci_Position position) {
+	// Ranges that span the document's gap are not contiguous so try the whole
+	// document, then a large window, then a window the size of the copy.
+	if (pAccess5 && (FillDirect(position, lenDoc) ||
+		FillDirect(position, directSize) || FillDirect(position, windowSize))) {
+		return;
+	}
+
+	SetWindow(position, windowSize);
+	buf.resize(windowSize + 1);
+	pAccess->GetCharRange(buf.data(), startPos, endPos-startPos);
+	buf[endPos-startPos] = '\0';
+	text = buf.c_str();
+	if (windowSize < maxBufferSize)
+		windowSize *= 2;
+}
+
+void LexAccessor::Flush() {
+	if (validLen <= 0) {
+		return;
+	}
+	if (pAccess5) {
+		pAccess5->SetStyleRuns(validRuns, runLengths, runStyles);
+	} else {
+		// Older documents are sent long runs directly and shorter runs expanded into bytes
+		char styleBuf[bufferSize];
+		Sci_Position filled = 0;
+		for (int run = 0; run < validRuns; run++) {
+			const Sci_Position length = runLengths[run];
+			if (filled + length > bufferSize) {
+				if (filled > 0) {
+					pAccess->SetStyles(filled, styleBuf);
+					filled = 0;
+				}
+				if (length >= bufferSize) {
+					pAccess->SetStyleFor(length, runStyles[run]);
+					continue;
+				}
+			}
+			memset(styleBuf + filled, runStyles[run], length);
+			filled += length;
+		}
+		if (filled > 0) {
+			pAccess->SetStyles(filled, styleBuf);
+		}
+	}
+	startPosStyling += validLen;
+	validLen = 0;
+	validRuns = 0;
+}
+
+char LexAccessor::FillAndGet(Sci_Position position, char chDefault) {
+	Fill(position);
+	if (position < startPos || position >= endPos) {
+		// Position is outside range of document
+		return chDefault;
+	}
+	return text[position - startPos];
+}
+
 bool LexAccessor::MatchIgnoreCase(Sci_Position pos, const char *s) {
 	assert(s);
 	for (; *s; s++, pos++) {
@@ -35,7 +114,7 @@ void LexAccessor::GetRange(Sci_PositionU startPos_, Sci_PositionU endPos_, char
 	endPos_ = std::min(endPos_, startPos_ + len - 1);
 	len = endPos_ - startPos_;
 	if (startPos_ >= static_cast<Sci_PositionU>(startPos) && endPos_ <= static_cast<Sci_PositionU>(endPos)) {
-		const char * const p = buf + (startPos_ - startPos);
+		const char * const p = text + (startPos_ - startPos);
 		memcpy(s, p, len);
 	} else {
 		pAccess->GetCharRange(s, startPos_, len);
@@ -15,50 +15,57 @@ enum class EncodingType { eightBit, unicode, dbcs };
 class LexAccessor {
 private:
 	Scintilla::IDocument *pAccess;
+	/** Set when the document can return pointers to its text so it need not be copied
+	 * and can set styles a run at a time. */
+	Scintilla::IDocument5 *pAccess5;
 	enum {extremePosition=0x7FFFFFFF};
 	/** @a bufferSize is a trade off between time taken to copy the characters
-	 * and retrieval overhead.
-	 * @a slopSize positions the buffer before the desired position
-	 * in case there is some backtracking. */
-	enum {bufferSize=4000, slopSize=bufferSize/8};
-	char buf[bufferSize+1];
+	 * and retrieval overhead. It is the initial size of the copied window which doubles
+	 * on each refill up to @a maxBufferSize so that long or backtracking lexes refill less.
+	 * @a directSize is the size of windows read without copying when the whole
+	 * document is not contiguous.
+	 * Windows are positioned an eighth of their size before the desired position
+	 * in case there is some backtracking.
+	 * Styles are held as up to @a runsSize runs and flushed when they cover @a bufferSize. */
+	enum {bufferSize=4000, maxBufferSize=bufferSize*16, directSize=0x100000, runsSize=bufferSize/4};
+	std::string buf;
+	const char *text;
+	Sci_Position windowSize;
 	Sci_Position startPos;
 	Sci_Position endPos;
 	int codePage;
 	enum EncodingType encodingType;
 	Sci_Position lenDoc;
-	char styleBuf[bufferSize];
+	Sci_Position runLengths[runsSize];
+	char runStyles[runsSize];
+	int validRuns;
 	Sci_Position validLen;
 	Sci_PositionU startSeg;
 	Sci_Position startPosStyling;
 	int documentVersion;
 
-	void Fill(Sci_Position position) {
-		startPos = position - slopSize;
-		if (startPos + bufferSize > lenDoc)
-			startPos = lenDoc - bufferSize;
-		if (startPos < 0)
-			startPos = 0;
-		endPos = startPos + bufferSize;
-		if (endPos > lenDoc)
-			endPos = lenDoc;
-
-		pAccess->GetCharRange(buf, startPos, endPos-startPos);
-		buf[endPos-startPos] = '\0';
-	}
+	void SetWindow(Sci_Position position, Sci_Position size) noexcept;
+	bool FillDirect(Sci_Position position, Sci_Position size);
+	void Fill(Sci_Position position);
+	// Out of line so operator[] and SafeGetCharAt stay small enough to inline.
+	char FillAndGet(Sci_Position position, char chDefault);
 
 public:
 	explicit LexAccessor(Scintilla::IDocument *pAccess_) :
-		pAccess(pAccess_), startPos(extremePosition), endPos(0),
+		pAccess(pAccess_), pAccess5(nullptr), text(""), windowSize(bufferSize),
+		startPos(extremePosition), endPos(0),
 		codePage(pAccess->CodePage()),
 		encodingType(EncodingType::eightBit),
 		lenDoc(pAccess->Length()),
-		validLen(0),
+		validRuns(0), validLen(0),
 		startSeg(0), startPosStyling(0),
 		documentVersion(pAccess->Version()) {
-		// Prevent warnings by static analyzers about uninitialized buf and styleBuf.
-		buf[0] = 0;
-		styleBuf[0] = 0;
+		if (documentVersion >= Scintilla::dvRelease5) {
+			pAccess5 = static_cast<Scintilla::IDocument5 *>(pAccess);
+		}
+		// Prevent warnings by static analyzers about uninitialized runs.
+		runLengths[0] = 0;
+		runStyles[0] = 0;
 		switch (codePage) {
 		case 65001:
 			encodingType = EncodingType::unicode;
@@ -76,9 +83,9 @@ public:
 	}
 	char operator[](Sci_Position position) {
 		if (position < startPos || position >= endPos) {
-			Fill(position);
+			return FillAndGet(position, '\0');
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 	Scintilla::IDocument *MultiByteAccess() const noexcept {
 		return pAccess;
@@ -86,13 +93,9 @@ public:
 	/** Safe version of operator[], returning a defined value for invalid position. */
 	char SafeGetCharAt(Sci_Position position, char chDefault=' ') {
 		if (position < startPos || position >= endPos) {
-			Fill(position);
-			if (position < startPos || position >= endPos) {
-				// Position is outside range of document
-				return chDefault;
-			}
+			return FillAndGet(position, chDefault);
 		}
-		return buf[position - startPos];
+		return text[position - startPos];
 	}
 	bool IsLeadByte(char ch) const {
 		return
@@ -132,7 +135,14 @@ public:
 	int BufferStyleAt(Sci_Position position) const {
 		const Sci_Position index = position - startPosStyling;
 		if (index >= 0 && index < validLen) {
-			return static_cast<unsigned char>(styleBuf[index]);
+			// Search from the most recent run as lexers mostly look at recent styles
+			Sci_Position runStart = validLen;
+			for (int run = validRuns - 1; run >= 0; run--) {
+				runStart -= runLengths[run];
+				if (index >= runStart) {
+					return static_cast<unsigned char>(runStyles[run]);
+				}
+			}
 		}
 		return static_cast<unsigned char>(pAccess->StyleAt(position));
 	}
@@ -151,13 +161,7 @@ public:
 	Sci_Position Length() const {
 		return lenDoc;
 	}
-	void Flush() {
-		if (validLen > 0) {
-			pAccess->SetStyles(validLen, styleBuf);
-			startPosStyling += validLen;
-			validLen = 0;
-		}
-	}
+	void Flush();
 	int GetLineState(Sci_Position line) const {
 		return pAccess->GetLineState(line);
 	}
@@ -183,18 +187,21 @@ public:
 				return;
 			}
 
-			if (validLen + (pos - startSeg + 1) >= bufferSize)
-				Flush();
+			const Sci_Position length = pos - startSeg + 1;
 			const char attr = static_cast<char>(chAttr);
-			if (validLen + (pos - startSeg + 1) >= bufferSize) {
-				// Too big for buffer so send directly
-				pAccess->SetStyleFor(pos - startSeg + 1, attr);
+			assert((startPosStyling + validLen + length) <= Length());
+			if (validRuns > 0 && runStyles[validRuns - 1] == attr) {
+				runLengths[validRuns - 1] += length;
 			} else {
-				for (Sci_PositionU i = startSeg; i <= pos; i++) {
-					assert((startPosStyling + validLen) < Length());
-					styleBuf[validLen++] = attr;
-				}
+				if (validRuns == runsSize)
+					Flush();
+				runLengths[validRuns] = length;
+				runStyles[validRuns] = attr;
+				validRuns++;
 			}
+			validLen += length;
+			if (validLen >= bufferSize)
+				Flush();
 		}
 		startSeg = pos+1;
 	}
@@ -0,0 +1,109 @@
+// Scintilla source code edit control
+/** @file LexerCheckpoints.h
+ ** Hold snapshots of lexer state taken every few lines so that lexing can resume
+ ** from the nearest snapshot before a change instead of from the start of the document.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef LEXERCHECKPOINTS_H
+#define LEXERCHECKPOINTS_H
+
+namespace Lexilla {
+
+/**
+ * Checkpoints of type T are saved at the start of every interval'th line as lexing passes.
+ * They are saved in order so the first unsaved checkpoint is always the next one due.
+ * Equal neighbouring states are only stored once by SparseState.
+ * When there would be more than maximum checkpoints, the interval is doubled and
+ * every other checkpoint dropped, so memory is bounded for documents with many lines.
+ * The state where lexing last started is also kept as repeated edits to one line
+ * start lexing from the same line.
+ */
+template <typename T>
+class Checkpoints {
+	Sci_Position intervalInitial;
+	Sci_Position interval;
+	Sci_Position maximum;
+	Sci_Position lineSaved = 0;	// Line of last checkpoint saved or 0 if none
+	SparseState<T> states;
+	Sci_Position lineStart = 0;	// Line where lexing last started or 0 if none
+	T stateStart {};
+
+	void Thin() {
+		interval *= 2;
+		SparseState<T> statesKept;
+		for (Sci_Position line = interval; line <= lineSaved; line += interval) {
+			statesKept.Set(line, states.ValueAt(line));
+		}
+		states = std::move(statesKept);
+		lineSaved -= lineSaved % interval;
+	}
+
+public:
+	explicit Checkpoints(Sci_Position interval_=0x400, Sci_Position maximum_=0x10) :
+		intervalInitial(interval_ > 0 ? interval_ : 1), interval(intervalInitial), maximum(maximum_ > 0 ? maximum_ : 1) {
+	}
+	// Should the state at the start of line be saved?
+	bool Due(Sci_Position line) const noexcept {
+		return line == lineSaved + interval;
+	}
+	void Save(Sci_Position line, const T &state) {
+		if (Due(line)) {
+			states.Set(line, state);
+			lineSaved = line;
+			if (lineSaved / interval > maximum) {
+				Thin();
+			}
+		}
+	}
+	// Keep the state at the line where lexing starts.
+	void SaveStart(Sci_Position line, const T &state) {
+		if (line > 0) {
+			lineStart = line;
+			stateStart = state;
+		}
+	}
+	// Checkpoints after line were made from text that may have changed.
+	void InvalidateAfter(Sci_Position line) {
+		if (lineSaved > line) {
+			states.Delete(line + 1);
+			lineSaved = std::max<Sci_Position>(line - line % interval, 0);
+		}
+		if (lineStart > line) {
+			lineStart = 0;
+			stateStart = T();
+		}
+	}
+	// Sets state to the nearest checkpoint at or before line and returns that checkpoint's line.
+	// Returns 0 without changing state when there is no checkpoint so lexing starts from the beginning.
+	Sci_Position Restore(Sci_Position line, T &state) {
+		const Sci_Position lineCheckpoint = std::min(lineSaved, line - line % interval);
+		if ((lineStart > 0) && (lineStart >= lineCheckpoint) && (lineStart <= line)) {
+			state = stateStart;
+			return lineStart;
+		}
+		if (lineCheckpoint > 0) {
+			state = states.ValueAt(lineCheckpoint);
+			return lineCheckpoint;
+		}
+		return 0;
+	}
+	// Forget all checkpoints, as when a setting that affects lexer state changes.
+	void Clear() {
+		states = SparseState<T>();
+		interval = intervalInitial;
+		lineSaved = 0;
+		lineStart = 0;
+		stateStart = T();
+	}
+	Sci_Position Interval() const noexcept {
+		return interval;
+	}
+	size_t size() const {
+		return states.size();
+	}
+};
+
+}
+
+#endif
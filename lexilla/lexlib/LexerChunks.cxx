@@ -0,0 +1,478 @@
+// Scintilla source code edit control
+/** @file LexerChunks.cxx
+ ** Lex a large range on multiple threads by dividing it into chunks of lines.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstdlib>
+#include <cassert>
+
+#include <utility>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <future>
+#include <system_error>
+
+#include "ILexer.h"
+
+#include "PropSetSimple.h"
+#include "WordList.h"
+#include "LexAccessor.h"
+#include "Accessor.h"
+#include "LexerModule.h"
+#include "LexerChunks.h"
+
+using namespace Lexilla;
+
+namespace {
+
+// Lexers following the lcLineChunks rules only read a few values from before a chunk.
+constexpr size_t maxReads = 64;
+
+enum class Value { style, level, lineState };
+
+struct ValueAccess {
+	Value kind;
+	Sci_Position index;
+	int value;
+};
+
+// Values set by a chunk for each of its lines.
+class LineValues {
+	std::vector<int> values;
+	std::vector<bool> set;
+public:
+	void Set(Sci_Position index, int value) {
+		if (index >= Length()) {
+			values.resize(index + 1);
+			set.resize(index + 1);
+		}
+		values[index] = value;
+		set[index] = true;
+	}
+	bool IsSet(Sci_Position index) const noexcept {
+		return (index < Length()) && set[index];
+	}
+	int ValueAt(Sci_Position index) const noexcept {
+		return values[index];
+	}
+	Sci_Position Length() const noexcept {
+		return static_cast<Sci_Position>(values.size());
+	}
+};
+
+struct Decoration {
+	int indicator;
+	Sci_Position position;
+	int value;
+	Sci_Position fillLength;
+};
+
+/**
+ * Document seen by the lexer for one chunk. Text and values not set by the chunk are
+ * read from the real document with only const methods, and GetLineIndentation which is
+ * documented as safe to call concurrently, so chunks can be lexed concurrently.
+ * Styles, fold levels, line states, and decorations set by the lexer are held until the
+ * chunk is applied to the real document.
+ */
+class ChunkDocument : public Scintilla::IDocument5 {
+	Scintilla::IDocument5 *pAccess;
+	Sci_Position start;
+	Sci_Position lineFirst;
+	// Values read from before the chunk which may be changed by stitching earlier chunks
+	mutable std::vector<ValueAccess> reads;
+	mutable bool readsOverflowed = false;
+	// Styles as runs starting at styleStart, each with its end position
+	Sci_Position styleStart = 0;
+	Sci_Position stylePosition = 0;
+	std::vector<Sci_Position> runEnds;
+	std::string runStyles;
+	bool stylesDisjoint = false;
+	LineValues levels;
+	LineValues lineStates;
+	// Values set for lines before lineFirst, in order
+	std::vector<ValueAccess> earlierWrites;
+	int indicator = 0;
+	std::vector<Decoration> decorations;
+	std::vector<std::pair<Sci_Position, Sci_Position>> lexerStateChanges;
+	int errorStatus = 0;
+
+	void Read(Value kind, Sci_Position index, int value) const {
+		if (reads.size() < maxReads) {
+			reads.push_back({kind, index, value});
+		} else {
+			readsOverflowed = true;
+		}
+	}
+
+	int DocumentValue(Value kind, Sci_Position index) const {
+		switch (kind) {
+		case Value::style:
+			return pAccess->StyleAt(index);
+		case Value::level:
+			return pAccess->GetLevel(index);
+		default:
+			return pAccess->GetLineState(index);
+		}
+	}
+
+	int LineValue(Value kind, Sci_Position line, bool record) const {
+		if (line >= lineFirst) {
+			const LineValues &values = (kind == Value::level) ? levels : lineStates;
+			if (values.IsSet(line - lineFirst)) {
+				return values.ValueAt(line - lineFirst);
+			}
+			return DocumentValue(kind, line);
+		}
+		for (auto it = earlierWrites.rbegin(); it != earlierWrites.rend(); ++it) {
+			if ((it->kind == kind) && (it->index == line)) {
+				return it->value;
+			}
+		}
+		const int value = DocumentValue(kind, line);
+		if (record) {
+			Read(kind, line, value);
+		}
+		return value;
+	}
+
+	int SetLineValue(Value kind, Sci_Position line, int value) {
+		const int valueOld = LineValue(kind, line, false);
+		if (line >= lineFirst) {
+			LineValues &values = (kind == Value::level) ? levels : lineStates;
+			values.Set(line - lineFirst, value);
+		} else {
+			earlierWrites.push_back({kind, line, value});
+		}
+		return valueOld;
+	}
+
+	Sci_Position StyledEnd() const noexcept {
+		return runEnds.empty() ? styleStart : runEnds.back();
+	}
+
+	void AddRun(Sci_Position length, char style) {
+		if ((length <= 0) || stylesDisjoint) {
+			return;
+		}
+		stylePosition += length;
+		if (!runStyles.empty() && (runStyles.back() == style)) {
+			runEnds.back() = stylePosition;
+		} else {
+			runEnds.push_back(stylePosition);
+			runStyles.push_back(style);
+		}
+	}
+
+public:
+	ChunkDocument(Scintilla::IDocument5 *pAccess_, Sci_Position start_) :
+		pAccess(pAccess_), start(start_), lineFirst(pAccess_->LineFromPosition(start_)),
+		styleStart(start_), stylePosition(start_) {
+	}
+	// Deleted so ChunkDocument objects can not be copied.
+	ChunkDocument(const ChunkDocument &) = delete;
+	ChunkDocument(ChunkDocument &&) = delete;
+	ChunkDocument &operator=(const ChunkDocument &) = delete;
+	ChunkDocument &operator=(ChunkDocument &&) = delete;
+	virtual ~ChunkDocument() = default;
+
+	int SCI_METHOD Version() const override {
+		return Scintilla::dvRelease5;
+	}
+	void SCI_METHOD SetErrorStatus(int status) override {
+		errorStatus = status;
+	}
+	Sci_Position SCI_METHOD Length() const override {
+		return pAccess->Length();
+	}
+	void SCI_METHOD GetCharRange(char *buffer, Sci_Position position, Sci_Position lengthRetrieve) const override {
+		pAccess->GetCharRange(buffer, position, lengthRetrieve);
+	}
+	char SCI_METHOD StyleAt(Sci_Position position) const override {
+		if ((position >= styleStart) && (position < StyledEnd())) {
+			const auto it = std::upper_bound(runEnds.begin(), runEnds.end(), position);
+			return runStyles[it - runEnds.begin()];
+		}
+		const char style = pAccess->StyleAt(position);
+		if (position < start) {
+			Read(Value::style, position, style);
+		}
+		return style;
+	}
+	Sci_Position SCI_METHOD LineFromPosition(Sci_Position position) const override {
+		return pAccess->LineFromPosition(position);
+	}
+	Sci_Position SCI_METHOD LineStart(Sci_Position line) const override {
+		return pAccess->LineStart(line);
+	}
+	int SCI_METHOD GetLevel(Sci_Position line) const override {
+		return LineValue(Value::level, line, true);
+	}
+	int SCI_METHOD SetLevel(Sci_Position line, int level) override {
+		return SetLineValue(Value::level, line, level);
+	}
+	int SCI_METHOD GetLineState(Sci_Position line) const override {
+		return LineValue(Value::lineState, line, true);
+	}
+	int SCI_METHOD SetLineState(Sci_Position line, int state) override {
+		return SetLineValue(Value::lineState, line, state);
+	}
+	void SCI_METHOD StartStyling(Sci_Position position) override {
+		if (runEnds.empty()) {
+			styleStart = position;
+		} else if ((position < styleStart) || (position > StyledEnd())) {
+			// Not worth representing as lcLineChunks lexers style forwards from the chunk start
+			stylesDisjoint = true;
+		} else {
+			// Restyling: drop styles from position onwards
+			size_t run = std::upper_bound(runEnds.begin(), runEnds.end(), position) - runEnds.begin();
+			if (run < runEnds.size()) {
+				const Sci_Position runStart = (run == 0) ? styleStart : runEnds[run - 1];
+				if (runStart < position) {
+					runEnds[run] = position;
+					run++;
+				}
+				runEnds.resize(run);
+				runStyles.resize(run);
+			}
+		}
+		stylePosition = position;
+	}
+	bool SCI_METHOD SetStyleFor(Sci_Position length, char style) override {
+		AddRun(length, style);
+		return true;
+	}
+	bool SCI_METHOD SetStyles(Sci_Position length, const char *styles) override {
+		Sci_Position i = 0;
+		while (i < length) {
+			const Sci_Position runStart = i;
+			while ((i < length) && (styles[i] == styles[runStart])) {
+				i++;
+			}
+			AddRun(i - runStart, styles[runStart]);
+		}
+		return true;
+	}
+	bool SCI_METHOD SetStyleRuns(Sci_Position runs, const Sci_Position *lengths, const char *styles) override {
+		for (Sci_Position run = 0; run < runs; run++) {
+			AddRun(lengths[run], styles[run]);
+		}
+		return true;
+	}
+	void SCI_METHOD DecorationSetCurrentIndicator(int indicator_) override {
+		indicator = indicator_;
+	}
+	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override {
+		decorations.push_back({indicator, position, value, fillLength});
+	}
+	void SCI_METHOD ChangeLexerState(Sci_Position start_, Sci_Position end_) override {
+		lexerStateChanges.emplace_back(start_, end_);
+	}
+	int SCI_METHOD CodePage() const override {
+		return pAccess->CodePage();
+	}
+	bool SCI_METHOD IsDBCSLeadByte(char ch) const override {
+		return pAccess->IsDBCSLeadByte(ch);
+	}
+	const char * SCI_METHOD BufferPointer() override {
+		// Would move the real document's gap while other chunks are reading it
+		return nullptr;
+	}
+	int SCI_METHOD GetLineIndentation(Sci_Position line) override {
+		return pAccess->GetLineIndentation(line);
+	}
+	Sci_Position SCI_METHOD LineEnd(Sci_Position line) const override {
+		return pAccess->LineEnd(line);
+	}
+	Sci_Position SCI_METHOD GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const override {
+		return pAccess->GetRelativePosition(positionStart, characterOffset);
+	}
+	int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const override {
+		return pAccess->GetCharacterAndWidth(position, pWidth);
+	}
+	const char * SCI_METHOD ContiguousRangePointer(Sci_Position position, Sci_Position rangeLength) const override {
+		return pAccess->ContiguousRangePointer(position, rangeLength);
+	}
+
+	// Would lexing the chunk on the real document now produce the held results?
+	bool Valid() const {
+		if (readsOverflowed || stylesDisjoint) {
+			return false;
+		}
+		for (const ValueAccess &read : reads) {
+			if (DocumentValue(read.kind, read.index) != read.value) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Set the held results into the real document. Results past end or on lineEnd and
+	// later lines are from lexing past the chunk and are only applied for the last chunk.
+	void Apply(Sci_Position end, Sci_Position lineEnd, bool last) {
+		const Sci_Position styledFrom = std::max(start, styleStart);
+		const Sci_Position styledTo = last ? StyledEnd() : std::min(StyledEnd(), end);
+		if (styledTo > styledFrom) {
+			std::vector<Sci_Position> lengths;
+			std::string styles;
+			Sci_Position position = styledFrom;
+			size_t run = std::upper_bound(runEnds.begin(), runEnds.end(), position) - runEnds.begin();
+			for (; (run < runEnds.size()) && (position < styledTo); run++) {
+				const Sci_Position runEnd = std::min(runEnds[run], styledTo);
+				lengths.push_back(runEnd - position);
+				styles.push_back(runStyles[run]);
+				position = runEnd;
+			}
+			pAccess->StartStyling(styledFrom);
+			pAccess->SetStyleRuns(lengths.size(), lengths.data(), styles.data());
+		}
+
+		for (const ValueAccess &write : earlierWrites) {
+			if (write.kind == Value::level) {
+				pAccess->SetLevel(write.index, write.value);
+			} else {
+				pAccess->SetLineState(write.index, write.value);
+			}
+		}
+		const Sci_Position linesChunk = lineEnd - lineFirst;
+		const Sci_Position linesLevels = last ? levels.Length() : std::min(levels.Length(), linesChunk);
+		for (Sci_Position line = 0; line < linesLevels; line++) {
+			if (levels.IsSet(line)) {
+				pAccess->SetLevel(lineFirst + line, levels.ValueAt(line));
+			}
+		}
+		const Sci_Position linesStates = last ? lineStates.Length() : std::min(lineStates.Length(), linesChunk);
+		for (Sci_Position line = 0; line < linesStates; line++) {
+			if (lineStates.IsSet(line)) {
+				pAccess->SetLineState(lineFirst + line, lineStates.ValueAt(line));
+			}
+		}
+
+		for (const Decoration &decoration : decorations) {
+			const Sci_Position from = std::max(decoration.position, start);
+			const Sci_Position decorationEnd = decoration.position + decoration.fillLength;
+			const Sci_Position to = last ? decorationEnd : std::min(decorationEnd, end);
+			if (to > from) {
+				pAccess->DecorationSetCurrentIndicator(decoration.indicator);
+				pAccess->DecorationFillRange(from, decoration.value, to - from);
+			}
+		}
+		for (const std::pair<Sci_Position, Sci_Position> &change : lexerStateChanges) {
+			const Sci_Position from = std::max(change.first, start);
+			const Sci_Position to = last ? change.second : std::min(change.second, end);
+			if (to > from) {
+				pAccess->ChangeLexerState(from, to);
+			}
+		}
+		if (errorStatus) {
+			pAccess->SetErrorStatus(errorStatus);
+		}
+	}
+};
+
+struct Chunk {
+	Sci_Position start;
+	Sci_Position end;
+	Sci_Position lineEnd;
+	int initStyle;
+	std::unique_ptr<ChunkDocument> doc;
+};
+
+}
+
+namespace Lexilla {
+
+bool LexInChunks(LexerFunction fn, Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
+	WordList *keywordlists[], PropSetSimple &props, Scintilla::IDocument *pAccess,
+	Sci_Position minimumLength, Sci_Position maxChunks) {
+	// Earlier document versions do not promise that const methods can be called concurrently
+	if (!fn || (lengthDoc <= 0) || (pAccess->Version() < Scintilla::dvRelease5)) {
+		return false;
+	}
+	Scintilla::IDocument5 *pAccess5 = static_cast<Scintilla::IDocument5 *>(pAccess);
+	if (maxChunks <= 0) {
+		maxChunks = std::thread::hardware_concurrency();
+	}
+	const Sci_Position chunksWanted = std::min(maxChunks, lengthDoc / std::max<Sci_Position>(minimumLength, 1));
+	if (chunksWanted < 2) {
+		return false;
+	}
+
+	const Sci_Position endPos = startPos + lengthDoc;
+	std::vector<Chunk> chunks;
+	Sci_Position chunkStart = startPos;
+	for (Sci_Position chunk = 1; chunk <= chunksWanted; chunk++) {
+		Sci_Position chunkEnd = endPos;
+		if (chunk < chunksWanted) {
+			// Split at the start of the line after the proportional position
+			const Sci_Position split = startPos + lengthDoc * chunk / chunksWanted;
+			chunkEnd = std::min(pAccess->LineStart(pAccess->LineFromPosition(split) + 1), endPos);
+		}
+		if (chunkEnd > chunkStart) {
+			const int chunkInitStyle = chunks.empty() ? initStyle : static_cast<unsigned char>(pAccess->StyleAt(chunkStart - 1));
+			chunks.push_back({chunkStart, chunkEnd, pAccess->LineFromPosition(chunkEnd), chunkInitStyle,
+				std::make_unique<ChunkDocument>(pAccess5, chunkStart)});
+			chunkStart = chunkEnd;
+		}
+	}
+	if (chunks.size() < 2) {
+		return false;
+	}
+
+	{
+		// Destroying a future from std::async waits for it so all chunks are lexed
+		// before leaving this block or returning.
+		std::vector<std::future<void>> futures;
+		try {
+			for (size_t chunk = 0; chunk < chunks.size(); chunk++) {
+				Chunk &ch = chunks[chunk];
+				// The first chunk is lexed on this thread
+				const std::launch policy = (chunk > 0) ? std::launch::async : std::launch::deferred;
+				futures.push_back(std::async(policy, [&ch, fn, keywordlists, &props]() {
+					Accessor styler(ch.doc.get(), &props);
+					fn(ch.start, ch.end - ch.start, ch.initStyle, keywordlists, styler);
+					styler.Flush();
+				}));
+			}
+		} catch (const std::system_error &) {
+			// Could not start a thread so the caller lexes the range without chunks
+			return false;
+		}
+		for (std::future<void> &f : futures) {
+			f.get();
+		}
+	}
+
+	// Stitch in order as each chunk may depend on the results of earlier chunks
+	for (size_t chunk = 0; chunk < chunks.size(); chunk++) {
+		Chunk &ch = chunks[chunk];
+		const bool last = chunk == chunks.size() - 1;
+		if (ch.doc->Valid()) {
+			ch.doc->Apply(ch.end, ch.lineEnd, last);
+		} else {
+			// Lex again on the document but do not disturb the first line of the next chunk
+			// which may have been set partially at the end of lexing.
+			const int levelNext = pAccess->GetLevel(ch.lineEnd);
+			const int stateNext = pAccess->GetLineState(ch.lineEnd);
+			const int chunkInitStyle = (chunk == 0) ? initStyle : static_cast<unsigned char>(pAccess->StyleAt(ch.start - 1));
+			Accessor styler(pAccess, &props);
+			fn(ch.start, ch.end - ch.start, chunkInitStyle, keywordlists, styler);
+			styler.Flush();
+			if (!last) {
+				if (pAccess->GetLevel(ch.lineEnd) != levelNext) {
+					pAccess->SetLevel(ch.lineEnd, levelNext);
+				}
+				if (pAccess->GetLineState(ch.lineEnd) != stateNext) {
+					pAccess->SetLineState(ch.lineEnd, stateNext);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+}
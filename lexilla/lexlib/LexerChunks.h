@@ -0,0 +1,32 @@
+// Scintilla source code edit control
+/** @file LexerChunks.h
+ ** Lex a large range on multiple threads by dividing it into chunks of lines.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef LEXERCHUNKS_H
+#define LEXERCHUNKS_H
+
+namespace Lexilla {
+
+/** Chunks are at least @a chunkMinimum bytes so that lexing each chunk takes much longer
+ * than starting a thread and stitching the chunk's results into the document. */
+constexpr Sci_Position chunkMinimum = 0x40000;
+
+/**
+ * Run fn, which must follow the lcLineChunks rules, over line aligned chunks of
+ * [startPos, startPos+lengthDoc) concurrently, each into a private copy of its results.
+ * The chunks are then stitched into the document in order. A chunk whose lexing read
+ * a value from before its start that now differs in the document is lexed again on the
+ * document.
+ * There are at most @a maxChunks chunks or, when it is 0, one for each hardware thread.
+ * Returns false without lexing when the document does not support being read from
+ * multiple threads or there is not enough text for more than one chunk.
+ */
+bool LexInChunks(LexerFunction fn, Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
+	WordList *keywordlists[], PropSetSimple &props, Scintilla::IDocument *pAccess,
+	Sci_Position minimumLength=chunkMinimum, Sci_Position maxChunks=0);
+
+}
+
+#endif
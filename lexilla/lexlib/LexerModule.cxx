@@ -22,6 +22,7 @@
 #include "LexerModule.h"
 #include "LexerBase.h"
 #include "LexerSimple.h"
+#include "LexerChunks.h"
 
 using namespace Lexilla;
 
@@ -31,7 +32,8 @@ LexerModule::LexerModule(int language_,
 	LexerFunction fnFolder_,
 	const char *const wordListDescriptions_[],
 	const LexicalClass *lexClasses_,
-	size_t nClasses_) noexcept :
+	size_t nClasses_,
+	int capabilities_) noexcept :
 	language(language_),
 	fnLexer(fnLexer_),
 	fnFolder(fnFolder_),
@@ -39,6 +41,7 @@ LexerModule::LexerModule(int language_,
 	wordListDescriptions(wordListDescriptions_),
 	lexClasses(lexClasses_),
 	nClasses(nClasses_),
+	capabilities(capabilities_),
 	languageName(languageName_) {
 }
 
@@ -53,6 +56,7 @@ LexerModule::LexerModule(int language_,
 	wordListDescriptions(wordListDescriptions_),
 	lexClasses(nullptr),
 	nClasses(0),
+	capabilities(0),
 	languageName(languageName_) {
 }
 
@@ -91,6 +95,10 @@ size_t LexerModule::NamedStyles() const noexcept {
 	return nClasses;
 }
 
+int LexerModule::GetCapabilities() const noexcept {
+	return capabilities;
+}
+
 Scintilla::ILexer5 *LexerModule::Create() const {
     if (fnFactory)
 		return fnFactory();
@@ -122,3 +130,28 @@ void LexerModule::Fold(Sci_PositionU startPos, Sci_Position lengthDoc, int initS
 		fnFolder(startPos, lengthDoc, initStyle, keywordlists, styler);
 	}
 }
+
+bool LexerModule::LexConcurrently(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
+	WordList *keywordlists[], PropSetSimple &props, Scintilla::IDocument *pAccess) const {
+	return (capabilities & lcLineChunks) &&
+		LexInChunks(fnLexer, startPos, lengthDoc, initStyle, keywordlists, props, pAccess);
+}
+
+bool LexerModule::FoldConcurrently(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
+	WordList *keywordlists[], PropSetSimple &props, Scintilla::IDocument *pAccess) const {
+	if (!(capabilities & lcLineChunks) || !fnFolder) {
+		return false;
+	}
+	// Move back one line as Fold does
+	const Sci_Position lineCurrent = pAccess->LineFromPosition(startPos);
+	if (lineCurrent > 0) {
+		const Sci_Position newStartPos = pAccess->LineStart(lineCurrent - 1);
+		lengthDoc += startPos - newStartPos;
+		startPos = newStartPos;
+		initStyle = 0;
+		if (startPos > 0) {
+			initStyle = pAccess->StyleAt(startPos - 1);
+		}
+	}
+	return LexInChunks(fnFolder, startPos, lengthDoc, initStyle, keywordlists, props, pAccess);
+}
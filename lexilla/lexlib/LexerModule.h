@@ -12,12 +12,21 @@ namespace Lexilla {
 
 class Accessor;
 class WordList;
+class PropSetSimple;
 struct LexicalClass;
 
 typedef void (*LexerFunction)(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
                   WordList *keywordlists[], Accessor &styler);
 typedef Scintilla::ILexer5 *(*LexerFactoryFunction)();
 
+/**
+ * Capabilities of a lexer that allow it to be run in other ways.
+ * lcLineChunks: the lexer and folder can start at any line with initStyle ignored and only
+ * read values set for earlier lines through the document, so a large range may be split
+ * into chunks of lines that are lexed concurrently.
+ */
+enum { lcLineChunks=1 };
+
 /**
  * A LexerModule is responsible for lexing and folding a particular language.
  * The Catalogue class maintains a list of LexerModules which can be searched to find a
@@ -33,6 +42,7 @@ protected:
 	const char * const * wordListDescriptions;
 	const LexicalClass *lexClasses;
 	size_t nClasses;
+	int capabilities;
 
 public:
 	const char *languageName;
@@ -43,7 +53,8 @@ public:
 		LexerFunction fnFolder_= nullptr,
 		const char * const wordListDescriptions_[]=nullptr,
 		const LexicalClass *lexClasses_=nullptr,
-		size_t nClasses_=0) noexcept;
+		size_t nClasses_=0,
+		int capabilities_=0) noexcept;
 	LexerModule(
 		int language_,
 		LexerFactoryFunction fnFactory_,
@@ -56,6 +67,7 @@ public:
 	const char *GetWordListDescription(int index) const noexcept;
 	const LexicalClass *LexClasses() const noexcept;
 	size_t NamedStyles() const noexcept;
+	int GetCapabilities() const noexcept;
 
 	Scintilla::ILexer5 *Create() const;
 
@@ -64,6 +76,13 @@ public:
 	void Fold(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
                   WordList *keywordlists[], Accessor &styler) const;
 
+	// Lex or fold on multiple threads when lcLineChunks is set and the range is large.
+	// Returns false without lexing when Lex or Fold should be called instead.
+	bool LexConcurrently(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
+		WordList *keywordlists[], PropSetSimple &props, Scintilla::IDocument *pAccess) const;
+	bool FoldConcurrently(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle,
+		WordList *keywordlists[], PropSetSimple &props, Scintilla::IDocument *pAccess) const;
+
 	friend class CatalogueModules;
 };
 
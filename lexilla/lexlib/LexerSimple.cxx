@@ -40,6 +40,8 @@ const char * SCI_METHOD LexerSimple::DescribeWordListSets() {
 }
 
 void SCI_METHOD LexerSimple::Lex(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle, Scintilla::IDocument *pAccess) {
+	if (module->LexConcurrently(startPos, lengthDoc, initStyle, keyWordLists, props, pAccess))
+		return;
 	Accessor astyler(pAccess, &props);
 	module->Lex(startPos, lengthDoc, initStyle, keyWordLists, astyler);
 	astyler.Flush();
@@ -47,6 +49,8 @@ void SCI_METHOD LexerSimple::Lex(Sci_PositionU startPos, Sci_Position lengthDoc,
 
 void SCI_METHOD LexerSimple::Fold(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle, Scintilla::IDocument *pAccess) {
 	if (props.GetInt("fold")) {
+		if (module->FoldConcurrently(startPos, lengthDoc, initStyle, keyWordLists, props, pAccess))
+			return;
 		Accessor astyler(pAccess, &props);
 		module->Fold(startPos, lengthDoc, initStyle, keyWordLists, astyler);
 		astyler.Flush();
@@ -68,12 +68,27 @@ bool cmpWords(const char *a, const char *b) noexcept {
 	return strcmp(a, b) < 0;
 }
 
+// Linear search is faster than hashing for a few words starting with the same character.
+constexpr int hashedStartWords = 8;
+
+// FNV-1a which is quick for the short words in keyword lists.
+size_t HashWord(const char *s) noexcept {
+	unsigned int hash = 2166136261U;
+	while (*s) {
+		hash ^= static_cast<unsigned char>(*s);
+		hash *= 16777619U;
+		s++;
+	}
+	return hash;
+}
+
 }
 
 WordList::WordList(bool onlyLineEnds_) noexcept :
-	words(nullptr), list(nullptr), len(0), onlyLineEnds(onlyLineEnds_) {
+	words(nullptr), list(nullptr), len(0), onlyLineEnds(onlyLineEnds_), hashTable(nullptr), hashMask(0) {
 	// Prevent warnings by static analyzers about uninitialized starts.
 	starts[0] = -1;
+	std::fill(hashedStarts, std::end(hashedStarts), false);
 }
 
 WordList::~WordList() {
@@ -103,6 +118,9 @@ void WordList::Clear() noexcept {
 	list = nullptr;
 	delete []words;
 	words = nullptr;
+	delete []hashTable;
+	hashTable = nullptr;
+	hashMask = 0;
 	len = 0;
 }
 
@@ -132,9 +150,34 @@ bool WordList::Set(const char *s) {
 	list = listTemp.release();
 	len = lenTemp;
 	std::fill(starts, std::end(starts), -1);
+	std::fill(hashedStarts, std::end(hashedStarts), false);
 	for (int l = static_cast<int>(len - 1); l >= 0; l--) {
 		unsigned char indexChar = words[l][0];
 		starts[indexChar] = l;
+		if ((l + hashedStartWords < static_cast<int>(len)) && (words[l + hashedStartWords][0] == words[l][0])) {
+			hashedStarts[indexChar] = true;
+		}
+	}
+	const size_t hashedWords = std::count_if(words, words + len, [this](const char *word) noexcept {
+		return hashedStarts[static_cast<unsigned char>(word[0])];
+	});
+	if (hashedWords) {
+		size_t slots = 8;
+		while (slots < hashedWords * 2) {
+			slots *= 2;
+		}
+		hashTable = new int[slots];
+		std::fill(hashTable, hashTable + slots, -1);
+		hashMask = slots - 1;
+		for (size_t w = 0; w < len; w++) {
+			if (hashedStarts[static_cast<unsigned char>(words[w][0])]) {
+				size_t slot = HashWord(words[w]) & hashMask;
+				while (hashTable[slot] >= 0) {
+					slot = (slot + 1) & hashMask;
+				}
+				hashTable[slot] = static_cast<int>(w);
+			}
+		}
 	}
 	return true;
 }
@@ -149,7 +192,13 @@ bool WordList::InList(const char *s) const noexcept {
 		return false;
 	const unsigned char firstChar = s[0];
 	int j = starts[firstChar];
-	if (j >= 0) {
+	if (hashedStarts[firstChar]) {
+		for (size_t slot = HashWord(s) & hashMask; hashTable[slot] >= 0; slot = (slot + 1) & hashMask) {
+			const char *word = words[hashTable[slot]];
+			if ((word[0] == s[0]) && (strcmp(word, s) == 0))
+				return true;
+		}
+	} else if (j >= 0) {
 		while (words[j][0] == firstChar) {
 			if (s[1] == words[j][1]) {
 				const char *a = words[j] + 1;
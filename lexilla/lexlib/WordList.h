@@ -19,6 +19,12 @@ class WordList {
 	size_t len;
 	bool onlyLineEnds;	///< Delimited by any white space or only line ends
 	int starts[256];
+	// Words starting with a character that starts many words are found by InList through
+	// an open addressing hash table of indices into words instead of searching linearly.
+	// Empty slots are -1 and there are at least twice as many slots as hashed words.
+	bool hashedStarts[256];
+	int *hashTable;
+	size_t hashMask;
 public:
 	explicit WordList(bool onlyLineEnds_ = false) noexcept;
 	// Deleted so WordList objects can not be copied.
@@ -51,6 +51,16 @@ $(DIR_O)/LexerBase.o: \
 	../lexlib/Accessor.h \
 	../lexlib/LexerModule.h \
 	../lexlib/LexerBase.h
+$(DIR_O)/LexerChunks.o: \
+	../lexlib/LexerChunks.cxx \
+	../../scintilla/include/ILexer.h \
+	../../scintilla/include/Sci_Position.h \
+	../lexlib/PropSetSimple.h \
+	../lexlib/WordList.h \
+	../lexlib/LexAccessor.h \
+	../lexlib/Accessor.h \
+	../lexlib/LexerModule.h \
+	../lexlib/LexerChunks.h
 $(DIR_O)/LexerModule.o: \
 	../lexlib/LexerModule.cxx \
 	../../scintilla/include/ILexer.h \
@@ -63,7 +73,8 @@ $(DIR_O)/LexerModule.o: \
 	../lexlib/Accessor.h \
 	../lexlib/LexerModule.h \
 	../lexlib/LexerBase.h \
-	../lexlib/LexerSimple.h
+	../lexlib/LexerSimple.h \
+	../lexlib/LexerChunks.h
 $(DIR_O)/LexerNoExceptions.o: \
 	../lexlib/LexerNoExceptions.cxx \
 	../../scintilla/include/ILexer.h \
@@ -417,6 +428,7 @@ $(DIR_O)/LexCPP.o: \
 	../lexlib/LexerModule.h \
 	../lexlib/OptionSet.h \
 	../lexlib/SparseState.h \
+	../lexlib/LexerCheckpoints.h \
 	../lexlib/SubStyles.h
 $(DIR_O)/LexCrontab.o: \
 	../lexers/LexCrontab.cxx \
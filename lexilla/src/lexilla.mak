@@ -208,6 +208,7 @@ LEXLIB_OBJS=\
 	$(DIR_O)\DefaultLexer.obj \
 	$(DIR_O)\LexAccessor.obj \
 	$(DIR_O)\LexerBase.obj \
+	$(DIR_O)\LexerChunks.obj \
 	$(DIR_O)\LexerModule.obj \
 	$(DIR_O)\LexerSimple.obj \
 	$(DIR_O)\PropSetSimple.obj \
@@ -131,7 +131,7 @@ void TestDocument::Set(std::string_view sv) {
 #endif
 
 int SCI_METHOD TestDocument::Version() const {
-	return Scintilla::dvRelease4;
+	return Scintilla::dvRelease5;
 }
 
 void SCI_METHOD TestDocument::SetErrorStatus(int) {
@@ -211,6 +211,14 @@ bool SCI_METHOD TestDocument::SetStyles(Sci_Position length, const char *styles)
 	return true;
 }
 
+bool SCI_METHOD TestDocument::SetStyleRuns(Sci_Position runs, const Sci_Position *lengths, const char *styles) {
+	assert(lengths && styles);
+	for (Sci_Position run = 0; run < runs; run++) {
+		SetStyleFor(lengths[run], styles[run]);
+	}
+	return true;
+}
+
 void SCI_METHOD TestDocument::DecorationSetCurrentIndicator(int) {
 	// Not implemented as no way to read decorations
 }
@@ -313,3 +321,10 @@ int SCI_METHOD TestDocument::GetCharacterAndWidth(Sci_Position position, Sci_Pos
 	}
 	return UnicodeFromUTF8(charBytes);
 }
+
+const char *SCI_METHOD TestDocument::ContiguousRangePointer(Sci_Position position, Sci_Position rangeLength) const {
+	if ((position < 0) || (rangeLength < 0) || (position + rangeLength > static_cast<Sci_Position>(text.length()))) {
+		return nullptr;
+	}
+	return text.data() + position;
+}
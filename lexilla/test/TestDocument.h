@@ -10,7 +10,7 @@
 
 std::u32string UTF32FromUTF8(std::string_view svu8);
 
-class TestDocument : public Scintilla::IDocument {
+class TestDocument : public Scintilla::IDocument5 {
 	std::string text;
 	std::string textStyles;
 	std::vector<Sci_Position> lineStarts;
@@ -51,6 +51,8 @@ public:
 	Sci_Position SCI_METHOD LineEnd(Sci_Position line) const override;
 	Sci_Position SCI_METHOD GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const override;
 	int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const override;
+	const char *SCI_METHOD ContiguousRangePointer(Sci_Position position, Sci_Position rangeLength) const override;
+	bool SCI_METHOD SetStyleRuns(Sci_Position runs, const Sci_Position *lengths, const char *styles) override;
 };
 
 #endif
@@ -6,6 +6,7 @@
  // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cassert>
+#include <cstdlib>
 
 #include <string>
 #include <string_view>
@@ -19,6 +20,7 @@
 #include <fstream>
 #include <iomanip>
 #include <filesystem>
+#include <chrono>
 
 #include "ILexer.h"
 
@@ -926,6 +928,240 @@ bool AccessLexilla(std::filesystem::path basePath) {
 	return success;
 }
 
+// Benchmark mode times each lexer over example files repeated to a larger size.
+// Styling and folding are timed over the whole document and incrementally from the
+// middle line, which is similar to Scintilla restyling after a change.
+
+struct BenchmarkOptions {
+	size_t targetSize = 2 * 1024 * 1024;
+	int repeats = 3;
+	std::vector<std::string> filters;
+};
+
+struct BenchmarkTimes {
+	double lex = 0.0;
+	double fold = 0.0;
+	double relex = 0.0;
+	double refold = 0.0;
+	Sci_Position length = 0;
+	Sci_Position foldLength = 0;
+};
+
+template <typename Action>
+double BestTime(int repeats, Action action) {
+	// Minimum over repeats reduces noise from other processes
+	double best = 0.0;
+	for (int repeat = 0; repeat < repeats; repeat++) {
+		const auto start = std::chrono::steady_clock::now();
+		action();
+		const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+		if ((repeat == 0) || (duration.count() < best)) {
+			best = duration.count();
+		}
+	}
+	return best;
+}
+
+double MegabytesPerSecond(Sci_Position length, double seconds) noexcept {
+	if (seconds <= 0.0) {
+		return 0.0;
+	}
+	return static_cast<double>(length) / (1024.0 * 1024.0) / seconds;
+}
+
+void PrintRates(std::string_view name, const BenchmarkTimes &times, Sci_Position relexLength, std::string_view item) {
+	std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+		<< std::setw(10) << MegabytesPerSecond(times.length, times.lex);
+	if (times.foldLength > 0) {
+		std::cout << std::setw(10) << MegabytesPerSecond(times.foldLength, times.fold);
+	} else {
+		std::cout << std::setw(10) << "-";
+	}
+	std::cout << std::setw(10) << MegabytesPerSecond(relexLength, times.relex);
+	if (times.foldLength > 0) {
+		std::cout << std::setw(10) << MegabytesPerSecond(times.foldLength * relexLength / times.length, times.refold);
+	} else {
+		std::cout << std::setw(10) << "-";
+	}
+	std::cout << "  " << item << "\n";
+}
+
+std::vector<int> FoldLevels(const Scintilla::IDocument *pdoc) {
+	std::vector<int> levels;
+	const Sci_Position lines = pdoc->LineFromPosition(pdoc->Length());
+	for (Sci_Position line = 0; line <= lines; line++) {
+		levels.push_back(pdoc->GetLevel(line));
+	}
+	return levels;
+}
+
+std::string ScaledText(std::string_view text, size_t targetSize) {
+	std::string scaled;
+	if (text.empty()) {
+		return scaled;
+	}
+	while (scaled.length() < targetSize) {
+		scaled.append(text);
+		if (!text.ends_with('\n')) {
+			scaled.push_back('\n');
+		}
+	}
+	return scaled;
+}
+
+bool BenchmarkFile(const std::filesystem::path &path, const std::filesystem::path &relativePath,
+	const PropertyMap &propertyMap, const BenchmarkOptions &options, BenchmarkTimes &total) {
+	std::optional<std::string> language = propertyMap.GetPropertyForFile(lexerPrefix, path.filename().string());
+	if (!language) {
+		std::cout << path.string() << ":1: has no language\n";
+		return false;
+	}
+	Scintilla::ILexer5 *plex = Lexilla::MakeLexer(*language);
+	if (!plex) {
+		std::cout << path.string() << ":1: has no lexer for " << *language << "\n";
+		return false;
+	}
+	if (!SetProperties(plex, propertyMap, path)) {
+		plex->Release();
+		return false;
+	}
+
+	std::string text = ReadFile(path);
+	if (text.starts_with(BOM)) {
+		text.erase(0, BOM.length());
+	}
+	const std::string scaled = ScaledText(text, options.targetSize);
+
+	TestDocument doc;
+	doc.Set(scaled);
+	Scintilla::IDocument *pdoc = &doc;
+	const Sci_Position length = pdoc->Length();
+
+	// Restart from the beginning of the middle line with the style and fold state
+	// left by a full pass, as Scintilla does after a modification.
+	const Sci_Position middleLine = pdoc->LineFromPosition(length) / 2;
+	const Sci_Position middleStart = pdoc->LineStart(middleLine);
+	const Sci_Position middleLength = length - middleStart;
+
+	BenchmarkTimes times;
+	times.length = length;
+	times.lex = BestTime(options.repeats, [&]() {
+		plex->Lex(0, length, 0, pdoc);
+	});
+	// Folding is only reported when Fold changes levels: some lexers have no folder,
+	// fold may be turned off, and some lexers like hypertext fold while lexing.
+	const std::vector<int> levelsLexed = FoldLevels(pdoc);
+	times.fold = BestTime(options.repeats, [&]() {
+		plex->Fold(0, length, 0, pdoc);
+	});
+	if (FoldLevels(pdoc) != levelsLexed) {
+		times.foldLength = length;
+	}
+	const int middleStyle = (middleStart > 0) ? pdoc->StyleAt(middleStart - 1) : 0;
+	times.relex = BestTime(options.repeats, [&]() {
+		plex->Lex(middleStart, middleLength, middleStyle, pdoc);
+	});
+	times.refold = BestTime(options.repeats, [&]() {
+		plex->Fold(middleStart, middleLength, middleStyle, pdoc);
+	});
+	plex->Release();
+
+	PrintRates(*language, times, middleLength, relativePath.string());
+
+	// Incremental times are scaled to the whole document so totals are over full lengths
+	const double scaleIncremental = (middleLength > 0) ? static_cast<double>(length) / middleLength : 0.0;
+	total.lex += times.lex;
+	total.relex += times.relex * scaleIncremental;
+	if (times.foldLength > 0) {
+		total.fold += times.fold;
+		total.refold += times.refold * scaleIncremental;
+	}
+	total.length += length;
+	total.foldLength += times.foldLength;
+	return true;
+}
+
+bool MatchesFilters(const std::filesystem::path &relativePath, const std::vector<std::string> &filters) {
+	if (filters.empty()) {
+		return true;
+	}
+	const std::string relative = relativePath.generic_string();
+	for (const std::string &filter : filters) {
+		if (relative.find(filter) != std::string::npos) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool BenchmarkLexilla(std::filesystem::path basePath, const BenchmarkOptions &options) {
+	if (!std::filesystem::exists(basePath)) {
+		std::cout << "No examples at " << basePath.string() << "\n";
+		return false;
+	}
+
+	// Sort so that runs can be compared line by line
+	std::vector<std::filesystem::path> files;
+	for (auto &p : std::filesystem::recursive_directory_iterator(basePath)) {
+		if (!p.is_directory()) {
+			const std::string extension = p.path().extension().string();
+			if (extension != ".properties" && extension != suffixStyled && extension != ".new" &&
+				extension != suffixFolded && MatchesFilters(p.path().lexically_relative(basePath), options.filters)) {
+				files.push_back(p.path());
+			}
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	std::cout << "Benchmark with documents of " << options.targetSize / 1024 << "K, best of "
+		<< options.repeats << " runs, MB/s\n";
+	std::cout << std::left << std::setw(16) << "Lexer" << std::right
+		<< std::setw(10) << "Lex" << std::setw(10) << "Fold"
+		<< std::setw(10) << "Relex" << std::setw(10) << "Refold" << "  File\n";
+
+	bool success = true;
+	BenchmarkTimes total;
+	for (const std::filesystem::path &path : files) {
+		PropertyMap properties;
+		properties.properties["FileNameExt"] = path.filename().string();
+		properties.ReadFromFile(path.parent_path() / "SciTE.properties");
+		if (!BenchmarkFile(path, path.lexically_relative(basePath), properties, options, total)) {
+			success = false;
+		}
+	}
+
+	PrintRates("Total", total, total.length, std::to_string(files.size()) + " files");
+	return success;
+}
+
+bool ParseArguments(int argc, char *argv[], bool &benchmark, BenchmarkOptions &options) {
+	// TestLexers [--benchmark [--size megabytes] [--repeat count] [filter...]]
+	for (int arg = 1; arg < argc; arg++) {
+		const std::string_view argument = argv[arg];
+		if (argument == "--benchmark") {
+			benchmark = true;
+		} else if ((argument == "--size" || argument == "--repeat") && (arg + 1 < argc)) {
+			arg++;
+			const int value = std::atoi(argv[arg]);
+			if (value <= 0) {
+				std::cout << "Invalid value " << argv[arg] << " for " << argument << "\n";
+				return false;
+			}
+			if (argument == "--size") {
+				options.targetSize = static_cast<size_t>(value) * 1024 * 1024;
+			} else {
+				options.repeats = value;
+			}
+		} else if (argument.starts_with("-")) {
+			std::cout << "Unknown argument " << argument << "\n";
+			return false;
+		} else {
+			options.filters.emplace_back(argument);
+		}
+	}
+	return true;
+}
+
 std::filesystem::path FindLexillaDirectory(std::filesystem::path startDirectory) {
 	// Search up from startDirectory for a directory named "lexilla" or containing a "bin" subdirectory
 	std::filesystem::path directory = startDirectory;
@@ -957,18 +1193,23 @@ std::filesystem::path FindLexillaDirectory(std::filesystem::path startDirectory)
 
 
 
-int main() {
+int main(int argc, char *argv[]) {
 	bool success = false;
+	bool benchmark = false;
+	BenchmarkOptions options;
+	if (!ParseArguments(argc, argv, benchmark, options)) {
+		return 1;
+	}
 	// TODO: Allow specifying the base directory through a command line argument
 	const std::filesystem::path baseDirectory = FindLexillaDirectory(std::filesystem::current_path());
 	if (!baseDirectory.empty()) {
 		const std::filesystem::path examplesDirectory = baseDirectory / "test" / "examples";
 #ifdef LEXILLA_STATIC
-		success = AccessLexilla(examplesDirectory);
+		success = benchmark ? BenchmarkLexilla(examplesDirectory, options) : AccessLexilla(examplesDirectory);
 #else
 		const std::filesystem::path sharedLibrary = baseDirectory / "bin" / LEXILLA_LIB;
 		if (Lexilla::Load(sharedLibrary.string())) {
-			success = AccessLexilla(examplesDirectory);
+			success = benchmark ? BenchmarkLexilla(examplesDirectory, options) : AccessLexilla(examplesDirectory);
 		} else {
 			std::cout << "Failed to load " << sharedLibrary << "\n";
 		}
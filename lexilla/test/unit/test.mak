@@ -4,7 +4,7 @@
 DEL = del /q
 EXE = unitTest.exe
 
-INCLUDEDIRS = /I../../include /I../../src /I../../lexlib /I../../../scintilla/include
+INCLUDEDIRS = /I.. /I../../include /I../../src /I../../lexlib /I../../../scintilla/include
 
 CXXFLAGS = /EHsc /std:c++17 /D_HAS_AUTO_PTR_ETC=1 /wd 4805 $(INCLUDEDIRS)
 
@@ -14,11 +14,14 @@ TESTSRC=test*.cxx
 TESTEDSRC=\
  ../../lexlib/Accessor.cxx \
  ../../lexlib/CharacterSet.cxx \
+ ../../lexlib/LexAccessor.cxx \
  ../../lexlib/LexerBase.cxx \
+ ../../lexlib/LexerChunks.cxx \
  ../../lexlib/LexerModule.cxx \
  ../../lexlib/LexerSimple.cxx \
  ../../lexlib/PropSetSimple.cxx \
- ../../lexlib/WordList.cxx
+ ../../lexlib/WordList.cxx \
+ ../TestDocument.cxx
 
 TESTS=$(EXE)
 
@@ -0,0 +1,118 @@
+/** @file testLexerCheckpoints.cxx
+ ** Unit Tests for Lexilla internal data structures
+ **/
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "Sci_Position.h"
+
+#include "SparseState.h"
+#include "LexerCheckpoints.h"
+
+#include "catch.hpp"
+
+using namespace Lexilla;
+
+// Test Checkpoints.
+
+TEST_CASE("Checkpoints") {
+
+	Checkpoints<int> cps(10, 4);
+
+	SECTION("IsEmptyInitially") {
+		REQUIRE(0u == cps.size());
+		int state = -1;
+		REQUIRE(0 == cps.Restore(25, state));
+		REQUIRE(-1 == state);
+	}
+
+	SECTION("SaveInOrder") {
+		REQUIRE(!cps.Due(0));
+		REQUIRE(!cps.Due(20));
+		REQUIRE(cps.Due(10));
+		cps.Save(20, 2);	// Not due so ignored
+		REQUIRE(0u == cps.size());
+		cps.Save(10, 1);
+		REQUIRE(cps.Due(20));
+		cps.Save(20, 2);
+		REQUIRE(2u == cps.size());
+		int state = 0;
+		REQUIRE(20 == cps.Restore(25, state));
+		REQUIRE(2 == state);
+		REQUIRE(10 == cps.Restore(19, state));
+		REQUIRE(1 == state);
+		REQUIRE(0 == cps.Restore(9, state));
+		REQUIRE(1 == state);
+		// Nothing saved after 20 so restores from there
+		REQUIRE(20 == cps.Restore(95, state));
+		REQUIRE(2 == state);
+	}
+
+	SECTION("EqualStatesStoredOnce") {
+		cps.Save(10, 1);
+		cps.Save(20, 1);
+		cps.Save(30, 1);
+		REQUIRE(1u == cps.size());
+		int state = 0;
+		REQUIRE(30 == cps.Restore(35, state));
+		REQUIRE(1 == state);
+	}
+
+	SECTION("InvalidateAfter") {
+		cps.Save(10, 1);
+		cps.Save(20, 2);
+		cps.Save(30, 3);
+		// A change on line 20 leaves the state at its start valid
+		cps.InvalidateAfter(20);
+		REQUIRE(2u == cps.size());
+		int state = 0;
+		REQUIRE(20 == cps.Restore(35, state));
+		REQUIRE(2 == state);
+		REQUIRE(cps.Due(30));
+		cps.InvalidateAfter(15);
+		REQUIRE(1u == cps.size());
+		REQUIRE(10 == cps.Restore(35, state));
+		REQUIRE(1 == state);
+		cps.InvalidateAfter(0);
+		REQUIRE(0u == cps.size());
+		REQUIRE(cps.Due(10));
+	}
+
+	SECTION("Thin") {
+		for (Sci_Position line = 10; line <= 50; line += 10) {
+			cps.Save(line, static_cast<int>(line));
+		}
+		// Fifth checkpoint is more than maximum so interval doubled
+		REQUIRE(20 == cps.Interval());
+		REQUIRE(2u == cps.size());
+		int state = 0;
+		REQUIRE(40 == cps.Restore(55, state));
+		REQUIRE(40 == state);
+		REQUIRE(20 == cps.Restore(39, state));
+		REQUIRE(20 == state);
+		REQUIRE(cps.Due(60));
+		cps.Clear();
+		REQUIRE(10 == cps.Interval());
+		REQUIRE(0u == cps.size());
+	}
+
+	SECTION("SaveStart") {
+		cps.Save(10, 1);
+		cps.SaveStart(13, 5);
+		int state = 0;
+		REQUIRE(13 == cps.Restore(13, state));
+		REQUIRE(5 == state);
+		REQUIRE(13 == cps.Restore(17, state));
+		REQUIRE(10 == cps.Restore(12, state));
+		REQUIRE(1 == state);
+		// A change before the start line means its state may be wrong
+		cps.InvalidateAfter(12);
+		REQUIRE(10 == cps.Restore(17, state));
+		REQUIRE(1 == state);
+	}
+
+}
@@ -0,0 +1,151 @@
+/** @file testLexerChunks.cxx
+ ** Unit Tests for Lexilla internal data structures
+ **/
+
+#include <cassert>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ILexer.h"
+#include "Scintilla.h"
+
+#include "PropSetSimple.h"
+#include "WordList.h"
+#include "LexAccessor.h"
+#include "Accessor.h"
+#include "LexerModule.h"
+#include "LexerChunks.h"
+
+#include "TestDocument.h"
+
+#include "catch.hpp"
+
+using namespace Lexilla;
+
+// Test LexInChunks.
+
+namespace {
+
+// Styles each line by its first character and sets the line state to the line's length.
+void ColouriseLines(Sci_PositionU startPos, Sci_Position length, int, WordList *[], Accessor &styler) {
+	styler.StartAt(startPos);
+	styler.StartSegment(startPos);
+	const Sci_Position endPos = startPos + length;
+	Sci_Position lineStart = startPos;
+	for (Sci_Position i = startPos; i < endPos; i++) {
+		if ((styler[i] == '\n') || (i == endPos - 1)) {
+			styler.ColourTo(i, styler[lineStart] & 0x7);
+			styler.SetLineState(styler.GetLine(i), static_cast<int>(i - lineStart));
+			lineStart = i + 1;
+		}
+	}
+}
+
+// Level depends on all earlier lines: '+' opens a level and '-' closes one.
+void FoldLines(Sci_PositionU startPos, Sci_Position length, int, WordList *[], Accessor &styler) {
+	const Sci_Position endPos = startPos + length;
+	Sci_Position line = styler.GetLine(startPos);
+	int levelPrevious = (line > 0) ? (styler.LevelAt(line - 1) & SC_FOLDLEVELNUMBERMASK) : SC_FOLDLEVELBASE;
+	for (Sci_Position i = styler.LineStart(line); i < endPos; i = styler.LineStart(++line)) {
+		int level = levelPrevious;
+		if (styler[i] == '+') {
+			level++;
+		} else if ((styler[i] == '-') && (level > SC_FOLDLEVELBASE)) {
+			level--;
+		}
+		styler.SetLevel(line, level);
+		levelPrevious = level;
+	}
+}
+
+std::string LinesText() {
+	std::string text;
+	const std::string_view leads = "+-ab+cd-efgh";
+	for (size_t line = 0; line < 5000; line++) {
+		text += leads[(line * 7) % leads.length()];
+		text.append(line % 37, 'x');
+		text += '\n';
+	}
+	return text;
+}
+
+// Styles then line states and levels for each line.
+std::vector<int> Results(const TestDocument &doc) {
+	std::vector<int> results;
+	for (Sci_Position position = 0; position < doc.Length(); position++) {
+		results.push_back(doc.StyleAt(position));
+	}
+	const Sci_Position lines = doc.LineFromPosition(doc.Length());
+	for (Sci_Position line = 0; line <= lines; line++) {
+		results.push_back(doc.GetLineState(line));
+		results.push_back(doc.GetLevel(line));
+	}
+	return results;
+}
+
+void RequireSameResults(const TestDocument &doc, const TestDocument &docExpected) {
+	REQUIRE(Results(doc) == Results(docExpected));
+}
+
+}
+
+TEST_CASE("LexInChunks") {
+
+	const std::string text = LinesText();
+	const Sci_Position length = text.length();
+	PropSetSimple props;
+	WordList *keywordlists[] = { nullptr };
+	TestDocument doc;
+	doc.Set(text);
+	TestDocument docExpected;
+	docExpected.Set(text);
+
+	SECTION("Lex") {
+		REQUIRE(LexInChunks(ColouriseLines, 0, length, 0, keywordlists, props, &doc, 1000, 4));
+		Accessor styler(&docExpected, &props);
+		ColouriseLines(0, length, 0, keywordlists, styler);
+		styler.Flush();
+		RequireSameResults(doc, docExpected);
+	}
+
+	SECTION("LexPart") {
+		// Starting part way with a chunk ending before the end of the document
+		const Sci_Position start = doc.LineStart(100);
+		const Sci_Position end = doc.LineStart(4000);
+		REQUIRE(LexInChunks(ColouriseLines, start, end - start, 0, keywordlists, props, &doc, 1000, 3));
+		Accessor styler(&docExpected, &props);
+		ColouriseLines(start, end - start, 0, keywordlists, styler);
+		styler.Flush();
+		RequireSameResults(doc, docExpected);
+	}
+
+	SECTION("FoldDependingOnEarlierChunks") {
+		// Later chunks read levels that change when earlier chunks are stitched so are folded again
+		REQUIRE(LexInChunks(FoldLines, 0, length, 0, keywordlists, props, &doc, 1000, 4));
+		Accessor styler(&docExpected, &props);
+		FoldLines(0, length, 0, keywordlists, styler);
+		styler.Flush();
+		RequireSameResults(doc, docExpected);
+	}
+
+	SECTION("Refold") {
+		// Folded again over earlier results where boundary levels do not change
+		Accessor styler(&docExpected, &props);
+		FoldLines(0, length, 0, keywordlists, styler);
+		styler.Flush();
+		Accessor stylerFirst(&doc, &props);
+		FoldLines(0, length, 0, keywordlists, stylerFirst);
+		stylerFirst.Flush();
+		REQUIRE(LexInChunks(FoldLines, 0, length, 0, keywordlists, props, &doc, 1000, 4));
+		RequireSameResults(doc, docExpected);
+	}
+
+	SECTION("TooShort") {
+		REQUIRE(!LexInChunks(ColouriseLines, 0, length, 0, keywordlists, props, &doc, length, 4));
+		REQUIRE(!LexInChunks(ColouriseLines, 0, length, 0, keywordlists, props, &doc, 1000, 1));
+		RequireSameResults(doc, docExpected);
+	}
+
+}
@@ -4,12 +4,41 @@
 
 #include <string.h>
 
+#include <string>
+#include <vector>
+#include <set>
+
 #include "WordList.h"
 
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 
 using namespace Lexilla;
 
+namespace {
+
+// Keyword-like lower case words with underscores, such as SQL keywords or API names.
+// Words from seeds with a common factor partially overlap.
+std::vector<std::string> GenerateWords(size_t count, unsigned int seed) {
+	std::vector<std::string> words;
+	unsigned int state = 1;
+	for (size_t i = 0; i < count; i++) {
+		std::string word;
+		const unsigned int wordSeed = static_cast<unsigned int>(i) * seed;
+		state = wordSeed * 2654435761U + 12345;
+		const size_t length = 2 + state % 12;
+		for (size_t j = 0; j < length; j++) {
+			state = state * 1103515245U + 12345;
+			const unsigned int choice = (state >> 16) % 28;
+			word += (choice >= 26) ? '_' : static_cast<char>('a' + choice);
+		}
+		words.push_back(word);
+	}
+	return words;
+}
+
+}
+
 // Test WordList.
 
 TEST_CASE("WordList") {
@@ -86,4 +115,65 @@ TEST_CASE("WordList") {
 		REQUIRE(wl.InListAbridged("abz", '~'));
 		REQUIRE(wl.InListAbridged("az", '~'));
 	}
+
+	SECTION("InListPrefix") {
+		wl.Set("^GTK_ gtk ^x");
+		REQUIRE(wl.InList("gtk"));
+		REQUIRE(wl.InList("GTK_"));
+		REQUIRE(wl.InList("GTK_MAJOR_VERSION"));
+		REQUIRE(wl.InList("x"));
+		REQUIRE(wl.InList("^x"));
+		REQUIRE(!wl.InList("GTK"));
+		REQUIRE(!wl.InList("gtk_"));
+		// '^' alone is a prefix of everything
+		wl.Set("^");
+		REQUIRE(wl.InList("anything"));
+		REQUIRE(wl.InList(""));
+	}
+
+	SECTION("InListLarge") {
+		const std::vector<std::string> keywords = GenerateWords(3000, 1);
+		std::string list;
+		for (const std::string &keyword : keywords) {
+			list += keyword;
+			list += ' ';
+		}
+		wl.Set(list.c_str());
+		const std::set<std::string> words(keywords.begin(), keywords.end());
+		REQUIRE(static_cast<size_t>(wl.Length()) == keywords.size());
+		for (const std::string &keyword : keywords) {
+			REQUIRE(wl.InList(keyword.c_str()));
+		}
+		for (const std::string &other : GenerateWords(3000, 2)) {
+			REQUIRE(wl.InList(other.c_str()) == (words.count(other) > 0));
+			const std::string extended = other + "x";
+			REQUIRE(wl.InList(extended.c_str()) == (words.count(extended) > 0));
+			const std::string shortened = other.substr(0, other.length() - 1);
+			REQUIRE(wl.InList(shortened.c_str()) == (words.count(shortened) > 0));
+		}
+	}
+}
+
+TEST_CASE("WordListBenchmark", "[.benchmark]") {
+
+	// Identifiers from a document are a mix of keywords and other names
+	const std::vector<std::string> identifiers = GenerateWords(2000, 7);
+
+	for (const size_t wordCount : { 30, 300, 3000 }) {
+		const std::vector<std::string> keywords = GenerateWords(wordCount, 7);
+		std::string list;
+		for (const std::string &keyword : keywords) {
+			list += keyword;
+			list += ' ';
+		}
+		WordList wl;
+		wl.Set(list.c_str());
+		BENCHMARK("InList " + std::to_string(wordCount) + " words") {
+			int found = 0;
+			for (const std::string &identifier : identifiers) {
+				found += wl.InList(identifier.c_str());
+			}
+			return found;
+		};
+	}
 }
@@ -259,6 +259,18 @@ bool ScintillaCall::UndoCollection() {
 	return Call(Message::GetUndoCollection);
 }
 
+void ScintillaCall::SetUndoMemoryLimit(Position bytes) {
+	Call(Message::SetUndoMemoryLimit, bytes);
+}
+
+Position ScintillaCall::UndoMemoryLimit() {
+	return Call(Message::GetUndoMemoryLimit);
+}
+
+Position ScintillaCall::UndoMemoryUsed() {
+	return Call(Message::GetUndoMemoryUsed);
+}
+
 WhiteSpace ScintillaCall::ViewWS() {
 	return static_cast<Scintilla::WhiteSpace>(Call(Message::GetViewWS));
 }
@@ -1427,10 +1439,26 @@ Position ScintillaCall::ReplaceTargetMinimal(Position length, const char *text)
 	return CallString(Message::ReplaceTargetMinimal, length, text);
 }
 
+Position ScintillaCall::ReplaceRanges(Position count, void *replacements) {
+	return CallPointer(Message::ReplaceRanges, count, replacements);
+}
+
 Position ScintillaCall::SearchInTarget(Position length, const char *text) {
 	return CallString(Message::SearchInTarget, length, text);
 }
 
+int ScintillaCall::SearchAllInTarget(Position length, const char *text) {
+	return static_cast<int>(CallString(Message::SearchAllInTarget, length, text));
+}
+
+Position ScintillaCall::SearchAllNext(int search) {
+	return Call(Message::SearchAllNext, search);
+}
+
+void ScintillaCall::SearchAllCancel(int search) {
+	Call(Message::SearchAllCancel, search);
+}
+
 void ScintillaCall::SetSearchFlags(Scintilla::FindOption searchFlags) {
 	Call(Message::SetSearchFlags, static_cast<uintptr_t>(searchFlags));
 }
@@ -1643,6 +1671,14 @@ IdleStyling ScintillaCall::IdleStyling() {
 	return static_cast<Scintilla::IdleStyling>(Call(Message::GetIdleStyling));
 }
 
+void ScintillaCall::SetIdleStylingThreaded(bool threaded) {
+	Call(Message::SetIdleStylingThreaded, threaded);
+}
+
+bool ScintillaCall::IdleStylingThreaded() {
+	return Call(Message::GetIdleStylingThreaded);
+}
+
 void ScintillaCall::SetWrapMode(Scintilla::Wrap wrapMode) {
 	Call(Message::SetWrapMode, static_cast<uintptr_t>(wrapMode));
 }
@@ -2631,6 +2667,10 @@ int ScintillaCall::PositionCache() {
 	return static_cast<int>(Call(Message::GetPositionCache));
 }
 
+Position ScintillaCall::PositionCacheStatistic(Scintilla::PositionCacheStatistic statistic) {
+	return Call(Message::GetPositionCacheStatistic, static_cast<uintptr_t>(statistic));
+}
+
 void ScintillaCall::SetLayoutThreads(int threads) {
 	Call(Message::SetLayoutThreads, threads);
 }
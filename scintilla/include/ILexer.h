@@ -12,7 +12,7 @@
 
 namespace Scintilla {
 
-enum { dvRelease4=2 };
+enum { dvRelease4=2, dvRelease5=3 };
 
 class IDocument {
 public:
@@ -42,6 +42,12 @@ public:
 	virtual int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const = 0;
 };
 
+class IDocument5 : public IDocument {
+public:
+	virtual const char * SCI_METHOD ContiguousRangePointer(Sci_Position position, Sci_Position rangeLength) const = 0;
+	virtual bool SCI_METHOD SetStyleRuns(Sci_Position runs, const Sci_Position *lengths, const char *styles) = 0;
+};
+
 enum { lvRelease4=2, lvRelease5=3 };
 
 class ILexer4 {
@@ -70,6 +70,9 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_MARKERHANDLEFROMLINE 2732
 #define SCI_MARKERNUMBERFROMLINE 2733
 #define SCI_GETUNDOCOLLECTION 2019
+#define SCI_SETUNDOMEMORYLIMIT 2785
+#define SCI_GETUNDOMEMORYLIMIT 2786
+#define SCI_GETUNDOMEMORYUSED 2787
 #define SCWS_INVISIBLE 0
 #define SCWS_VISIBLEALWAYS 1
 #define SCWS_VISIBLEAFTERINDENT 2
@@ -558,7 +561,11 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_REPLACETARGET 2194
 #define SCI_REPLACETARGETRE 2195
 #define SCI_REPLACETARGETMINIMAL 2779
+#define SCI_REPLACERANGES 2788
 #define SCI_SEARCHINTARGET 2197
+#define SCI_SEARCHALLINTARGET 2789
+#define SCI_SEARCHALLNEXT 2790
+#define SCI_SEARCHALLCANCEL 2791
 #define SCI_SETSEARCHFLAGS 2198
 #define SCI_GETSEARCHFLAGS 2199
 #define SCI_CALLTIPSHOW 2200
@@ -639,6 +646,8 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SC_IDLESTYLING_ALL 3
 #define SCI_SETIDLESTYLING 2692
 #define SCI_GETIDLESTYLING 2693
+#define SCI_SETIDLESTYLINGTHREADED 2782
+#define SCI_GETIDLESTYLINGTHREADED 2783
 #define SC_WRAP_NONE 0
 #define SC_WRAP_WORD 1
 #define SC_WRAP_CHAR 2
@@ -805,6 +814,7 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_GETZOOM 2374
 #define SC_DOCUMENTOPTION_DEFAULT 0
 #define SC_DOCUMENTOPTION_STYLES_NONE 0x1
+#define SC_DOCUMENTOPTION_STYLES_LAZY 0x2
 #define SC_DOCUMENTOPTION_TEXT_LARGE 0x100
 #define SCI_CREATEDOCUMENT 2375
 #define SCI_ADDREFDOCUMENT 2376
@@ -954,6 +964,10 @@ typedef sptr_t (*SciFnDirectStatus)(sptr_t ptr, unsigned int iMessage, uptr_t wP
 #define SCI_INDICATOREND 2509
 #define SCI_SETPOSITIONCACHE 2514
 #define SCI_GETPOSITIONCACHE 2515
+#define SC_POSITIONCACHE_HITS 0
+#define SC_POSITIONCACHE_MISSES 1
+#define SC_POSITIONCACHE_EVICTIONS 2
+#define SCI_GETPOSITIONCACHESTATISTIC 2784
 #define SCI_SETLAYOUTTHREADS 2775
 #define SCI_GETLAYOUTTHREADS 2776
 #define SCI_COPYALLOWLINE 2519
@@ -1324,6 +1338,12 @@ struct Sci_TextToFindFull {
 	struct Sci_CharacterRangeFull chrgText;
 };
 
+struct Sci_TextReplacement {
+	struct Sci_CharacterRangeFull chrg;
+	const char *text;
+	Sci_Position length;
+};
+
 typedef void *Sci_SurfaceID;
 
 struct Sci_Rectangle {
@@ -103,6 +103,9 @@ public:
 	int MarkerHandleFromLine(Line line, int which);
 	int MarkerNumberFromLine(Line line, int which);
 	bool UndoCollection();
+	void SetUndoMemoryLimit(Position bytes);
+	Position UndoMemoryLimit();
+	Position UndoMemoryUsed();
 	Scintilla::WhiteSpace ViewWS();
 	void SetViewWS(Scintilla::WhiteSpace viewWS);
 	Scintilla::TabDrawMode TabDrawMode();
@@ -395,7 +398,11 @@ public:
 	Position ReplaceTarget(Position length, const char *text);
 	Position ReplaceTargetRE(Position length, const char *text);
 	Position ReplaceTargetMinimal(Position length, const char *text);
+	Position ReplaceRanges(Position count, void *replacements);
 	Position SearchInTarget(Position length, const char *text);
+	int SearchAllInTarget(Position length, const char *text);
+	Position SearchAllNext(int search);
+	void SearchAllCancel(int search);
 	void SetSearchFlags(Scintilla::FindOption searchFlags);
 	Scintilla::FindOption SearchFlags();
 	void CallTipShow(Position pos, const char *definition);
@@ -449,6 +456,8 @@ public:
 	bool IsRangeWord(Position start, Position end);
 	void SetIdleStyling(Scintilla::IdleStyling idleStyling);
 	Scintilla::IdleStyling IdleStyling();
+	void SetIdleStylingThreaded(bool threaded);
+	bool IdleStylingThreaded();
 	void SetWrapMode(Scintilla::Wrap wrapMode);
 	Scintilla::Wrap WrapMode();
 	void SetWrapVisualFlags(Scintilla::WrapVisualFlag wrapVisualFlags);
@@ -696,6 +705,7 @@ public:
 	Position IndicatorEnd(int indicator, Position pos);
 	void SetPositionCache(int size);
 	int PositionCache();
+	Position PositionCacheStatistic(Scintilla::PositionCacheStatistic statistic);
 	void SetLayoutThreads(int threads);
 	int LayoutThreads();
 	void CopyAllowLine();
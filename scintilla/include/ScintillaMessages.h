@@ -41,6 +41,9 @@ enum class Message {
 	MarkerHandleFromLine = 2732,
 	MarkerNumberFromLine = 2733,
 	GetUndoCollection = 2019,
+	SetUndoMemoryLimit = 2785,
+	GetUndoMemoryLimit = 2786,
+	GetUndoMemoryUsed = 2787,
 	GetViewWS = 2020,
 	SetViewWS = 2021,
 	GetTabDrawMode = 2698,
@@ -324,7 +327,11 @@ enum class Message {
 	ReplaceTarget = 2194,
 	ReplaceTargetRE = 2195,
 	ReplaceTargetMinimal = 2779,
+	ReplaceRanges = 2788,
 	SearchInTarget = 2197,
+	SearchAllInTarget = 2789,
+	SearchAllNext = 2790,
+	SearchAllCancel = 2791,
 	SetSearchFlags = 2198,
 	GetSearchFlags = 2199,
 	CallTipShow = 2200,
@@ -377,6 +384,8 @@ enum class Message {
 	IsRangeWord = 2691,
 	SetIdleStyling = 2692,
 	GetIdleStyling = 2693,
+	SetIdleStylingThreaded = 2782,
+	GetIdleStylingThreaded = 2783,
 	SetWrapMode = 2268,
 	GetWrapMode = 2269,
 	SetWrapVisualFlags = 2460,
@@ -618,6 +627,7 @@ enum class Message {
 	IndicatorEnd = 2509,
 	SetPositionCache = 2514,
 	GetPositionCache = 2515,
+	GetPositionCacheStatistic = 2784,
 	SetLayoutThreads = 2775,
 	GetLayoutThreads = 2776,
 	CopyAllowLine = 2519,
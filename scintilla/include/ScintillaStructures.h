@@ -46,6 +46,12 @@ struct TextToFindFull {
 	CharacterRangeFull chrgText;
 };
 
+struct TextReplacement {
+	CharacterRangeFull chrg;
+	const char *text;
+	Position length;
+};
+
 using SurfaceID = void *;
 
 struct Rectangle {
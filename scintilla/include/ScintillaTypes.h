@@ -403,6 +403,7 @@ enum class PopUp {
 enum class DocumentOption {
 	Default = 0,
 	StylesNone = 0x1,
+	StylesLazy = 0x2,
 	TextLarge = 0x100,
 };
 
@@ -449,6 +450,12 @@ enum class Ordering {
 	Custom = 2,
 };
 
+enum class PositionCacheStatistic {
+	Hits = 0,
+	Misses = 1,
+	Evictions = 2,
+};
+
 enum class CaretSticky {
 	Off = 0,
 	On = 1,
@@ -13,6 +13,8 @@
 
 #include <cstdio>
 
+#include <atomic>
+
 #include "PlatQt.h"
 #include "Scintilla.h"
 #include "XPM.h"
@@ -30,6 +32,7 @@
 #include <QPaintEngine>
 #include <QWidget>
 #include <QPixmap>
+#include <QImage>
 #include <QPainter>
 #include <QPainterPath>
 #include <QMenu>
@@ -124,17 +127,39 @@ static QFont::StyleStrategy ChooseStrategy(FontQuality eff)
 	}
 }
 
+static std::atomic<unsigned int> fontSerialNext = 1;
+
 class FontAndCharacterSet : public Font {
 public:
 	CharacterSet characterSet = CharacterSet::Ansi;
 	std::unique_ptr<QFont> pfont;
-	explicit FontAndCharacterSet(const FontParameters &fp) : characterSet(fp.characterSet) {
-		pfont = std::make_unique<QFont>();
-		pfont->setStyleStrategy(ChooseStrategy(fp.extraFontFlag));
-		pfont->setFamily(QString::fromUtf8(fp.faceName));
-		pfont->setPointSizeF(fp.size);
-		pfont->setBold(static_cast<int>(fp.weight) > 500);
-		pfont->setItalic(fp.italic);
+	// Attributes retained so that measuring threads can build private QFont instances
+	// as QFont is reentrant but not thread-safe.
+	QString family;
+	QFont::StyleStrategy strategy;
+	qreal pointSize;
+	bool bold;
+	bool italic;
+	// Identifies this font in per-thread caches where addresses may be reused
+	unsigned int serial;
+	explicit FontAndCharacterSet(const FontParameters &fp) :
+		characterSet(fp.characterSet),
+		family(QString::fromUtf8(fp.faceName)),
+		strategy(ChooseStrategy(fp.extraFontFlag)),
+		pointSize(fp.size),
+		bold(static_cast<int>(fp.weight) > 500),
+		italic(fp.italic),
+		serial(fontSerialNext.fetch_add(1, std::memory_order_relaxed)) {
+		pfont = NewQFont();
+	}
+	std::unique_ptr<QFont> NewQFont() const {
+		std::unique_ptr<QFont> font = std::make_unique<QFont>();
+		font->setStyleStrategy(strategy);
+		font->setFamily(family);
+		font->setPointSizeF(pointSize);
+		font->setBold(bold);
+		font->setItalic(italic);
+		return font;
 	}
 };
 
@@ -145,6 +170,11 @@ const Supports SupportsQt[] = {
 	Supports::FractionalStrokeWidth,
 	Supports::TranslucentStroke,
 	Supports::PixelModification,
+#ifdef PLAT_QT_QML
+	// QML surfaces measure on a per-thread image instead of the paint device so
+	// measurement does not touch any GUI object and may run on layout threads.
+	Supports::ThreadSafeMeasureWidths,
+#endif
 };
 
 const FontAndCharacterSet *AsFontAndCharacterSet(const Font *f) {
@@ -156,6 +186,48 @@ QFont *FontPointer(const Font *f)
 	return AsFontAndCharacterSet(f)->pfont.get();
 }
 
+// Each thread that measures text uses its own QFont objects and codec lookups
+// so that EditView::LayoutLine can call MeasureWidths from several threads.
+
+struct ThreadFont {
+	unsigned int serial;
+	std::unique_ptr<QFont> font;
+};
+
+constexpr size_t threadFontsMaximum = 64;
+
+thread_local std::vector<ThreadFont> threadFonts;
+
+const QFont &FontForThread(const Font *f)
+{
+	const FontAndCharacterSet *pfacs = AsFontAndCharacterSet(f);
+	for (const ThreadFont &tf : threadFonts) {
+		if (tf.serial == pfacs->serial)
+			return *tf.font;
+	}
+	if (threadFonts.size() >= threadFontsMaximum) {
+		// Discard the oldest entry
+		threadFonts.erase(threadFonts.begin());
+	}
+	threadFonts.push_back({ pfacs->serial, pfacs->NewQFont() });
+	return *threadFonts.back().font;
+}
+
+thread_local const char *threadCodecName = nullptr;
+thread_local QTextCodec *threadCodec = nullptr;
+
+QTextCodec *CodecForThread(const Font *f, const SurfaceMode &mode)
+{
+	const char *csid = "UTF-8";
+	if (!(mode.codePage == SC_CP_UTF8))
+		csid = CharacterSetID(AsFontAndCharacterSet(f)->characterSet);
+	if (csid != threadCodecName) {
+		threadCodecName = csid;
+		threadCodec = QTextCodec::codecForName(csid);
+	}
+	return threadCodec;
+}
+
 }
 
 std::shared_ptr<Font> Font::Allocate(const FontParameters &fp)
@@ -172,6 +244,7 @@ SurfaceImpl::SurfaceImpl(int width, int height, SurfaceMode mode_)
 	deviceOwned = true;
 	device = new QPixmap(width, height);
 	mode = mode_;
+	SetMeasuringResolution(device);
 }
 
 SurfaceImpl::~SurfaceImpl()
@@ -192,6 +265,21 @@ void SurfaceImpl::Clear()
 	painter = nullptr;
 	deviceOwned = false;
 	painterOwned = false;
+	measuringDpiX = 0;
+	measuringDpiY = 0;
+}
+
+void SurfaceImpl::SetMeasuringResolution(const QPaintDevice *pd)
+{
+	if (pd) {
+		SetMeasuringResolution(pd->logicalDpiX(), pd->logicalDpiY());
+	}
+}
+
+void SurfaceImpl::SetMeasuringResolution(int dpiX, int dpiY) noexcept
+{
+	measuringDpiX = dpiX;
+	measuringDpiY = dpiY;
 }
 
 void SurfaceImpl::Init(bool signatureFlag, PainterID pid)    // wid is QQuickPaintedItem here
@@ -200,6 +288,7 @@ void SurfaceImpl::Init(bool signatureFlag, PainterID pid)    // wid is QQuickPai
     Release();
 #ifdef PLAT_QT_QML
     painter = static_cast<QPainter *>(pid);
+    SetMeasuringResolution(painter ? painter->device() : nullptr);
 #else
     Q_ASSERT(false);
 #endif
@@ -600,9 +689,9 @@ void SurfaceImpl::MeasureWidths(const Font *font,
 {
 	if (!font)
 		return;
-	SetCodec(font);
-	QString su = UnicodeFromText(codec, text);
-	QTextLayout tlay(su, *FontPointer(font), GetPaintDevice());
+	// Only thread-local state is used here as this may be called from layout threads
+	QString su = UnicodeFromText(CodecForThread(font, mode), text);
+	QTextLayout tlay(su, FontForThread(font), MeasuringDevice());
 	tlay.beginLayout();
 	QTextLine tl = tlay.createLine();
 	tlay.endLayout();
@@ -647,7 +736,7 @@ void SurfaceImpl::MeasureWidths(const Font *font,
 
 XYPOSITION SurfaceImpl::WidthText(const Font *font, std::string_view text)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	QFontMetricsF metrics(*FontPointer(font), MeasuringDevice());
 	SetCodec(font);
 	QString su = UnicodeFromText(codec, text);
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -705,8 +794,9 @@ void SurfaceImpl::MeasureWidthsUTF8(const Font *font,
 {
 	if (!font)
 		return;
+	// Only thread-local state is used here as this may be called from layout threads
 	QString su = QString::fromUtf8(text.data(), static_cast<int>(text.length()));
-	QTextLayout tlay(su, *FontPointer(font), GetPaintDevice());
+	QTextLayout tlay(su, FontForThread(font), MeasuringDevice());
 	tlay.beginLayout();
 	QTextLine tl = tlay.createLine();
 	tlay.endLayout();
@@ -733,7 +823,7 @@ void SurfaceImpl::MeasureWidthsUTF8(const Font *font,
 
 XYPOSITION SurfaceImpl::WidthTextUTF8(const Font *font, std::string_view text)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	QFontMetricsF metrics(*FontPointer(font), MeasuringDevice());
 	QString su = QString::fromUtf8(text.data(), static_cast<int>(text.length()));
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 	return metrics.horizontalAdvance(su);
@@ -744,13 +834,13 @@ XYPOSITION SurfaceImpl::WidthTextUTF8(const Font *font, std::string_view text)
 
 XYPOSITION SurfaceImpl::Ascent(const Font *font)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	QFontMetricsF metrics(*FontPointer(font), MeasuringDevice());
 	return metrics.ascent();
 }
 
 XYPOSITION SurfaceImpl::Descent(const Font *font)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	QFontMetricsF metrics(*FontPointer(font), MeasuringDevice());
 	// Qt returns 1 less than true descent
 	// See: QFontEngineWin::descent which says:
 	// ### we subtract 1 to even out the historical +1 in QFontMetrics's
@@ -765,13 +855,13 @@ XYPOSITION SurfaceImpl::InternalLeading(const Font * /* font */)
 
 XYPOSITION SurfaceImpl::Height(const Font *font)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	QFontMetricsF metrics(*FontPointer(font), MeasuringDevice());
 	return metrics.height();
 }
 
 XYPOSITION SurfaceImpl::AverageCharWidth(const Font *font)
 {
-	QFontMetricsF metrics(*FontPointer(font), device);
+	QFontMetricsF metrics(*FontPointer(font), MeasuringDevice());
 	return metrics.averageCharWidth();
 }
 
@@ -792,6 +882,26 @@ QPaintDevice *SurfaceImpl::GetPaintDevice()
 	return device;
 }
 
+QPaintDevice *SurfaceImpl::MeasuringDevice()
+{
+#ifdef PLAT_QT_QML
+	// The painter's device may not be used off the GUI thread so each thread measures
+	// on its own image, which is safe from any thread, set to the surface's resolution.
+	if (measuringDpiX <= 0 || measuringDpiY <= 0)
+		return nullptr;
+	thread_local QImage measuringImage(1, 1, QImage::Format_ARGB32_Premultiplied);
+	const int dotsPerMeterX = qRound(measuringDpiX / 0.0254);
+	const int dotsPerMeterY = qRound(measuringDpiY / 0.0254);
+	if (measuringImage.dotsPerMeterX() != dotsPerMeterX)
+		measuringImage.setDotsPerMeterX(dotsPerMeterX);
+	if (measuringImage.dotsPerMeterY() != dotsPerMeterY)
+		measuringImage.setDotsPerMeterY(dotsPerMeterY);
+	return &measuringImage;
+#else
+	return device;
+#endif
+}
+
 QPainter *SurfaceImpl::GetPainter()
 {
 #ifndef PLAT_QT_QML
@@ -96,10 +96,16 @@ private:
 	SurfaceMode mode;
 	const char *codecName = nullptr;
 	QTextCodec *codec = nullptr;
+	// Resolution of the surface, read on the GUI thread when it is initialised
+	int measuringDpiX = 0;
+	int measuringDpiY = 0;
 
 	void Clear();
+	void SetMeasuringResolution(const QPaintDevice *pd);
 
 public:
+	// Surfaces without a device measure at a resolution set by their owner
+	void SetMeasuringResolution(int dpiX, int dpiY) noexcept;
 	SurfaceImpl();
 	SurfaceImpl(int width, int height, SurfaceMode mode_);
 	virtual ~SurfaceImpl();
@@ -174,6 +180,7 @@ public:
 	void SetFont(const Font *font);
 
 	QPaintDevice *GetPaintDevice();
+	QPaintDevice *MeasuringDevice();
 	void SetPainter(QPainter *painter);
 	QPainter *GetPainter();
 };
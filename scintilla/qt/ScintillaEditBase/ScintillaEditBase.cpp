@@ -17,6 +17,8 @@
 
 #include "Position.h"
 
+#include <limits>
+
 #include <QApplication>
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #include <QInputContext>
@@ -30,6 +32,10 @@
 #include <QPoint>
 #include <QPair>
 #include <QList>
+#include <QtMath>
+#include <QImage>
+#include <QQuickWindow>
+#include <QSGSimpleTextureNode>
 #endif
 
 constexpr int IndicatorInput = static_cast<int>(Scintilla::IndicatorNumbers::Ime);
@@ -62,6 +68,7 @@ ScintillaEditBase::ScintillaEditBase(QQuickItem/*QWidget*/ *parent)
 , dataInputMethodHints(Qt::ImhNone)
 //, aLongTouchTimer(this)
 , aLastTouchPressTime(-1)
+, painterNode(nullptr), lineTilesRatio(1.0), lineTilesHeight(0)
 #endif
 , sqt(new ScintillaQt(this)), preeditPos(-1), wheelDelta(0)
 {
@@ -266,8 +273,130 @@ bool ScintillaEditBase::event(QEvent *event)
 
 void ScintillaEditBase::paint(QPainter *painter)
 {
-	//sqt->PartialPaintQml(PRectFromQRect(/*boundingRect().toRect()*/painter->clipRegion().boundingRect()), painter);
-	sqt->PartialPaintQml(PRectFromQRect(boundingRect().toRect()), painter);
+	// QQuickPaintedItem keeps the previous image and clips the painter to the union of
+	// the rectangles passed to update() since then, which come from Editor::RedrawRect.
+	// Without a clip the whole item is being painted, such as after a resize.
+	const QRect rcPaint = painter->hasClipping() ?
+		painter->clipBoundingRect().toAlignedRect() : boundingRect().toAlignedRect();
+	sqt->PartialPaintQml(PRectFromQRect(rcPaint), painter);
+}
+
+QSGNode *ScintillaEditBase::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
+{
+	if (!oldNode) {
+		// The scene graph was released along with all nodes
+		painterNode = nullptr;
+		lineTileNodes.clear();
+	}
+	if (sqt->lineTiles) {
+		return UpdateLineTiles(oldNode);
+	}
+	if (oldNode && (oldNode != painterNode)) {
+		// Leaving line tiles so drop the tile tree and let QQuickPaintedItem create a new
+		// painter node which is fully painted as setLineTiles updated the whole item.
+		delete oldNode;
+		lineTileNodes.clear();
+		oldNode = nullptr;
+	}
+	painterNode = QQuickPaintedItem::updatePaintNode(oldNode, data);
+	return painterNode;
+}
+
+QSGNode *ScintillaEditBase::UpdateLineTiles(QSGNode *oldNode)
+{
+	QSGNode *root = oldNode;
+	if (!root || (root == painterNode)) {
+		// The painter node is not updated while tiles are used so it would be drawn
+		// stale under them. It is deleted and recreated if line tiles are turned off.
+		delete painterNode;
+		painterNode = nullptr;
+		root = new QSGNode();
+		lineTileNodes.clear();
+	}
+
+	const QSize sizeItem(qCeil(width()), qCeil(height()));
+	const qreal ratio = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+	const int lineHeight = sqt->vs.lineHeight;
+	if (sqt->lineTilesInvalidAll || (sizeItem != lineTilesSize) ||
+		(ratio != lineTilesRatio) || (lineHeight != lineTilesHeight)) {
+		RemoveLineTiles(root, 0, std::numeric_limits<Sci::Line>::max());
+		lineTilesSize = sizeItem;
+		lineTilesRatio = ratio;
+		lineTilesHeight = lineHeight;
+	} else {
+		for (const std::pair<Sci::Line, Sci::Line> &range : sqt->lineTilesInvalid) {
+			RemoveLineTiles(root, range.first, range.second);
+		}
+	}
+	sqt->lineTilesInvalidAll = false;
+	sqt->lineTilesInvalid.clear();
+	if (sizeItem.isEmpty() || (lineHeight <= 0) || !window()) {
+		return root;
+	}
+
+	// Drop tiles scrolled out of view then render runs of lines that have no tile
+	const Sci::Line lineTop = sqt->topLine;
+	const Sci::Line lineBottom = lineTop + (sizeItem.height() + lineHeight - 1) / lineHeight;
+	RemoveLineTiles(root, 0, lineTop);
+	RemoveLineTiles(root, lineBottom, std::numeric_limits<Sci::Line>::max());
+	Sci::Line line = lineTop;
+	while (line < lineBottom) {
+		if (lineTileNodes.count(line)) {
+			line++;
+		} else {
+			Sci::Line lineEndRun = line + 1;
+			while ((lineEndRun < lineBottom) && !lineTileNodes.count(lineEndRun)) {
+				lineEndRun++;
+			}
+			RenderLineTiles(root, line, lineEndRun);
+			line = lineEndRun;
+		}
+	}
+
+	for (const auto &[lineTile, node] : lineTileNodes) {
+		node->setRect(0, static_cast<qreal>(lineTile - lineTop) * lineHeight, sizeItem.width(), lineHeight);
+	}
+	return root;
+}
+
+void ScintillaEditBase::RenderLineTiles(QSGNode *root, Sci::Line lineFirst, Sci::Line lineLast)
+{
+	// Paint the run of lines with one call then split it into a texture for each line
+	const int lineHeight = lineTilesHeight;
+	const qreal top = static_cast<qreal>(lineFirst - sqt->topLine) * lineHeight;
+	const qreal heightRun = static_cast<qreal>(lineLast - lineFirst) * lineHeight;
+	QImage image(qCeil(lineTilesSize.width() * lineTilesRatio), qCeil(heightRun * lineTilesRatio),
+		QImage::Format_ARGB32_Premultiplied);
+	image.setDevicePixelRatio(lineTilesRatio);
+	image.fill(Qt::transparent);
+	{
+		QPainter painter(&image);
+		painter.translate(0, -top);
+		sqt->PartialPaintQml(PRectangle(0, top, lineTilesSize.width(), top + heightRun), &painter);
+	}
+
+	for (Sci::Line line = lineFirst; line < lineLast; line++) {
+		const int yImage = qRound((line - lineFirst) * lineHeight * lineTilesRatio);
+		const int yImageNext = qRound((line + 1 - lineFirst) * lineHeight * lineTilesRatio);
+		QImage imageLine = image.copy(0, yImage, image.width(), yImageNext - yImage);
+		imageLine.setDevicePixelRatio(lineTilesRatio);
+		QSGSimpleTextureNode *node = new QSGSimpleTextureNode();
+		node->setTexture(window()->createTextureFromImage(imageLine));
+		node->setOwnsTexture(true);
+		root->appendChildNode(node);
+		lineTileNodes[line] = node;
+	}
+}
+
+// Remove tiles for display lines from lineFirst up to but not including lineLast.
+void ScintillaEditBase::RemoveLineTiles(QSGNode *root, Sci::Line lineFirst, Sci::Line lineLast)
+{
+	auto it = lineTileNodes.lower_bound(lineFirst);
+	while ((it != lineTileNodes.end()) && (it->first < lineLast)) {
+		root->removeChildNode(it->second);
+		delete it->second;
+		it = lineTileNodes.erase(it);
+	}
 }
 
 #else
@@ -1479,6 +1608,24 @@ void ScintillaEditBase::setReadonly(bool value)
     }
 }
 
+bool ScintillaEditBase::getLineTiles() const
+{
+	return sqt->lineTiles;
+}
+
+void ScintillaEditBase::setLineTiles(bool value)
+{
+	if (value != sqt->lineTiles) {
+		sqt->lineTiles = value;
+		sqt->lineTilesInvalidAll = true;
+		sqt->lineTilesInvalid.clear();
+		// Repaint everything through the newly chosen path
+		update();
+
+		emit lineTilesChanged();
+	}
+}
+
 void ScintillaEditBase::UpdateQuickView()
 {
 	int lineCount = send(SCI_GETLINECOUNT);
@@ -19,10 +19,12 @@
 
 #include <string_view>
 #include <vector>
+#include <map>
 #include <optional>
 #include <memory>
 
 #include "Debugging.h"
+#include "Position.h"
 #include "Geometry.h"
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -34,6 +36,7 @@
 #include <QFont>
 #include <QTimer>
 #include <QQuickPaintedItem>
+class QSGSimpleTextureNode;
 #else
 #include <QAbstractScrollArea>
 #endif
@@ -94,6 +97,7 @@ class EXPORT_IMPORT_API ScintillaEditBase : public
 	Q_PROPERTY(int firstVisibleLine READ getFirstVisibleLine WRITE setFirstVisisbleLine NOTIFY firstVisibleLineChanged)
 	Q_PROPERTY(int firstVisibleColumn READ getFirstVisibleColumn NOTIFY firstVisibleColumnChanged)
 	Q_PROPERTY(Qt::InputMethodHints inputMethodHints READ inputMethodHints WRITE setInputMethodHints NOTIFY inputMethodHintsChanged)
+	Q_PROPERTY(bool lineTiles READ getLineTiles WRITE setLineTiles NOTIFY lineTilesChanged)
 	//QML_ELEMENT
 #endif
 
@@ -200,6 +204,7 @@ signals:
 	void visibleLinesChanged();
 	void visibleColumnsChanged();
 	void inputMethodHintsChanged();
+	void lineTilesChanged();
 	void enableScrollViewInteraction(bool value);
 	void showContextMenu(const QPoint & pos);
 	void addToContextMenu(int menuId, const QString & txt, bool enabled);
@@ -211,6 +216,7 @@ protected:
 	bool event(QEvent *event) override;
 #ifdef PLAT_QT_QML
 	void paint(QPainter *painter) override;
+	QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
 #else
 	void paintEvent(QPaintEvent *event) override;
 #endif
@@ -271,6 +277,12 @@ private:
 	void setInputMethodHints(Qt::InputMethodHints hints);
 	bool getReadonly() const;
 	void setReadonly(bool value);
+	bool getLineTiles() const;
+	void setLineTiles(bool value);
+
+	QSGNode *UpdateLineTiles(QSGNode *oldNode);
+	void RenderLineTiles(QSGNode *root, Sci::Line lineFirst, Sci::Line lineLast);
+	void RemoveLineTiles(QSGNode *root, Sci::Line lineFirst, Sci::Line lineLast);
 
     void cursorChangedUpdateMarker();
 
@@ -288,6 +300,15 @@ private:
 	Qt::InputMethodHints dataInputMethodHints;
     //QTimer aLongTouchTimer;
     qint64 aLastTouchPressTime;
+
+	// Scene graph state only used during updatePaintNode.
+	// When lineTiles is set, each visible display line is a texture node that is kept
+	// while the line is visible and not invalidated so scrolling only renders new lines.
+	QSGNode *painterNode;
+	std::map<Sci::Line, QSGSimpleTextureNode *> lineTileNodes;
+	QSize lineTilesSize;
+	qreal lineTilesRatio;
+	int lineTilesHeight;
 #endif
 
 	Scintilla::Internal::ScintillaQt *sqt;
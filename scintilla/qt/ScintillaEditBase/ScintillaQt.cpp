@@ -19,6 +19,7 @@
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #include <QInputContext>
 #endif
+#include <QImage>
 #include <QMimeData>
 #include <QMenu>
 #include <QTextCodec>
@@ -37,11 +38,15 @@ ScintillaQt::ScintillaQt(QAbstractScrollArea *parent)
  haveMouseCapture(false), dragWasDropped(false),
  rectangularSelectionModifier(SCMOD_ALT)
 #ifdef PLAT_QT_QML
- , currentPainter(nullptr)
+ , currentPainter(nullptr), lineTiles(false), lineTilesInvalidAll(true)
 #endif
 {
 #ifdef PLAT_QT_QML
 	wMain = scrollArea; // == parent
+	// Line tiles are painted on images so start at an image's resolution
+	const QImage imageDefault(1, 1, QImage::Format_ARGB32_Premultiplied);
+	paintDpiX = imageDefault.logicalDpiX();
+	paintDpiY = imageDefault.logicalDpiY();
 #else
 	wMain = scrollArea->viewport();
 #endif
@@ -330,9 +335,73 @@ void ScintillaQt::ScrollText(Sci::Line linesToMove)
 	scrollArea->viewport()->scroll(0, dy);
 #else
 	Q_UNUSED(linesToMove);
+	if (lineTiles) {
+		// Line tiles are placed by display line so existing tiles are moved in the next frame
+		scrollArea->update();
+	} else {
+		// The painted item can not move its image so repaint the whole view
+		Redraw();
+	}
 #endif
 }
 
+#ifdef PLAT_QT_QML
+
+void ScintillaQt::RedrawRect(PRectangle rc)
+{
+	ScintillaBase::RedrawRect(rc);
+	if (lineTiles && (vs.lineHeight > 0)) {
+		const PRectangle rcClient = GetClientRectangle();
+		const XYPOSITION top = std::max(rc.top, rcClient.top) - rcClient.top;
+		const XYPOSITION bottom = std::min(rc.bottom, rcClient.bottom) - rcClient.top;
+		if (bottom > top) {
+			InvalidateLineTiles(
+				topLine + static_cast<Sci::Line>(std::floor(top / vs.lineHeight)),
+				topLine + static_cast<Sci::Line>(std::ceil(bottom / vs.lineHeight)));
+		}
+	}
+}
+
+// Without a margin window, Editor::RedrawSelMargin invalidates the main window directly.
+void ScintillaQt::RedrawSelMargin(Sci::Line line, bool allAfter)
+{
+	ScintillaBase::RedrawSelMargin(line, allAfter);
+	if (lineTiles && (vs.lineHeight > 0)) {
+		if (line == -1) {
+			InvalidateLineTiles(0, pcs->LinesDisplayed());
+		} else {
+			// Markers taller than a line are drawn over the lines around their own
+			const int around = (vs.largestMarkerHeight > vs.lineHeight) ?
+				((vs.largestMarkerHeight - vs.lineHeight + 1) / 2 + vs.lineHeight - 1) / vs.lineHeight : 0;
+			const Sci::Line lineDisplay = pcs->DisplayFromDoc(line);
+			InvalidateLineTiles(std::max<Sci::Line>(lineDisplay - around, 0),
+				allAfter ? pcs->LinesDisplayed() : lineDisplay + 1 + around);
+		}
+	}
+}
+
+void ScintillaQt::InvalidateLineTiles(Sci::Line lineFirst, Sci::Line lineLast)
+{
+	if (lineTilesInvalidAll) {
+		return;
+	}
+	lineTilesInvalid.emplace_back(lineFirst, lineLast);
+	// Many separate ranges before the next frame are unlikely to save work
+	if (lineTilesInvalid.size() > 1000) {
+		lineTilesInvalidAll = true;
+		lineTilesInvalid.clear();
+	}
+}
+
+void ScintillaQt::Redraw()
+{
+	ScintillaBase::Redraw();
+	lineTilesInvalidAll = true;
+	lineTilesInvalid.clear();
+}
+
+#endif
+
 void ScintillaQt::SetVerticalScrollPos()
 {
 #ifndef PLAT_QT_QML
@@ -534,7 +603,7 @@ void ScintillaQt::FineTickerStart(TickReason reason, int millis, int /* toleranc
 // called during destruction.
 void ScintillaQt::CancelTimers()
 {
-	for (size_t tr = static_cast<size_t>(TickReason::caret); tr <= static_cast<size_t>(TickReason::dwell); tr++) {
+	for (size_t tr = static_cast<size_t>(TickReason::caret); tr <= static_cast<size_t>(TickReason::style); tr++) {
 		if (timers[tr]) {
 			killTimer(timers[tr]);
 			timers[tr] = 0;
@@ -916,6 +985,9 @@ void ScintillaQt::PartialPaintQml(const PRectangle & rect, QPainter *painter)
 {
 #ifdef PLAT_QT_QML
 	currentPainter = painter;
+	if (painter) {
+		SetPaintResolution(painter->device());
+	}
 #endif
 	rcPaint = rect;
     paintState = PaintState::painting;
@@ -940,7 +1012,12 @@ void ScintillaQt::PartialPaintQml(const PRectangle & rect, QPainter *painter)
 
 		// Queue a full repaint.
 #ifdef PLAT_QT_QML
-		scrollArea->update();
+		// Line tiles painted before the paint was abandoned may be out of date. The GUI
+		// thread is blocked while tiles are rendered so the flags can be set here.
+		lineTilesInvalidAll = true;
+		lineTilesInvalid.clear();
+		// paint may be called on the render thread so post the update to the item's thread.
+		QMetaObject::invokeMethod(scrollArea, "update", Qt::QueuedConnection);
 #else
 		scrollArea->viewport()->update();
 #endif
@@ -952,6 +1029,32 @@ void ScintillaQt::PartialPaintQml(const PRectangle & rect, QPainter *painter)
 #endif
 }
 	
+#ifdef PLAT_QT_QML
+std::unique_ptr<Surface> ScintillaQt::CreateMeasurementSurface(PainterID pid, int technology_) const
+{
+	std::unique_ptr<Surface> surf = ScintillaBase::CreateMeasurementSurface(pid, technology_);
+	if (surf && !pid) {
+		static_cast<SurfaceImpl *>(surf.get())->SetMeasuringResolution(paintDpiX, paintDpiY);
+	}
+	return surf;
+}
+
+void ScintillaQt::SetPaintResolution(const QPaintDevice *device)
+{
+	if (!device) {
+		return;
+	}
+	const int dpiX = device->logicalDpiX();
+	const int dpiY = device->logicalDpiY();
+	if ((dpiX != paintDpiX) || (dpiY != paintDpiY)) {
+		paintDpiX = dpiX;
+		paintDpiY = dpiY;
+		// Layouts and positions cached at the old resolution are no longer valid
+		InvalidateStyleData();
+	}
+}
+#endif
+
 void ScintillaQt::DragEnter(const Point &point)
 {
 	SetDragPosition(SPositionFromLocation(point,
@@ -991,7 +1094,7 @@ void ScintillaQt::DropUrls(const QMimeData *data)
 
 void ScintillaQt::timerEvent(QTimerEvent *event)
 {
-	for (size_t tr=static_cast<size_t>(TickReason::caret); tr<=static_cast<size_t>(TickReason::dwell); tr++) {
+	for (size_t tr=static_cast<size_t>(TickReason::caret); tr<=static_cast<size_t>(TickReason::style); tr++) {
 		if (timers[tr] == event->timerId()) {
 			TickFor(static_cast<TickReason>(tr));
 		}
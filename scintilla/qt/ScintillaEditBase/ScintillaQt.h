@@ -129,6 +129,14 @@ private:
 
 private:
 	void ScrollText(Sci::Line linesToMove) override;
+#ifdef PLAT_QT_QML
+	void RedrawRect(PRectangle rc) override;
+	void Redraw() override;
+	void RedrawSelMargin(Sci::Line line=-1, bool allAfter=false) override;
+	void InvalidateLineTiles(Sci::Line lineFirst, Sci::Line lineLast);
+	std::unique_ptr<Surface> CreateMeasurementSurface(PainterID pid=nullptr, int technology_=-1) const override;
+	void SetPaintResolution(const QPaintDevice *device);
+#endif
 	void SetVerticalScrollPos() override;
 	void SetHorizontalScrollPos() override;
 	bool ModifyScrollBars(Sci::Line nMax, Sci::Line nPage) override;
@@ -143,7 +151,7 @@ private:
 	void NotifyFocus(bool focus) override;
 	void NotifyParent(Scintilla::NotificationData scn) override;
 	void NotifyURIDropped(const char *uri);
-	int timers[static_cast<size_t>(TickReason::dwell)+1]{};
+	int timers[static_cast<size_t>(TickReason::style)+1]{};
 	bool FineTickerRunning(TickReason reason) override;
 	void FineTickerStart(TickReason reason, int millis, int tolerance) override;
 	void CancelTimers();
@@ -204,6 +212,16 @@ private:
 
 #ifdef PLAT_QT_QML
 	QPainter *currentPainter;  // temporary variable for paint() handling
+
+	// Display lines invalidated since ScintillaEditBase last rendered its line tiles
+	bool lineTiles;
+	bool lineTilesInvalidAll;
+	std::vector<std::pair<Sci::Line, Sci::Line>> lineTilesInvalid;
+
+	// Resolution of the devices painted on, used by surfaces that measure without a painter
+	// so their positions and widths match those measured while painting
+	int paintDpiX;
+	int paintDpiY;
 #endif
 
 	friend class ::ScintillaEditBase;
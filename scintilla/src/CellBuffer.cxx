@@ -19,6 +19,8 @@
 #include <optional>
 #include <algorithm>
 #include <memory>
+#include <thread>
+#include <future>
 
 #include "ScintillaTypes.h"
 
@@ -92,6 +94,144 @@ public:
 using namespace Scintilla;
 using namespace Scintilla::Internal;
 
+namespace {
+
+// Insertions at least this long find their line ends on multiple threads
+constexpr ptrdiff_t lineEndsParallelLength = 4 * 1024 * 1024;
+// Each thread should scan at least this many bytes
+constexpr ptrdiff_t lineEndsBytesPerThread = 1024 * 1024;
+
+constexpr uint64_t RepeatByte(unsigned char b) noexcept {
+	return 0x0101010101010101ULL * b;
+}
+
+constexpr bool HasZeroByte(uint64_t v) noexcept {
+	return ((v - RepeatByte(1)) & ~v & RepeatByte(0x80)) != 0;
+}
+
+// Checks 8 bytes at once for any byte that may be part of a line end.
+// With Unicode line ends, any non-ASCII byte may be part of a line end.
+bool BlockWithoutLineEnd(const char *p, bool unicodeLineEnds) noexcept {
+	uint64_t v = 0;
+	memcpy(&v, p, sizeof(v));
+	if (unicodeLineEnds && (v & RepeatByte(0x80))) {
+		return false;
+	}
+	return !HasZeroByte(v ^ RepeatByte('\n')) && !HasZeroByte(v ^ RepeatByte('\r'));
+}
+
+// Scan [ptr, end) for line ends, calling addLine with a pointer just after each line end.
+// A '\r' just before end may be followed by '\n' at end so *end must be readable.
+// Returns the pointer after the last byte examined which may be end+1 when that '\n' is consumed.
+template <typename AddLine>
+const char *ScanLineEnds(const char *ptr, const char *end, bool unicodeLineEnds,
+	unsigned char &chBeforePrev, unsigned char &chPrev, AddLine addLine) {
+	uint8_t eolTable[256]{};
+	eolTable[static_cast<uint8_t>('\n')] = 1;
+	eolTable[static_cast<uint8_t>('\r')] = 2;
+	if (unicodeLineEnds) {
+		// see UniConversion.h for LS, PS and NEL
+		eolTable[0x85] = 4;
+		eolTable[0xa8] = 3;
+		eolTable[0xa9] = 3;
+	}
+
+	do {
+		// skip to line end
+		unsigned char ch = 0;
+		uint8_t type = 0;
+		while (true) {
+			if (((end - ptr) > 8) && BlockWithoutLineEnd(ptr, unicodeLineEnds)) {
+				chBeforePrev = ptr[6];
+				chPrev = ptr[7];
+				ptr += 8;
+				continue;
+			}
+			ch = *ptr++;
+			type = eolTable[ch];
+			if (type != 0 || ptr >= end) {
+				break;
+			}
+			chBeforePrev = chPrev;
+			chPrev = ch;
+		}
+		switch (type) {
+		case 2: // '\r'
+			if (*ptr == '\n') {
+				++ptr;
+			}
+			[[fallthrough]];
+		case 1: // '\n'
+			addLine(ptr);
+			break;
+		case 3:
+		case 4:
+			// LS, PS and NEL
+			if ((type == 3 && chPrev == 0x80 && chBeforePrev == 0xe2) || (type == 4 && chPrev == 0xc2)) {
+				addLine(ptr);
+			}
+			break;
+		default:
+			break;
+		}
+
+		chBeforePrev = chPrev;
+		chPrev = ch;
+	} while (ptr < end);
+	return ptr;
+}
+
+struct LineEndsChunk {
+	std::vector<Sci::Position> positions;
+	const char *stop = nullptr;
+	unsigned char chBeforePrev = 0;
+	unsigned char chPrev = 0;
+};
+
+// Split [ptr, end) into chunks and scan each on its own thread.
+// Chunk boundaries never separate a '\r' from a following '\n' and each chunk starts with the
+// preceding 2 bytes as context so the result matches a single sequential scan.
+std::vector<LineEndsChunk> ScanLineEndsParallel(const char *ptr, const char *end, const char *s,
+	Sci::Position position, bool unicodeLineEnds, unsigned char chBeforePrev, unsigned char chPrev) {
+	const ptrdiff_t length = end - ptr;
+	const size_t threads = std::clamp<size_t>(length / lineEndsBytesPerThread, 1,
+		std::max(std::thread::hardware_concurrency(), 1U));
+	std::vector<const char *> starts;
+	for (size_t th = 0; th < threads; th++) {
+		const char *start = ptr + static_cast<ptrdiff_t>(length * th / threads);
+		if ((th > 0) && (start[-1] == '\r') && (start[0] == '\n')) {
+			start++;
+		}
+		starts.push_back(start);
+	}
+	starts.push_back(end);
+
+	std::vector<LineEndsChunk> chunks(threads);
+	std::vector<std::future<void>> futures;
+	for (size_t th = 0; th < threads; th++) {
+		LineEndsChunk &chunk = chunks[th];
+		const char *start = starts[th];
+		const char *stop = starts[th + 1];
+		chunk.chBeforePrev = (th == 0) ? chBeforePrev : start[-2];
+		chunk.chPrev = (th == 0) ? chPrev : start[-1];
+		// The first chunk is scanned on this thread
+		const std::launch policy = (th > 0) ? std::launch::async : std::launch::deferred;
+		futures.push_back(std::async(policy, [&chunk, start, stop, s, position, unicodeLineEnds]() {
+			chunk.positions.reserve((stop - start) / 32);
+			chunk.stop = ScanLineEnds(start, stop, unicodeLineEnds, chunk.chBeforePrev, chunk.chPrev,
+				[&chunk, s, position](const char *lineEnd) {
+					chunk.positions.push_back(position + lineEnd - s);
+				});
+		}));
+	}
+	for (std::future<void> &f : futures) {
+		f.get();
+	}
+	return chunks;
+}
+
+}
+
 template <typename POS>
 class LineStartIndex {
 	// line_cast(): cast Sci::Line to either 32-bit or 64-bit value
@@ -335,18 +475,16 @@ public:
 Action::Action() noexcept {
 	at = ActionType::start;
 	position = 0;
+	data = nullptr;
 	lenData = 0;
+	arenaEnd = 0;
 	mayCoalesce = false;
 }
 
 void Action::Create(ActionType at_, Sci::Position position_, const char *data_, Sci::Position lenData_, bool mayCoalesce_) {
-	data = nullptr;
 	position = position_;
 	at = at_;
-	if (lenData_) {
-		data = std::make_unique<char[]>(lenData_);
-		memcpy(&data[0], data_, lenData_);
-	}
+	data = data_;
 	lenData = lenData_;
 	mayCoalesce = mayCoalesce_;
 }
@@ -356,6 +494,88 @@ void Action::Clear() noexcept {
 	lenData = 0;
 }
 
+const char *UndoArena::Push(const char *data, size_t length) {
+	if (length == 0) {
+		return nullptr;
+	}
+	if (blocks.empty() || (blocks[current].size - blocks[current].used < length)) {
+		// Start a new block, reusing the following block if it is large enough
+		const size_t start = End();
+		if (!blocks.empty()) {
+			current++;
+		}
+		if ((current >= blocks.size()) || (blocks[current].size < length)) {
+			Block block;
+			block.size = std::max(blockSize, length);
+			block.text = std::make_unique<char[]>(block.size);
+			if (current < blocks.size()) {
+				blocks[current] = std::move(block);
+			} else {
+				blocks.push_back(std::move(block));
+			}
+		}
+		blocks[current].start = start;
+		blocks[current].used = 0;
+	}
+	Block &block = blocks[current];
+	char *text = block.text.get() + block.used;
+	memcpy(text, data, length);
+	block.used += length;
+	return text;
+}
+
+void UndoArena::Truncate(size_t position) noexcept {
+	if (blocks.empty()) {
+		return;
+	}
+	while ((current > 0) && (blocks[current].start > position)) {
+		blocks[current].used = 0;
+		current--;
+	}
+	if (position < End()) {
+		blocks[current].used = position - blocks[current].start;
+	}
+	// Keep just one empty block for reuse
+	if (blocks.size() > current + 2) {
+		blocks.resize(current + 2);
+	}
+}
+
+void UndoArena::DropBefore(size_t position) noexcept {
+	size_t drop = 0;
+	while ((drop < current) && (blocks[drop].start + blocks[drop].used <= position)) {
+		drop++;
+	}
+	blocks.erase(blocks.begin(), blocks.begin() + drop);
+	current -= drop;
+	begin = position;
+}
+
+void UndoArena::Clear() noexcept {
+	blocks.clear();
+	current = 0;
+	begin = 0;
+}
+
+size_t UndoArena::Begin() const noexcept {
+	return begin;
+}
+
+size_t UndoArena::End() const noexcept {
+	if (blocks.empty()) {
+		return begin;
+	}
+	return blocks[current].start + blocks[current].used;
+}
+
+size_t UndoArena::MemoryUsed() const noexcept {
+	size_t used = 0;
+	for (const Block &block : blocks) {
+		used += block.size;
+	}
+	return used;
+}
+
 // The undo history stores a sequence of user operations that represent the user's view of the
 // commands executed on the text.
 // Each user operation contains a sequence of text insertion and text deletion actions.
@@ -373,6 +593,9 @@ void Action::Clear() noexcept {
 // operation. If there is no outstanding BeginUndoAction call then a new operation is started
 // unless it looks as if the new action is caused by the user typing or deleting a stream of text.
 // Sequences that look like typing or deletion are coalesced into a single user operation.
+// The text of actions is held in an UndoArena in the same order as the actions, so replacing
+// the actions after a point also truncates the arena to the end of the text before that point.
+// With a memory limit, the oldest user operations are discarded once the limit is exceeded.
 
 UndoHistory::UndoHistory() {
 
@@ -382,8 +605,10 @@ UndoHistory::UndoHistory() {
 	undoSequenceDepth = 0;
 	savePoint = 0;
 	tentativePoint = -1;
+	memoryLimit = 0;
+	trimThreshold = 0;
 
-	actions[currentAction].Create(ActionType::start);
+	CreateStart(currentAction);
 }
 
 void UndoHistory::EnsureUndoRoom() {
@@ -395,6 +620,66 @@ void UndoHistory::EnsureUndoRoom() {
 	}
 }
 
+size_t UndoHistory::ArenaBefore(int act) const noexcept {
+	return (act > 0) ? actions[act - 1].arenaEnd : arena.Begin();
+}
+
+void UndoHistory::CreateStart(int act) noexcept {
+	actions[act].Create(ActionType::start);
+	actions[act].arenaEnd = ArenaBefore(act);
+}
+
+size_t UndoHistory::Retained() const noexcept {
+	return (maxAction + 1) * sizeof(Action) + (arena.End() - arena.Begin());
+}
+
+void UndoHistory::LimitMemory() {
+	if ((memoryLimit == 0) || TentativeActive()) {
+		return;
+	}
+	const size_t retained = Retained();
+	if (retained <= memoryLimit) {
+		trimThreshold = memoryLimit;
+		return;
+	}
+	if (retained <= trimThreshold) {
+		return;
+	}
+	// Discard whole user operations from the start until within three quarters of the limit
+	// so that trimming, which moves all the actions, is not needed again for a while.
+	// The current operation is always kept.
+	const size_t target = memoryLimit / 4 * 3;
+	int drop = 0;
+	for (int act = 1; act < currentAction; act++) {
+		if (actions[act].at == ActionType::start) {
+			drop = act;
+			if ((maxAction + 1 - act) * sizeof(Action) + (arena.End() - actions[act].arenaEnd) <= target) {
+				break;
+			}
+		}
+	}
+	if (drop > 0) {
+		actions.erase(actions.begin(), actions.begin() + drop);
+		arena.DropBefore(actions[0].arenaEnd);
+		maxAction -= drop;
+		currentAction -= drop;
+		if (savePoint >= drop) {
+			savePoint -= drop;
+		} else if (savePoint >= 0) {
+			// Save point discarded so can no longer be reached
+			savePoint = -1;
+			if (!detach) {
+				detach = 0;
+			}
+		}
+		if (detach) {
+			detach = std::max(*detach - drop, 0);
+		}
+	}
+	// Avoid searching on every action when the history can not be reduced enough
+	trimThreshold = std::max(memoryLimit, Retained() + memoryLimit / 4);
+}
+
 const char *UndoHistory::AppendAction(ActionType at, Sci::Position position, const char *data, Sci::Position lengthData,
 	bool &startSequence, bool mayCoalesce) {
 	EnsureUndoRoom();
@@ -464,12 +749,15 @@ const char *UndoHistory::AppendAction(ActionType at, Sci::Position position, con
 		currentAction++;
 	}
 	startSequence = oldCurrentAction != currentAction;
-	const int actionWithData = currentAction;
-	actions[currentAction].Create(at, position, data, lengthData, mayCoalesce);
+	arena.Truncate(ArenaBefore(currentAction));
+	const char *dataArena = arena.Push(data, lengthData);
+	actions[currentAction].Create(at, position, dataArena, lengthData, mayCoalesce);
+	actions[currentAction].arenaEnd = arena.End();
 	currentAction++;
-	actions[currentAction].Create(ActionType::start);
+	CreateStart(currentAction);
 	maxAction = currentAction;
-	return actions[actionWithData].data.get();
+	LimitMemory();
+	return dataArena;
 }
 
 void UndoHistory::BeginUndoAction() {
@@ -477,7 +765,7 @@ void UndoHistory::BeginUndoAction() {
 	if (undoSequenceDepth == 0) {
 		if (actions[currentAction].at != ActionType::start) {
 			currentAction++;
-			actions[currentAction].Create(ActionType::start);
+			CreateStart(currentAction);
 			maxAction = currentAction;
 		}
 		actions[currentAction].mayCoalesce = false;
@@ -492,7 +780,7 @@ void UndoHistory::EndUndoAction() {
 	if (0 == undoSequenceDepth) {
 		if (actions[currentAction].at != ActionType::start) {
 			currentAction++;
-			actions[currentAction].Create(ActionType::start);
+			CreateStart(currentAction);
 			maxAction = currentAction;
 		}
 		actions[currentAction].mayCoalesce = false;
@@ -506,11 +794,27 @@ void UndoHistory::DropUndoSequence() {
 void UndoHistory::DeleteUndoHistory() {
 	for (int i = 1; i < maxAction; i++)
 		actions[i].Clear();
+	arena.Clear();
 	maxAction = 0;
 	currentAction = 0;
-	actions[currentAction].Create(ActionType::start);
+	CreateStart(currentAction);
 	savePoint = 0;
 	tentativePoint = -1;
+	trimThreshold = memoryLimit;
+}
+
+void UndoHistory::SetMemoryLimit(size_t limit) {
+	memoryLimit = limit;
+	trimThreshold = memoryLimit;
+	LimitMemory();
+}
+
+size_t UndoHistory::MemoryLimit() const noexcept {
+	return memoryLimit;
+}
+
+size_t UndoHistory::MemoryUsed() const noexcept {
+	return actions.capacity() * sizeof(Action) + arena.MemoryUsed();
 }
 
 void UndoHistory::SetSavePoint() noexcept {
@@ -612,8 +916,8 @@ void UndoHistory::CompletedRedoStep() {
 	currentAction++;
 }
 
-CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_) :
-	hasStyles(hasStyles_), largeDocument(largeDocument_) {
+CellBuffer::CellBuffer(bool hasStyles_, bool largeDocument_, bool lazyStyles_) :
+	hasStyles(hasStyles_), largeDocument(largeDocument_), lazyStyles(hasStyles_ && lazyStyles_) {
 	readOnly = false;
 	utf8Substance = false;
 	utf8LineEnds = LineEndType::Default;
@@ -662,14 +966,17 @@ void CellBuffer::GetStyleRange(unsigned char *buffer, Sci::Position position, Sc
 		std::fill(buffer, buffer + lengthRetrieve, static_cast<unsigned char>(0));
 		return;
 	}
-	if ((position + lengthRetrieve) > style.Length()) {
+	if ((position + lengthRetrieve) > substance.Length()) {
 		Platform::DebugPrintf("Bad GetStyleRange %.0f for %.0f of %.0f\n",
 				      static_cast<double>(position),
 				      static_cast<double>(lengthRetrieve),
-				      static_cast<double>(style.Length()));
+				      static_cast<double>(substance.Length()));
 		return;
 	}
-	style.GetRange(reinterpret_cast<char *>(buffer), position, lengthRetrieve);
+	// With lazy styles, any text after the styled range is style 0
+	const Sci::Position lengthStyled = std::clamp<Sci::Position>(style.Length() - position, 0, lengthRetrieve);
+	style.GetRange(reinterpret_cast<char *>(buffer), position, lengthStyled);
+	std::fill(buffer + lengthStyled, buffer + lengthRetrieve, static_cast<unsigned char>(0));
 }
 
 const char *CellBuffer::BufferPointer() {
@@ -680,6 +987,10 @@ const char *CellBuffer::RangePointer(Sci::Position position, Sci::Position range
 	return substance.RangePointer(position, rangeLength);
 }
 
+const char *CellBuffer::ContiguousRangePointer(Sci::Position position, Sci::Position rangeLength) const noexcept {
+	return substance.ContiguousRangePointer(position, rangeLength);
+}
+
 Sci::Position CellBuffer::GapPosition() const noexcept {
 	return substance.GapPosition();
 }
@@ -718,10 +1029,28 @@ const char *CellBuffer::InsertString(Sci::Position position, const char *s, Sci:
 	return data;
 }
 
+bool CellBuffer::EnsureStyleLength(Sci::Position length) noexcept {
+	// Extend lazily allocated styles with style 0 to cover length
+	if (length > style.Length()) {
+		try {
+			style.InsertValue(style.Length(), length - style.Length(), 0);
+		} catch (...) {
+			// Out of memory so leave the text unstyled
+			return false;
+		}
+	}
+	return true;
+}
+
 bool CellBuffer::SetStyleAt(Sci::Position position, char styleValue) noexcept {
 	if (!hasStyles) {
 		return false;
 	}
+	if (lazyStyles && (position >= style.Length())) {
+		if ((styleValue == 0) || (position >= substance.Length()) || !EnsureStyleLength(position + 1)) {
+			return false;
+		}
+	}
 	const char curVal = style.ValueAt(position);
 	if (curVal != styleValue) {
 		style.SetValueAt(position, styleValue);
@@ -735,18 +1064,21 @@ bool CellBuffer::SetStyleFor(Sci::Position position, Sci::Position lengthStyle,
 	if (!hasStyles) {
 		return false;
 	}
-	bool changed = false;
 	PLATFORM_ASSERT(lengthStyle == 0 ||
-		(lengthStyle > 0 && lengthStyle + position <= style.Length()));
-	while (lengthStyle--) {
-		const char curVal = style.ValueAt(position);
-		if (curVal != styleValue) {
-			style.SetValueAt(position, styleValue);
-			changed = true;
+		(lengthStyle > 0 && lengthStyle + position <= substance.Length()));
+	if (lazyStyles && (position + lengthStyle > style.Length())) {
+		if (styleValue == 0) {
+			// Unallocated styles are already 0
+			lengthStyle = std::max<Sci::Position>(style.Length() - position, 0);
+		} else if (!EnsureStyleLength(std::min(position + lengthStyle, substance.Length()))) {
+			return false;
 		}
-		position++;
 	}
-	return changed;
+	lengthStyle = std::min(lengthStyle, style.Length() - position);
+	if ((position < 0) || (lengthStyle <= 0)) {
+		return false;
+	}
+	return style.FillRange(position, styleValue, lengthStyle);
 }
 
 // The char* returned is to an allocation owned by the undo history
@@ -778,7 +1110,7 @@ Sci::Position CellBuffer::Length() const noexcept {
 
 void CellBuffer::Allocate(Sci::Position newSize) {
 	substance.ReAllocate(newSize);
-	if (hasStyles) {
+	if (hasStyles && !lazyStyles) {
 		style.ReAllocate(newSize);
 	}
 }
@@ -880,6 +1212,14 @@ bool CellBuffer::HasStyles() const noexcept {
 	return hasStyles;
 }
 
+bool CellBuffer::HasLazyStyles() const noexcept {
+	return lazyStyles;
+}
+
+Sci::Position CellBuffer::StylesAllocated() const noexcept {
+	return hasStyles ? style.Length() : 0;
+}
+
 void CellBuffer::SetSavePoint() {
 	uh.SetSavePoint();
 	if (changeHistory) {
@@ -1059,7 +1399,7 @@ void CellBuffer::BasicInsertString(Sci::Position position, const char *s, Sci::P
 	}
 
 	substance.InsertFromArray(position, s, 0, insertLength);
-	if (hasStyles) {
+	if (hasStyles && (!lazyStyles || (position < style.Length()))) {
 		style.InsertValue(position, insertLength, 0);
 	}
 
@@ -1095,56 +1435,32 @@ void CellBuffer::BasicInsertString(Sci::Position position, const char *s, Sci::P
 	}
 
 	if (ptr < end) {
-		uint8_t eolTable[256]{};
-		eolTable[static_cast<uint8_t>('\n')] = 1;
-		eolTable[static_cast<uint8_t>('\r')] = 2;
-		if (utf8LineEnds == LineEndType::Unicode) {
-			// see UniConversion.h for LS, PS and NEL
-			eolTable[0x85] = 4;
-			eolTable[0xa8] = 3;
-			eolTable[0xa9] = 3;
-		}
-
-		do {
-			// skip to line end
-			ch = *ptr++;
-			uint8_t type;
-			while ((type = eolTable[ch]) == 0 && ptr < end) {
-				chBeforePrev = chPrev;
-				chPrev = ch;
-				ch = *ptr++;
-			}
-			switch (type) {
-			case 2: // '\r'
-				if (*ptr == '\n') {
-					++ptr;
-				}
-				[[fallthrough]];
-			case 1: // '\n'
-				positions[nPositions++] = position + ptr - s;
-				if (nPositions == PositionBlockSize) {
-					plv->InsertLines(lineInsert, positions, nPositions, atLineStart);
-					lineInsert += nPositions;
-					nPositions = 0;
+		const bool unicodeLineEnds = utf8LineEnds == LineEndType::Unicode;
+		if ((end - ptr) >= lineEndsParallelLength) {
+			// Large insertions such as loading a file find line ends on multiple threads
+			// then add each chunk's line starts as a block.
+			const std::vector<LineEndsChunk> chunks = ScanLineEndsParallel(ptr, end, s, position,
+				unicodeLineEnds, chBeforePrev, chPrev);
+			for (const LineEndsChunk &chunk : chunks) {
+				if (!chunk.positions.empty()) {
+					plv->InsertLines(lineInsert, chunk.positions.data(), chunk.positions.size(), atLineStart);
+					lineInsert += chunk.positions.size();
 				}
-				break;
-			case 3:
-			case 4:
-				// LS, PS and NEL
-				if ((type == 3 && chPrev == 0x80 && chBeforePrev == 0xe2) || (type == 4 && chPrev == 0xc2)) {
-					positions[nPositions++] = position + ptr - s;
+			}
+			ptr = chunks.back().stop;
+			chBeforePrev = chunks.back().chBeforePrev;
+			chPrev = chunks.back().chPrev;
+		} else {
+			ptr = ScanLineEnds(ptr, end, unicodeLineEnds, chBeforePrev, chPrev,
+				[&](const char *lineEnd) {
+					positions[nPositions++] = position + lineEnd - s;
 					if (nPositions == PositionBlockSize) {
 						plv->InsertLines(lineInsert, positions, nPositions, atLineStart);
 						lineInsert += nPositions;
 						nPositions = 0;
 					}
-				}
-				break;
-			}
-
-			chBeforePrev = chPrev;
-			chPrev = ch;
-		} while (ptr < end);
+				});
+		}
 	}
 
 	if (nPositions != 0) {
@@ -1299,7 +1615,14 @@ void CellBuffer::BasicDeleteChars(Sci::Position position, Sci::Position deleteLe
 		RecalculateIndexLineStarts(lineRecalculateStart, lineRecalculateStart);
 	}
 	if (hasStyles) {
-		style.DeleteRange(position, deleteLength);
+		if (lazyStyles) {
+			const Sci::Position lengthStyled = std::clamp<Sci::Position>(style.Length() - position, 0, deleteLength);
+			if (lengthStyled > 0) {
+				style.DeleteRange(position, lengthStyled);
+			}
+		} else {
+			style.DeleteRange(position, deleteLength);
+		}
 	}
 }
 
@@ -1330,6 +1653,18 @@ void CellBuffer::DeleteUndoHistory() {
 	uh.DeleteUndoHistory();
 }
 
+void CellBuffer::SetUndoMemoryLimit(size_t limit) {
+	uh.SetMemoryLimit(limit);
+}
+
+size_t CellBuffer::UndoMemoryLimit() const noexcept {
+	return uh.MemoryLimit();
+}
+
+size_t CellBuffer::UndoMemoryUsed() const noexcept {
+	return uh.MemoryUsed();
+}
+
 bool CellBuffer::CanUndo() const noexcept {
 	return uh.CanUndo();
 }
@@ -1358,7 +1693,7 @@ void CellBuffer::PerformUndoStep() {
 		}
 		BasicDeleteChars(actionStep.position, actionStep.lenData);
 	} else if (actionStep.at == ActionType::remove) {
-		BasicInsertString(actionStep.position, actionStep.data.get(), actionStep.lenData);
+		BasicInsertString(actionStep.position, actionStep.data, actionStep.lenData);
 		if (changeHistory) {
 			changeHistory->UndoDeleteStep(actionStep.position, actionStep.lenData, uh.AfterDetachPoint());
 		}
@@ -1381,7 +1716,7 @@ const Action &CellBuffer::GetRedoStep() const {
 void CellBuffer::PerformRedoStep() {
 	const Action &actionStep = uh.GetRedoStep();
 	if (actionStep.at == ActionType::insert) {
-		BasicInsertString(actionStep.position, actionStep.data.get(), actionStep.lenData);
+		BasicInsertString(actionStep.position, actionStep.data, actionStep.lenData);
 		if (changeHistory) {
 			changeHistory->Insert(actionStep.position, actionStep.lenData, collectingUndo,
 				uh.BeforeSavePoint() && !uh.AfterDetachPoint());
@@ -35,8 +35,9 @@ class Action {
 public:
 	ActionType at;
 	Sci::Position position;
-	std::unique_ptr<char[]> data;
+	const char *data;	// Owned by the UndoArena of the UndoHistory
 	Sci::Position lenData;
+	size_t arenaEnd;	// Arena position after this action's data
 	bool mayCoalesce;
 
 	Action() noexcept;
@@ -44,19 +45,52 @@ public:
 	void Clear() noexcept;
 };
 
+/**
+ * Holds the text of actions as a stack in large blocks so each action does not need an allocation.
+ * Positions increase from when the arena was cleared so that blocks can be freed from the front
+ * when old actions are discarded. Blocks never move so text pointers stay valid until discarded.
+ */
+class UndoArena {
+	struct Block {
+		std::unique_ptr<char[]> text;
+		size_t start = 0;
+		size_t size = 0;
+		size_t used = 0;
+	};
+	std::vector<Block> blocks;	// Blocks after current are kept empty for reuse
+	size_t current = 0;
+	size_t begin = 0;
+public:
+	static constexpr size_t blockSize = 0x10000;
+	const char *Push(const char *data, size_t length);
+	void Truncate(size_t position) noexcept;
+	void DropBefore(size_t position) noexcept;
+	void Clear() noexcept;
+	size_t Begin() const noexcept;
+	size_t End() const noexcept;
+	size_t MemoryUsed() const noexcept;
+};
+
 /**
  *
  */
 class UndoHistory {
 	std::vector<Action> actions;
+	UndoArena arena;
 	int maxAction;
 	int currentAction;
 	int undoSequenceDepth;
 	int savePoint;
 	int tentativePoint;
 	std::optional<int> detach;
+	size_t memoryLimit;
+	size_t trimThreshold;
 
 	void EnsureUndoRoom();
+	size_t ArenaBefore(int act) const noexcept;
+	void CreateStart(int act) noexcept;
+	size_t Retained() const noexcept;
+	void LimitMemory();
 
 public:
 	UndoHistory();
@@ -68,6 +102,12 @@ public:
 	void DropUndoSequence();
 	void DeleteUndoHistory();
 
+	/// When the limit is not 0, the oldest user operations are discarded so that
+	/// the actions and their text take up less than limit bytes.
+	void SetMemoryLimit(size_t limit);
+	size_t MemoryLimit() const noexcept;
+	size_t MemoryUsed() const noexcept;
+
 	/// The save point is a marker in the undo stack where the container has stated that
 	/// the buffer was saved. Undo and redo can move over the save point.
 	void SetSavePoint() noexcept;
@@ -130,6 +170,9 @@ class CellBuffer {
 private:
 	bool hasStyles;
 	bool largeDocument;
+	/// When lazyStyles is set, style only covers the text that has been styled and
+	/// all text after style.Length() is treated as style 0.
+	bool lazyStyles;
 	SplitVector<char> substance;
 	SplitVector<char> style;
 	bool readOnly;
@@ -148,13 +191,14 @@ private:
 	void ResetLineEnds();
 	void RecalculateIndexLineStarts(Sci::Line lineFirst, Sci::Line lineLast);
 	bool MaintainingLineCharacterIndex() const noexcept;
+	bool EnsureStyleLength(Sci::Position length) noexcept;
 	/// Actions without undo
 	void BasicInsertString(Sci::Position position, const char *s, Sci::Position insertLength);
 	void BasicDeleteChars(Sci::Position position, Sci::Position deleteLength);
 
 public:
 
-	CellBuffer(bool hasStyles_, bool largeDocument_);
+	CellBuffer(bool hasStyles_, bool largeDocument_, bool lazyStyles_=false);
 	// Deleted so CellBuffer objects can not be copied.
 	CellBuffer(const CellBuffer &) = delete;
 	CellBuffer(CellBuffer &&) = delete;
@@ -170,6 +214,7 @@ public:
 	void GetStyleRange(unsigned char *buffer, Sci::Position position, Sci::Position lengthRetrieve) const;
 	const char *BufferPointer();
 	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept;
+	const char *ContiguousRangePointer(Sci::Position position, Sci::Position rangeLength) const noexcept;
 	Sci::Position GapPosition() const noexcept;
 	SplitView AllView() const noexcept;
 
@@ -204,6 +249,8 @@ public:
 	void SetReadOnly(bool set) noexcept;
 	bool IsLarge() const noexcept;
 	bool HasStyles() const noexcept;
+	bool HasLazyStyles() const noexcept;
+	Sci::Position StylesAllocated() const noexcept;
 
 	/// The save point is a marker in the undo stack where the container has stated that
 	/// the buffer was saved. Undo and redo can move over the save point.
@@ -221,6 +268,9 @@ public:
 	void EndUndoAction();
 	void AddUndoAction(Sci::Position token, bool mayCoalesce);
 	void DeleteUndoHistory();
+	void SetUndoMemoryLimit(size_t limit);
+	size_t UndoMemoryLimit() const noexcept;
+	size_t UndoMemoryUsed() const noexcept;
 
 	/// To perform an undo, StartUndo is called to retrieve the number of steps, then UndoStep is
 	/// called that many times. Similarly for redo.
@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <climits>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -21,6 +22,9 @@
 #include <algorithm>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #ifndef NO_CXX11_REGEX
 #include <regex>
@@ -51,17 +55,839 @@
 using namespace Scintilla;
 using namespace Scintilla::Internal;
 
+namespace {
+
+class LiteralSearcher;
+
+/**
+ * The changes made by one call to a lexer's Lex and Fold methods on a LexSnapshot.
+ * Applied to the real document on the main thread.
+ */
+struct LexChunk {
+	struct DecorationFill {
+		int indicator;
+		Sci::Position position;
+		int value;
+		Sci::Position fillLength;
+	};
+	size_t number = 0;
+	Sci::Position start = 0;
+	Sci::Position end = 0;
+	Sci::Position styleStart = 0;
+	std::string styles;
+	std::vector<std::pair<Sci::Line, int>> levels;
+	std::vector<std::pair<Sci::Line, int>> lineStates;
+	std::vector<DecorationFill> decorations;
+	std::vector<std::pair<Sci::Position, Sci::Position>> lexerStates;
+	std::optional<int> errorStatus;
+
+	void Apply(Document *pdoc) const {
+		if (!styles.empty()) {
+			pdoc->StartStyling(styleStart);
+			pdoc->SetStyles(styles.length(), styles.data());
+		}
+		for (const auto &[line, level] : levels) {
+			pdoc->SetLevel(line, level);
+		}
+		for (const auto &[line, state] : lineStates) {
+			pdoc->SetLineState(line, state);
+		}
+		for (const DecorationFill &fill : decorations) {
+			pdoc->DecorationSetCurrentIndicator(fill.indicator);
+			pdoc->DecorationFillRange(fill.position, fill.value, fill.fillLength);
+		}
+		for (const auto &[startState, endState] : lexerStates) {
+			pdoc->ChangeLexerState(startState, endState);
+		}
+		if (errorStatus) {
+			pdoc->SetErrorStatus(*errorStatus);
+		}
+	}
+};
+
+/**
+ * A run of whole lines copied from a document with the styles, fold levels and line states
+ * that lexers read. Blocks are shared by the BlockCache and LexSnapshots and are not modified
+ * once shared, so a LexSnapshot copies a block before writing to it.
+ */
+struct SnapshotBlock {
+	std::string text;
+	std::string styles;
+	std::vector<Sci::Position> lineStarts;	///< Relative to the start of the block
+	std::vector<int> levels;
+	std::vector<int> lineStates;
+};
+
+using SharedBlock = std::shared_ptr<const SnapshotBlock>;
+
+// Blocks are split at the first line start after this many bytes.
+constexpr Sci::Position snapshotBlockSize = 0x10000;
+
+}
+
+namespace Scintilla::Internal {
+
+/**
+ * The blocks of a document kept between background lexing passes and searches. Modifications
+ * mark the blocks they touch and only marked blocks are copied from the document when the next
+ * pass or search starts, so a pass after typing a character copies a block or two instead of
+ * the whole document.
+ */
+class BlockCache {
+	std::vector<SharedBlock> blocks;
+	std::vector<bool> dirty;
+	std::vector<Sci::Position> starts;	///< One more than blocks, ending with the document length
+	bool publishing = false;
+
+	size_t BlockFromPosition(Sci::Position position) const noexcept {
+		const auto it = std::upper_bound(starts.begin(), starts.end() - 1, position);
+		return std::max<ptrdiff_t>(it - starts.begin() - 1, 0);
+	}
+
+	static bool IsLineStart(const Document *pdoc, Sci::Position position) {
+		return (position >= pdoc->Length()) || pdoc->IsLineStartPosition(position);
+	}
+
+	static SharedBlock CopyBlock(const Document *pdoc, Sci::Position start, Sci::Position end) {
+		std::shared_ptr<SnapshotBlock> block = std::make_shared<SnapshotBlock>();
+		block->text.resize(end - start);
+		pdoc->GetCharRange(block->text.data(), start, end - start);
+		block->styles.resize(end - start);
+		pdoc->GetStyleRange(reinterpret_cast<unsigned char *>(block->styles.data()), start, end - start);
+		// The last block also holds the line after a final line end
+		const Sci::Line lineFirst = pdoc->SciLineFromPosition(start);
+		const Sci::Line lineEnd = (end >= pdoc->Length()) ? pdoc->LinesTotal() : pdoc->SciLineFromPosition(end);
+		const Sci::Line maxLineState = pdoc->GetMaxLineState();
+		for (Sci::Line line = lineFirst; line < lineEnd; line++) {
+			block->lineStarts.push_back(pdoc->LineStart(line) - start);
+			block->levels.push_back(pdoc->GetLevel(line));
+			block->lineStates.push_back((line < maxLineState) ? pdoc->GetLineState(line) : 0);
+		}
+		return block;
+	}
+
+	static void CopyBlocks(const Document *pdoc, Sci::Position start, Sci::Position end,
+		std::vector<SharedBlock> &blocksNew, std::vector<Sci::Position> &startsNew) {
+		const Sci::Position length = pdoc->Length();
+		Sci::Position position = start;
+		do {
+			Sci::Position blockEnd = end;
+			if (end - position > snapshotBlockSize) {
+				const Sci::Line lineAfter = pdoc->SciLineFromPosition(position + snapshotBlockSize) + 1;
+				blockEnd = std::min<Sci::Position>(pdoc->LineStart(lineAfter), end);
+			}
+			// Only an empty document or a document ending with a line end has an empty block
+			if ((blockEnd > position) || (end == length)) {
+				startsNew.push_back(position);
+				blocksNew.push_back(CopyBlock(pdoc, position, blockEnd));
+			}
+			position = blockEnd;
+		} while (position < end);
+	}
+
+	bool Matches(const Document *pdoc) const noexcept {
+		Sci::Line lines = 0;
+		for (size_t block = 0; block < blocks.size(); block++) {
+			if (static_cast<Sci::Position>(blocks[block]->text.length()) != starts[block + 1] - starts[block])
+				return false;
+			lines += blocks[block]->lineStarts.size();
+		}
+		return (starts.back() == pdoc->Length()) && (lines == pdoc->LinesTotal());
+	}
+
+public:
+	void Clear() noexcept {
+		blocks.clear();
+		dirty.clear();
+		starts.clear();
+	}
+
+	void Mark(Sci::Position first, Sci::Position last) noexcept {
+		if (blocks.empty())
+			return;
+		const size_t blockLast = BlockFromPosition(last);
+		for (size_t block = BlockFromPosition(first); block <= blockLast; block++) {
+			dirty[block] = true;
+		}
+	}
+
+	void Inserted(Sci::Position position, Sci::Position length) noexcept {
+		if (blocks.empty())
+			return;
+		// Text inserted at the start of a block may join the last line of the previous block
+		Mark(position - 1, position);
+		for (size_t block = 1; block < blocks.size(); block++) {
+			if (starts[block] > position)
+				starts[block] += length;
+		}
+		starts.back() += length;
+	}
+
+	void Deleted(Sci::Position position, Sci::Position length) noexcept {
+		if (blocks.empty())
+			return;
+		Mark(position - 1, position + length);
+		for (size_t block = 1; block < starts.size(); block++) {
+			if (starts[block] > position)
+				starts[block] = std::max(starts[block] - length, position);
+		}
+	}
+
+	// Keep the cache in step with the document. Changes made while a lexing pass publishes are
+	// already in the pass's blocks which are returned to the cache when the pass ends.
+	void Modified(const DocModification &mh) noexcept {
+		if (FlagSet(mh.modificationType, ModificationFlags::InsertText)) {
+			Inserted(mh.position, mh.length);
+		} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
+			Deleted(mh.position, mh.length);
+		} else if (!publishing) {
+			if (FlagSet(mh.modificationType, ModificationFlags::ChangeStyle) && (mh.length > 0)) {
+				Mark(mh.position, mh.position + mh.length - 1);
+			} else if (FlagSet(mh.modificationType, ModificationFlags::ChangeFold | ModificationFlags::ChangeLineState)) {
+				Mark(mh.position, mh.position);
+			}
+		}
+	}
+
+	void SetPublishing(bool publishing_) noexcept {
+		publishing = publishing_;
+	}
+
+	// Replaces the block starting at start with the copy written by a pass when the document has
+	// not changed it since. Searches may have refreshed the cache during the pass so blocks are
+	// found by position.
+	void Adopt(Sci::Position start, const SharedBlock &original, SharedBlock written) noexcept {
+		if (blocks.empty())
+			return;
+		const size_t block = BlockFromPosition(start);
+		if ((starts[block] == start) && !dirty[block] && (blocks[block] == original))
+			blocks[block] = std::move(written);
+	}
+
+	// Copy the marked blocks from the document and return all the blocks.
+	const std::vector<SharedBlock> &Refresh(const Document *pdoc) {
+		if (blocks.empty() || (starts.back() != pdoc->Length())) {
+			blocks.assign(1, nullptr);
+			dirty.assign(1, true);
+			starts = {0, pdoc->Length()};
+		}
+		std::vector<SharedBlock> blocksNew;
+		std::vector<Sci::Position> startsNew;
+		size_t block = 0;
+		while (block < blocks.size()) {
+			if (!dirty[block]) {
+				blocksNew.push_back(blocks[block]);
+				startsNew.push_back(starts[block]);
+				block++;
+				continue;
+			}
+			// Modifications may move a line end over the edge of a block so widen the
+			// run of marked blocks until it starts and ends at line starts.
+			Sci::Position start = starts[block];
+			while (!IsLineStart(pdoc, start)) {
+				blocksNew.pop_back();
+				start = startsNew.back();
+				startsNew.pop_back();
+			}
+			size_t blockEnd = block + 1;
+			while ((blockEnd < blocks.size()) && (dirty[blockEnd] || !IsLineStart(pdoc, starts[blockEnd]))) {
+				blockEnd++;
+			}
+			CopyBlocks(pdoc, start, starts[blockEnd], blocksNew, startsNew);
+			block = blockEnd;
+		}
+		startsNew.push_back(pdoc->Length());
+		blocks = std::move(blocksNew);
+		starts = std::move(startsNew);
+		dirty.assign(blocks.size(), false);
+		if (!Matches(pdoc)) {
+			// Should not happen but recover by copying everything
+			PLATFORM_ASSERT(false);
+			Clear();
+			return Refresh(pdoc);
+		}
+		return blocks;
+	}
+};
+
+}
+
+namespace {
+
+/**
+ * A view of a document made from shared blocks along with the styles, fold levels and line
+ * states that lexers read. Since it does not refer back to the document, a lexer can run over
+ * it on a worker thread. Only single byte and UTF-8 documents are supported.
+ */
+class LexSnapshot : public IDocument5 {
+	struct WrittenBlock {
+		std::shared_ptr<SnapshotBlock> block;
+		size_t firstChunk = 0;
+		size_t lastChunk = 0;
+	};
+	std::vector<SharedBlock> blocks;
+	std::vector<WrittenBlock> written;	///< Blocks copied before writing
+	std::vector<Sci::Position> starts;	///< One more than blocks
+	std::vector<Sci::Line> lineFirsts;	///< One more than blocks
+	Sci::Position length;
+	Sci::Line lines;
+	int codePage;
+	int tabInChars;
+	bool unicodeLineEnds;
+	std::string contiguous;	///< Only filled when a lexer asks for the whole text
+	Sci::Position endStyled = 0;
+	Sci::Position styledMin = 0;
+	Sci::Position styledMax = 0;
+	int currentIndicator = 0;
+	size_t chunkNumber = 0;
+	LexChunk chunk;
+
+	// Not cached as lexers may call const methods from several threads at once
+	size_t BlockFromPosition(Sci::Position position) const noexcept {
+		const auto it = std::upper_bound(starts.begin(), starts.end() - 1, position);
+		return std::max<ptrdiff_t>(it - starts.begin() - 1, 0);
+	}
+	size_t BlockFromLine(Sci::Line line) const noexcept {
+		const auto it = std::upper_bound(lineFirsts.begin(), lineFirsts.end() - 1, line);
+		return std::max<ptrdiff_t>(it - lineFirsts.begin() - 1, 0);
+	}
+	const SnapshotBlock &Block(size_t block) const noexcept {
+		return written[block].block ? *written[block].block : *blocks[block];
+	}
+	SnapshotBlock &Writable(size_t block) {
+		WrittenBlock &copy = written[block];
+		if (!copy.block) {
+			copy.block = std::make_shared<SnapshotBlock>(*blocks[block]);
+			copy.firstChunk = chunkNumber;
+		}
+		copy.lastChunk = chunkNumber;
+		return *copy.block;
+	}
+	void CopyStyles(char *buffer, Sci::Position position, Sci::Position lengthRetrieve) const noexcept {
+		while (lengthRetrieve > 0) {
+			const size_t block = BlockFromPosition(position);
+			const Sci::Position offset = position - starts[block];
+			const Sci::Position lengthBlock = std::min(lengthRetrieve, starts[block + 1] - position);
+			memcpy(buffer, Block(block).styles.data() + offset, lengthBlock);
+			buffer += lengthBlock;
+			position += lengthBlock;
+			lengthRetrieve -= lengthBlock;
+		}
+	}
+
+	Sci::Position LengthNoExcept() const noexcept {
+		return length;
+	}
+	unsigned char UCharAt(Sci::Position position) const noexcept {
+		if ((position < 0) || (position >= LengthNoExcept()))
+			return 0;
+		const size_t block = BlockFromPosition(position);
+		return Block(block).text[position - starts[block]];
+	}
+	void Styled(Sci::Position position, Sci::Position lengthStyled) noexcept {
+		styledMin = std::min(styledMin, position);
+		styledMax = std::max(styledMax, position + lengthStyled);
+	}
+	bool InGoodUTF8(Sci::Position pos, Sci::Position &start) const noexcept {
+		Sci::Position trail = pos;
+		while ((trail > 0) && (pos - trail < UTF8MaxBytes) && UTF8IsTrailByte(UCharAt(trail - 1)))
+			trail--;
+		start = (trail > 0) ? trail - 1 : trail;
+		const unsigned char leadByte = UCharAt(start);
+		const int widthCharBytes = UTF8BytesOfLead[leadByte];
+		if ((widthCharBytes == 1) || (pos - start > widthCharBytes - 1))
+			return false;
+		unsigned char charBytes[UTF8MaxBytes] = {leadByte, 0, 0, 0};
+		for (int b = 1; b < widthCharBytes; b++)
+			charBytes[b] = UCharAt(start + b);
+		return !(UTF8Classify(charBytes, widthCharBytes) & UTF8MaskInvalid);
+	}
+	Sci::Position NextPosition(Sci::Position pos, int increment) const noexcept {
+		// Same results as Document::NextPosition for single byte and UTF-8
+		if (pos + increment <= 0)
+			return 0;
+		if (pos + increment >= LengthNoExcept())
+			return LengthNoExcept();
+		if (codePage != CpUtf8)
+			return pos + increment;
+		if (increment == 1) {
+			Sci::Position width = 1;
+			GetCharacterAndWidth(pos, &width);
+			return pos + width;
+		}
+		pos--;
+		Sci::Position startUTF = pos;
+		if (UTF8IsTrailByte(UCharAt(pos)) && InGoodUTF8(pos, startUTF)) {
+			pos = startUTF;
+		}
+		return pos;
+	}
+
+public:
+	LexSnapshot(const std::vector<SharedBlock> &blocks_, const Document *pdoc) :
+		blocks(blocks_),
+		written(blocks_.size()),
+		length(pdoc->Length()),
+		lines(pdoc->LinesTotal()),
+		codePage(pdoc->dbcsCodePage),
+		tabInChars(pdoc->tabInChars),
+		unicodeLineEnds(pdoc->GetLineEndTypesActive() == LineEndType::Unicode) {
+		Sci::Position position = 0;
+		Sci::Line line = 0;
+		for (const SharedBlock &block : blocks) {
+			starts.push_back(position);
+			lineFirsts.push_back(line);
+			position += block->text.length();
+			line += block->lineStarts.size();
+		}
+		starts.push_back(position);
+		lineFirsts.push_back(line);
+	}
+
+	LexChunk Lex(ILexer5 *lexer, Sci::Position start, Sci::Position end) {
+		chunk = LexChunk();
+		chunk.number = ++chunkNumber;
+		chunk.start = start;
+		chunk.end = end;
+		styledMin = LengthNoExcept();
+		styledMax = 0;
+		const int styleStart = (start > 0) ? StyleAt(start - 1) : 0;
+		lexer->Lex(start, end - start, styleStart, this);
+		lexer->Fold(start, end - start, styleStart, this);
+		if (styledMax > styledMin) {
+			chunk.styleStart = styledMin;
+			chunk.styles.resize(styledMax - styledMin);
+			CopyStyles(chunk.styles.data(), styledMin, styledMax - styledMin);
+		}
+		return std::move(chunk);
+	}
+
+	// Hands the blocks written by published chunks back to the cache. Blocks that were
+	// partly published no longer match either the cache or the document so are marked.
+	void ReturnBlocks(BlockCache &cache, size_t chunkPublished) const noexcept {
+		for (size_t block = 0; block < written.size(); block++) {
+			const WrittenBlock &copy = written[block];
+			if (copy.block) {
+				if (copy.lastChunk <= chunkPublished) {
+					cache.Adopt(starts[block], blocks[block], copy.block);
+				} else if (copy.firstChunk <= chunkPublished) {
+					cache.Mark(starts[block], std::max(starts[block + 1] - 1, starts[block]));
+				}
+			}
+		}
+	}
+
+	int SCI_METHOD Version() const override {
+		return Scintilla::dvRelease5;
+	}
+	void SCI_METHOD SetErrorStatus(int status) override {
+		chunk.errorStatus = status;
+	}
+	Sci_Position SCI_METHOD Length() const override {
+		return LengthNoExcept();
+	}
+	void SCI_METHOD GetCharRange(char *buffer, Sci_Position position, Sci_Position lengthRetrieve) const override {
+		if ((position < 0) || (lengthRetrieve <= 0) || (position + lengthRetrieve > LengthNoExcept()))
+			return;
+		while (lengthRetrieve > 0) {
+			const size_t block = BlockFromPosition(position);
+			const Sci::Position offset = position - starts[block];
+			const Sci::Position lengthBlock = std::min<Sci::Position>(lengthRetrieve, starts[block + 1] - position);
+			memcpy(buffer, Block(block).text.data() + offset, lengthBlock);
+			buffer += lengthBlock;
+			position += lengthBlock;
+			lengthRetrieve -= lengthBlock;
+		}
+	}
+	char SCI_METHOD StyleAt(Sci_Position position) const override {
+		if ((position < 0) || (position >= LengthNoExcept()))
+			return 0;
+		const size_t block = BlockFromPosition(position);
+		return Block(block).styles[position - starts[block]];
+	}
+	Sci_Position SCI_METHOD LineFromPosition(Sci_Position position) const override {
+		if (position >= LengthNoExcept())
+			return std::max<Sci::Line>(lines - 1, 0);
+		if (position <= 0)
+			return 0;
+		const size_t block = BlockFromPosition(position);
+		const std::vector<Sci::Position> &lineStarts = Block(block).lineStarts;
+		const auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), position - starts[block]);
+		return lineFirsts[block] + std::max<Sci::Line>(it - lineStarts.begin() - 1, 0);
+	}
+	Sci_Position SCI_METHOD LineStart(Sci_Position line) const override {
+		if (line <= 0)
+			return 0;
+		if (line >= lines)
+			return LengthNoExcept();
+		const size_t block = BlockFromLine(line);
+		return starts[block] + Block(block).lineStarts[line - lineFirsts[block]];
+	}
+	int SCI_METHOD GetLevel(Sci_Position line) const override {
+		if ((line < 0) || (line >= lines))
+			return static_cast<int>(FoldLevel::Base);
+		const size_t block = BlockFromLine(line);
+		return Block(block).levels[line - lineFirsts[block]];
+	}
+	int SCI_METHOD SetLevel(Sci_Position line, int level) override {
+		if ((line < 0) || (line >= lines))
+			return level;
+		const size_t block = BlockFromLine(line);
+		const int prev = Block(block).levels[line - lineFirsts[block]];
+		if (prev != level) {
+			Writable(block).levels[line - lineFirsts[block]] = level;
+			chunk.levels.emplace_back(line, level);
+		}
+		return prev;
+	}
+	int SCI_METHOD GetLineState(Sci_Position line) const override {
+		if ((line < 0) || (line >= lines))
+			return 0;
+		const size_t block = BlockFromLine(line);
+		return Block(block).lineStates[line - lineFirsts[block]];
+	}
+	int SCI_METHOD SetLineState(Sci_Position line, int state) override {
+		if ((line < 0) || (line >= lines))
+			return state;
+		const size_t block = BlockFromLine(line);
+		const int prev = Block(block).lineStates[line - lineFirsts[block]];
+		if (prev != state) {
+			Writable(block).lineStates[line - lineFirsts[block]] = state;
+			chunk.lineStates.emplace_back(line, state);
+		}
+		return prev;
+	}
+	void SCI_METHOD StartStyling(Sci_Position position) override {
+		endStyled = position;
+	}
+	bool SCI_METHOD SetStyleFor(Sci_Position lengthStyle, char style) override {
+		if ((endStyled < 0) || (lengthStyle < 0) || (endStyled + lengthStyle > LengthNoExcept()))
+			return false;
+		Styled(endStyled, lengthStyle);
+		while (lengthStyle > 0) {
+			const size_t block = BlockFromPosition(endStyled);
+			const Sci::Position offset = endStyled - starts[block];
+			const Sci::Position lengthBlock = std::min<Sci::Position>(lengthStyle, starts[block + 1] - endStyled);
+			std::fill_n(Writable(block).styles.begin() + offset, lengthBlock, style);
+			endStyled += lengthBlock;
+			lengthStyle -= lengthBlock;
+		}
+		return true;
+	}
+	bool SCI_METHOD SetStyles(Sci_Position lengthStyles, const char *stylesSet) override {
+		if ((endStyled < 0) || (lengthStyles < 0) || (endStyled + lengthStyles > LengthNoExcept()))
+			return false;
+		Styled(endStyled, lengthStyles);
+		while (lengthStyles > 0) {
+			const size_t block = BlockFromPosition(endStyled);
+			const Sci::Position offset = endStyled - starts[block];
+			const Sci::Position lengthBlock = std::min<Sci::Position>(lengthStyles, starts[block + 1] - endStyled);
+			std::copy(stylesSet, stylesSet + lengthBlock, Writable(block).styles.begin() + offset);
+			stylesSet += lengthBlock;
+			endStyled += lengthBlock;
+			lengthStyles -= lengthBlock;
+		}
+		return true;
+	}
+	bool SCI_METHOD SetStyleRuns(Sci_Position runs, const Sci_Position *lengths, const char *stylesSet) override {
+		for (Sci_Position run = 0; run < runs; run++) {
+			if (!SetStyleFor(lengths[run], stylesSet[run]))
+				return false;
+		}
+		return true;
+	}
+	void SCI_METHOD DecorationSetCurrentIndicator(int indicator) override {
+		currentIndicator = indicator;
+	}
+	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override {
+		chunk.decorations.push_back({currentIndicator, position, value, fillLength});
+	}
+	void SCI_METHOD ChangeLexerState(Sci_Position start, Sci_Position end) override {
+		chunk.lexerStates.emplace_back(start, end);
+	}
+	int SCI_METHOD CodePage() const override {
+		return codePage;
+	}
+	bool SCI_METHOD IsDBCSLeadByte(char) const override {
+		return false;
+	}
+	const char *SCI_METHOD BufferPointer() override {
+		// The text is in blocks so is only joined for the rare lexer that needs it all at once
+		if (static_cast<Sci::Position>(contiguous.length()) != LengthNoExcept()) {
+			contiguous.resize(LengthNoExcept());
+			GetCharRange(contiguous.data(), 0, LengthNoExcept());
+		}
+		return contiguous.c_str();
+	}
+	const char *SCI_METHOD ContiguousRangePointer(Sci_Position position, Sci_Position rangeLength) const override {
+		if ((position < 0) || (rangeLength < 0) || (position + rangeLength > LengthNoExcept()))
+			return nullptr;
+		// Like the gap in a document, a range over the end of a block is not contiguous
+		const size_t block = BlockFromPosition(position);
+		if (position + rangeLength > starts[block + 1])
+			return nullptr;
+		return Block(block).text.data() + (position - starts[block]);
+	}
+	int SCI_METHOD GetLineIndentation(Sci_Position line) override {
+		int indent = 0;
+		if ((line >= 0) && (line < lines)) {
+			for (Sci::Position i = LineStart(line); i < LengthNoExcept(); i++) {
+				const char ch = UCharAt(i);
+				if (ch == ' ')
+					indent++;
+				else if (ch == '\t')
+					indent = ((indent / tabInChars) + 1) * tabInChars;
+				else
+					return indent;
+			}
+		}
+		return indent;
+	}
+	Sci_Position SCI_METHOD LineEnd(Sci_Position line) const override {
+		if (line >= lines - 1)
+			return LineStart(line + 1);
+		Sci::Position position = LineStart(line + 1);
+		if (unicodeLineEnds) {
+			const unsigned char bytes[] = {
+				UCharAt(position-3),
+				UCharAt(position-2),
+				UCharAt(position-1),
+			};
+			if (UTF8IsSeparator(bytes)) {
+				return position - UTF8SeparatorLength;
+			}
+			if (UTF8IsNEL(bytes+1)) {
+				return position - UTF8NELLength;
+			}
+		}
+		position--; // Back over CR or LF
+		if ((position > LineStart(line)) && (UCharAt(position - 1) == '\r')) {
+			position--;
+		}
+		return position;
+	}
+	Sci_Position SCI_METHOD GetRelativePosition(Sci_Position positionStart, Sci_Position characterOffset) const override {
+		Sci::Position pos = positionStart;
+		const int increment = (characterOffset > 0) ? 1 : -1;
+		while (characterOffset != 0) {
+			const Sci::Position posNext = NextPosition(pos, increment);
+			if (posNext == pos)
+				return Sci::invalidPosition;
+			pos = posNext;
+			characterOffset -= increment;
+		}
+		return pos;
+	}
+	int SCI_METHOD GetCharacterAndWidth(Sci_Position position, Sci_Position *pWidth) const override {
+		int bytesInCharacter = 1;
+		const unsigned char leadByte = UCharAt(position);
+		int character = leadByte;
+		if ((codePage == CpUtf8) && !UTF8IsAscii(leadByte)) {
+			const int widthCharBytes = UTF8BytesOfLead[leadByte];
+			unsigned char charBytes[UTF8MaxBytes] = {leadByte,0,0,0};
+			for (int b=1; b<widthCharBytes; b++)
+				charBytes[b] = UCharAt(position+b);
+			const int utf8status = UTF8Classify(charBytes, widthCharBytes);
+			if (utf8status & UTF8MaskInvalid) {
+				// Report as singleton surrogate values which are invalid Unicode
+				character =  0xDC80 + leadByte;
+			} else {
+				bytesInCharacter = utf8status & UTF8MaskWidth;
+				character = UnicodeFromUTF8(charBytes);
+			}
+		}
+		if (pWidth) {
+			*pWidth = bytesInCharacter;
+		}
+		return character;
+	}
+};
+
+}
+
+namespace Scintilla::Internal {
+
+/**
+ * Runs a lexer over a LexSnapshot on a worker thread one chunk of lines at a time.
+ * The main thread publishes finished chunks to the document. Modifying the document
+ * stops the pass and discards chunks not yet published. The blocks of the snapshot
+ * are kept in a BlockCache between passes.
+ */
+class BackgroundLexer {
+	BlockCache &cache;
+	std::unique_ptr<LexSnapshot> snapshot;
+	std::thread worker;
+	std::atomic<bool> cancelled = false;
+	std::mutex mutex;
+	// Protected by mutex
+	std::vector<LexChunk> chunks;
+	bool finished = false;
+	Sci::Position failedAt = Sci::invalidPosition;
+	// Only used on the main thread
+	size_t chunkPublished = 0;
+
+	void Lex(ILexer5 *lexer, Sci::Position start, Sci::Position end, size_t chunkLength) noexcept {
+		Sci::Position pos = start;
+		try {
+			while ((pos < end) && !cancelled) {
+				const Sci::Line lineChunkEnd = snapshot->LineFromPosition(pos + static_cast<Sci::Position>(chunkLength));
+				const Sci::Position chunkEnd = std::min<Sci::Position>(snapshot->LineStart(lineChunkEnd + 1), end);
+				LexChunk chunk = snapshot->Lex(lexer, pos, chunkEnd);
+				std::lock_guard<std::mutex> guard(mutex);
+				chunks.push_back(std::move(chunk));
+				pos = chunkEnd;
+			}
+		} catch (...) {
+			// Leave the failing range to be styled on the main thread
+			std::lock_guard<std::mutex> guard(mutex);
+			failedAt = pos;
+		}
+		std::lock_guard<std::mutex> guard(mutex);
+		finished = true;
+	}
+
+	void Join() noexcept {
+		if (worker.joinable()) {
+			cancelled = true;
+			try {
+				worker.join();
+			} catch (const std::system_error &) {
+				// Only fails if deadlocked or already joined
+			}
+		}
+		if (snapshot) {
+			snapshot->ReturnBlocks(cache, chunkPublished);
+			snapshot.reset();
+		}
+		chunks.clear();
+	}
+
+public:
+	explicit BackgroundLexer(BlockCache &cache_) noexcept : cache(cache_) {
+	}
+	// Deleted so BackgroundLexer objects can not be copied.
+	BackgroundLexer(const BackgroundLexer &) = delete;
+	BackgroundLexer(BackgroundLexer &&) = delete;
+	BackgroundLexer &operator=(const BackgroundLexer &) = delete;
+	BackgroundLexer &operator=(BackgroundLexer &&) = delete;
+	~BackgroundLexer() {
+		Join();
+	}
+
+	bool Running() const noexcept {
+		return worker.joinable();
+	}
+
+	bool Start(const Document *pdoc, ILexer5 *lexer, Sci::Position start, Sci::Position end, size_t chunkLength) {
+		if ((start == failedAt) || (pdoc->dbcsCodePage && (pdoc->dbcsCodePage != CpUtf8)))
+			return false;
+		snapshot = std::make_unique<LexSnapshot>(cache.Refresh(pdoc), pdoc);
+		cancelled = false;
+		finished = false;
+		chunkPublished = 0;
+		try {
+			worker = std::thread(&BackgroundLexer::Lex, this, lexer, start, end, chunkLength);
+		} catch (const std::system_error &) {
+			snapshot.reset();
+			return false;
+		}
+		return true;
+	}
+
+	// Apply the chunks finished so far to the document without waiting for more.
+	void Publish(Document *pdoc) {
+		std::vector<LexChunk> ready;
+		bool done = false;
+		{
+			std::lock_guard<std::mutex> guard(mutex);
+			ready.swap(chunks);
+			done = finished;
+		}
+		for (const LexChunk &chunk : ready) {
+			// Notifications may have stopped the pass or restyled the document
+			if (!Running() || (pdoc->GetEndStyled() < chunk.start)) {
+				Stop();
+				return;
+			}
+			// Counted before applying as a notification may stop the pass part way through
+			chunkPublished = chunk.number;
+			cache.SetPublishing(true);
+			chunk.Apply(pdoc);
+			cache.SetPublishing(false);
+		}
+		if (done) {
+			Join();
+		}
+	}
+
+	void Stop() noexcept {
+		Join();
+		failedAt = Sci::invalidPosition;
+	}
+};
+
+/**
+ * Finds all the matches of literal text in a range of a document on a worker thread. The text is
+ * read from the shared blocks of the BlockCache so the document is not copied and matching is
+ * performed by the LiteralSearcher used by Document::FindText. Word options depend on the
+ * document so they are checked on the main thread as matches are taken.
+ */
+class BackgroundSearch {
+	int id;
+	std::vector<SharedBlock> blocks;
+	std::vector<Sci::Position> starts;	///< One more than blocks
+	std::string search;
+	std::unique_ptr<CaseFolder> pcf;
+	std::unique_ptr<LiteralSearcher> searcher;
+	bool word;
+	bool wordStart;
+	std::thread worker;
+	std::atomic<bool> cancelled = false;
+	std::mutex mutex;
+	// Protected by mutex
+	std::vector<std::pair<Sci::Position, Sci::Position>> found;
+	bool finished = false;
+	// Only used on the main thread
+	std::vector<std::pair<Sci::Position, Sci::Position>> taken;
+	size_t next = 0;
+	Sci::Position endAccepted = 0;
+
+	void Search(Sci::Position minPos, Sci::Position maxPos) noexcept;
+
+public:
+	BackgroundSearch(int id_, const std::vector<SharedBlock> &blocks_, std::unique_ptr<CaseFolder> pcf_,
+		std::string_view search_, FindOption flags, int codePage);
+	// Deleted so BackgroundSearch objects can not be copied.
+	BackgroundSearch(const BackgroundSearch &) = delete;
+	BackgroundSearch(BackgroundSearch &&) = delete;
+	BackgroundSearch &operator=(const BackgroundSearch &) = delete;
+	BackgroundSearch &operator=(BackgroundSearch &&) = delete;
+	~BackgroundSearch();
+
+	int Id() const noexcept {
+		return id;
+	}
+	void Start(Sci::Position minPos, Sci::Position maxPos);
+	Sci::Position Next(const Document *pdoc, Sci::Position *length);
+};
+
+}
+
 LexInterface::LexInterface(Document *pdoc_) noexcept : pdoc(pdoc_), performingStyle(false) {
 }
 
 LexInterface::~LexInterface() noexcept = default;
 
 void LexInterface::SetInstance(ILexer5 *instance_) noexcept {
+	StopBackground();
 	instance.reset(instance_);
 }
 
 void LexInterface::Colourise(Sci::Position start, Sci::Position end) {
 	if (pdoc && instance && !performingStyle) {
+		// The lexer can only be used by one thread at a time
+		StopBackground();
+
 		// Protect against reentrance, which may occur, for example, when
 		// fold points are discovered while performing styling and the folding
 		// code looks for child lines which may trigger styling.
@@ -88,6 +914,29 @@ void LexInterface::Colourise(Sci::Position start, Sci::Position end) {
 	}
 }
 
+// Start or continue lexing on a worker thread and publish any results that are ready.
+// Returns false when a worker can not be used so the caller should style directly.
+bool LexInterface::ColouriseInBackground(Sci::Position start, Sci::Position end, size_t chunkLength) {
+	if (!pdoc || !instance || performingStyle)
+		return false;
+	if (!background) {
+		background = std::make_unique<BackgroundLexer>(pdoc->SnapshotCache());
+	}
+	if (!background->Running() && !background->Start(pdoc, instance.get(), start, end, chunkLength))
+		return false;
+	// Notifications sent while publishing may try to style synchronously
+	performingStyle = true;
+	background->Publish(pdoc);
+	performingStyle = false;
+	return true;
+}
+
+void LexInterface::StopBackground() noexcept {
+	if (background) {
+		background->Stop();
+	}
+}
+
 LineEndType LexInterface::LineEndTypesSupported() {
 	if (instance) {
 		return static_cast<LineEndType>(instance->LineEndTypesSupported());
@@ -138,7 +987,8 @@ CharacterExtracted::CharacterExtracted(const unsigned char *charBytes, size_t wi
 }
 
 Document::Document(DocumentOption options) :
-	cb(!FlagSet(options, DocumentOption::StylesNone), FlagSet(options, DocumentOption::TextLarge)),
+	cb(!FlagSet(options, DocumentOption::StylesNone), FlagSet(options, DocumentOption::TextLarge),
+		FlagSet(options, DocumentOption::StylesLazy)),
 	durationStyleOneByte(0.000001, 0.0000001, 0.00001) {
 	refCount = 0;
 #ifdef _WIN32
@@ -162,6 +1012,7 @@ Document::Document(DocumentOption options) :
 	backspaceUnindents = false;
 
 	matchesValid = false;
+	searchLast = 0;
 
 	perLineData[ldMarkers] = std::make_unique<LineMarkers>();
 	perLineData[ldLevels] = std::make_unique<LineLevels>();
@@ -249,8 +1100,10 @@ LineAnnotation *Document::EOLAnnotations() const noexcept {
 }
 
 LineEndType Document::LineEndTypesSupported() const {
-	if ((CpUtf8 == dbcsCodePage) && pli)
+	if ((CpUtf8 == dbcsCodePage) && pli) {
+		pli->StopBackground();
 		return pli->LineEndTypesSupported();
+	}
 	else
 		return LineEndType::Default;
 }
@@ -262,6 +1115,7 @@ bool Document::SetDBCSCodePage(int dbcsCodePage_) {
 		cb.SetLineEndTypes(lineEndBitSet & LineEndTypesSupported());
 		cb.SetUTF8Substance(CpUtf8 == dbcsCodePage);
 		ModifiedAt(0);	// Need to restyle whole document
+		ClearSnapshot();	// Lines may have changed
 		return true;
 	} else {
 		return false;
@@ -275,6 +1129,7 @@ bool Document::SetLineEndTypesAllowed(LineEndType lineEndBitSet_) {
 		if (lineEndBitSetActive != cb.GetLineEndTypes()) {
 			ModifiedAt(0);
 			cb.SetLineEndTypes(lineEndBitSetActive);
+			ClearSnapshot();
 			return true;
 		} else {
 			return false;
@@ -337,7 +1192,7 @@ void Document::TentativeUndo() {
 						modFlags |= ModificationFlags::MultilineUndoRedo;
 				}
 				NotifyModified(DocModification(modFlags, action.position, action.lenData,
-											   linesAdded, action.data.get()));
+											   linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -564,6 +1419,7 @@ FoldLevel Document::GetFoldLevel(Sci_Position line) const {
 
 void Document::ClearLevels() {
 	Levels()->ClearLevels();
+	ClearSnapshot();
 }
 
 static bool IsSubordinate(FoldLevel levelStart, FoldLevel levelTry) noexcept {
@@ -1232,6 +2088,8 @@ EncodingFamily Document::CodePageFamily() const noexcept {
 void Document::ModifiedAt(Sci::Position pos) noexcept {
 	if (endStyled > pos)
 		endStyled = pos;
+	if (pli)
+		pli->StopBackground();
 }
 
 void Document::CheckReadOnly() {
@@ -1351,6 +2209,52 @@ Sci::Position Document::InsertString(Sci::Position position, std::string_view sv
 	return InsertString(position, sv.data(), sv.length());
 }
 
+/**
+ * Replace a sorted list of non-overlapping ranges as a single user operation.
+ * The ranges are replaced from first to last so the gap and the line index only move forward.
+ * Each range is deleted and inserted with its own notifications so watchers see exactly
+ * which lines changed and positions between ranges are maintained.
+ * Returns the number of ranges replaced, 0 when read-only, or -1 when the ranges are invalid.
+ * When any are replaced, positionEnd is set to the end of the last replaced text.
+ */
+Sci::Position Document::ReplaceRanges(const std::vector<RangeReplacement> &replacements, Sci::Position *positionEnd) {
+	if (replacements.empty()) {
+		return 0;
+	}
+	Sci::Position previousEnd = 0;
+	for (const RangeReplacement &replacement : replacements) {
+		if ((replacement.range.start < previousEnd) || (replacement.range.end < replacement.range.start)) {
+			return -1;
+		}
+		previousEnd = replacement.range.end;
+	}
+	if (previousEnd > LengthNoExcept()) {
+		return -1;
+	}
+	CheckReadOnly();	// Application may change read only state here
+	if (cb.IsReadOnly() || (enteredModification != 0)) {
+		return 0;
+	}
+	const UndoGroup ug(this);
+	Sci::Position replaced = 0;
+	Sci::Position delta = 0;
+	for (const RangeReplacement &replacement : replacements) {
+		const Sci::Position positionReplace = replacement.range.start + delta;
+		const Sci::Position lengthRemoved = replacement.range.end - replacement.range.start;
+		if ((lengthRemoved > 0) && !DeleteChars(positionReplace, lengthRemoved)) {
+			break;
+		}
+		// The inserted length may differ from the text's when an application calls ChangeInsertion
+		const Sci::Position lengthInserted = InsertString(positionReplace, replacement.text);
+		delta += lengthInserted - lengthRemoved;
+		replaced++;
+		if (positionEnd) {
+			*positionEnd = positionReplace + lengthInserted;
+		}
+	}
+	return replaced;
+}
+
 void Document::ChangeInsertion(const char *s, Sci::Position length) {
 	insertionSet = true;
 	insertion.assign(s, length);
@@ -1445,7 +2349,7 @@ Sci::Position Document::Undo() {
 						modFlags |= ModificationFlags::MultilineUndoRedo;
 				}
 				NotifyModified(DocModification(modFlags, action.position, action.lenData,
-											   linesAdded, action.data.get()));
+											   linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -1505,7 +2409,7 @@ Sci::Position Document::Redo() {
 				}
 				NotifyModified(
 					DocModification(modFlags, action.position, action.lenData,
-									linesAdded, action.data.get()));
+									linesAdded, action.data));
 			}
 
 			const bool endSavePoint = cb.IsSavePoint();
@@ -1553,6 +2457,15 @@ static std::string CreateIndentation(Sci::Position indent, int tabSize, bool ins
 	return indentation;
 }
 
+// Lexers use this to read text without copying. Unlike RangePointer, the gap is not moved
+// as that would invalidate earlier pointers, so ranges that span the gap return nullptr.
+const char * SCI_METHOD Document::ContiguousRangePointer(Sci_Position position, Sci_Position rangeLength) const {
+	if ((position < 0) || (rangeLength < 0) || (position + rangeLength > LengthNoExcept()))
+		return nullptr;
+	return cb.ContiguousRangePointer(position, rangeLength);
+}
+
+// Only reads the document so may be called concurrently with const methods, as for chunked lexing
 int SCI_METHOD Document::GetLineIndentation(Sci_Position line) {
 	int indent = 0;
 	if ((line >= 0) && (line < LinesTotal())) {
@@ -1644,6 +2557,16 @@ Sci::Position Document::CountUTF16(Sci::Position startPos, Sci::Position endPos)
 	Sci::Position count = 0;
 	Sci::Position i = startPos;
 	while (i < endPos) {
+		if ((CpUtf8 == dbcsCodePage) && UTF8IsAscii(cb.CharAt(i))) {
+			// Count a run of ASCII, which is one UTF-16 code unit per byte, a block at a time
+			char block[256];
+			const Sci::Position lenBlock = std::min<Sci::Position>(endPos - i, sizeof(block));
+			cb.GetCharRange(block, i, lenBlock);
+			const Sci::Position lenAscii = UTF8AsciiPrefixLength(std::string_view(block, lenBlock));
+			count += lenAscii;
+			i += lenAscii;
+			continue;
+		}
 		count++;
 		const Sci::Position next = NextPosition(i, 1);
 		if ((next - i) > 3)
@@ -1755,7 +2678,8 @@ void Document::ConvertLineEnds(EndOfLine eolModeSet) {
 
 DocumentOption Document::Options() const noexcept {
 	return (IsLarge() ? DocumentOption::TextLarge : DocumentOption::Default) |
-		(cb.HasStyles() ? DocumentOption::Default : DocumentOption::StylesNone);
+		(cb.HasStyles() ? DocumentOption::Default : DocumentOption::StylesNone) |
+		(cb.HasLazyStyles() ? DocumentOption::StylesLazy : DocumentOption::Default);
 }
 
 bool Document::IsWhiteLine(Sci::Line line) const {
@@ -2096,6 +3020,341 @@ bool SplitMatch(const SplitView &view, size_t start, std::string_view text) noex
 	return true;
 }
 
+// Equivalent of skipping forward while the byte is ASCII and can not start a match.
+// Returns the first position in [start, end) that may start a match or end.
+size_t SplitSkipASCII(const SplitView &view, size_t start, size_t end, const bool possibleStart[]) noexcept {
+	size_t pos = start;
+	const size_t end1 = std::min(end, view.length1);
+	while ((pos < end1) && !possibleStart[static_cast<unsigned char>(view.segment1[pos])]) {
+		pos++;
+	}
+	if (pos < end1) {
+		return pos;
+	}
+	while ((pos < end) && !possibleStart[static_cast<unsigned char>(view.segment2[pos])]) {
+		pos++;
+	}
+	return pos;
+}
+
+/**
+ * Boyer-Moore-Horspool search for case-insensitive text in single-byte encodings.
+ * Document bytes are folded through a table built once for each search and the
+ * search works directly on each segment of the split view.
+ */
+class FoldedSearcher {
+	std::string needle;
+	unsigned char fold[UCHAR_MAX + 1] {};
+	size_t shift[UCHAR_MAX + 1] {};
+	bool MatchesAt(const SplitView &view, size_t pos) const noexcept {
+		for (size_t i = 0; i < needle.length(); i++) {
+			if (fold[static_cast<unsigned char>(view.CharAt(pos + i))] != static_cast<unsigned char>(needle[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+	// text contains every window starting in [start, endSearch)
+	ptrdiff_t FindContiguous(const char *text, size_t start, size_t endSearch) const noexcept {
+		const size_t lengthNeedle = needle.length();
+		const unsigned char lastNeedle = needle.back();
+		size_t pos = start;
+		while (pos < endSearch) {
+			const unsigned char last = fold[static_cast<unsigned char>(text[pos + lengthNeedle - 1])];
+			if (last == lastNeedle) {
+				size_t i = 0;
+				while ((i < lengthNeedle - 1) && (fold[static_cast<unsigned char>(text[pos + i])] == static_cast<unsigned char>(needle[i]))) {
+					i++;
+				}
+				if (i == lengthNeedle - 1) {
+					return pos;
+				}
+			}
+			pos += shift[last];
+		}
+		return -1;
+	}
+public:
+	FoldedSearcher(CaseFolder *pcf, const char *search, size_t lengthSearch) : needle(lengthSearch, '\0') {
+		pcf->Fold(needle.data(), needle.length(), search, lengthSearch);
+		for (int i = 0; i <= UCHAR_MAX; i++) {
+			const char ch = static_cast<char>(i);
+			if (UTF8IsAscii(ch)) {
+				fold[i] = MakeLowerCase(ch);
+			} else {
+				char folded[2];
+				pcf->Fold(folded, sizeof(folded), &ch, 1);
+				fold[i] = folded[0];
+			}
+			shift[i] = lengthSearch;
+		}
+		for (size_t i = 0; i + 1 < lengthSearch; i++) {
+			shift[static_cast<unsigned char>(needle[i])] = lengthSearch - 1 - i;
+		}
+	}
+	// Returns the first match starting in [start, endSearch) or -1
+	ptrdiff_t Find(const SplitView &view, size_t start, size_t endSearch) const noexcept {
+		const size_t lengthNeedle = needle.length();
+		// Windows entirely within the first segment
+		const size_t endSearch1 = std::min(endSearch,
+			(view.length1 >= lengthNeedle) ? view.length1 - lengthNeedle + 1 : 0);
+		if (start < endSearch1) {
+			const ptrdiff_t found = FindContiguous(view.segment1, start, endSearch1);
+			if (found >= 0) {
+				return found;
+			}
+			start = endSearch1;
+		}
+		// Windows that include the gap
+		for (; (start < endSearch) && (start < view.length1); start++) {
+			if (MatchesAt(view, start)) {
+				return start;
+			}
+		}
+		// Windows entirely within the second segment
+		if (start < endSearch) {
+			return FindContiguous(view.segment2, start, endSearch);
+		}
+		return -1;
+	}
+};
+
+constexpr size_t maxFoldingExpansion = 4;
+
+// Matches the folded search text against the UTF-8 text at pos, folding each character with pcf.
+// Returns the end of the match or -1. widthFirstCharacter is set to the width of the character at pos.
+Sci::Position MatchFoldedUTF8(const SplitView &view, Sci::Position pos, Sci::Position limitPos, CaseFolder *pcf,
+	const std::vector<char> &searchThing, size_t lenSearch, int &widthFirstCharacter) {
+	Sci::Position posIndexDocument = pos;
+	size_t indexSearch = 0;
+	while (indexSearch < lenSearch) {
+		const unsigned char leadByte = view.CharAt(posIndexDocument);
+		int widthChar = 1;
+		size_t lenFlat = 1;
+		bool characterMatches = true;
+		if (UTF8IsAscii(leadByte)) {
+			if ((posIndexDocument + 1) > limitPos) {
+				return -1;
+			}
+			characterMatches = searchThing[indexSearch] == MakeLowerCase(leadByte);
+		} else {
+			char bytes[UTF8MaxBytes]{ static_cast<char>(leadByte) };
+			const int widthCharBytes = UTF8BytesOfLead[leadByte];
+			for (int b = 1; b < widthCharBytes; b++) {
+				bytes[b] = view.CharAt(posIndexDocument + b);
+			}
+			widthChar = UTF8Classify(reinterpret_cast<const unsigned char *>(bytes), widthCharBytes) & UTF8MaskWidth;
+			if (!indexSearch) {	// First character
+				widthFirstCharacter = widthChar;
+			}
+			if ((posIndexDocument + widthChar) > limitPos) {
+				return -1;
+			}
+			char folded[UTF8MaxBytes * maxFoldingExpansion + 1];
+			lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
+			// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of searchThing
+			assert((indexSearch + lenFlat) <= searchThing.size());
+			// Does folded match the buffer
+			characterMatches = 0 == memcmp(folded, &searchThing[0] + indexSearch, lenFlat);
+		}
+		if (!characterMatches) {
+			return -1;
+		}
+		posIndexDocument += widthChar;
+		indexSearch += lenFlat;
+	}
+	return posIndexDocument;
+}
+
+/**
+ * Literal text prepared for searching forward through single byte or UTF-8 text.
+ * Used by Document::FindText and by BackgroundSearch on a worker thread so both match
+ * in the same way.
+ */
+class LiteralSearcher {
+	std::string_view search;	///< Owned by the caller
+	bool caseSensitive;
+	bool utf8;
+	CaseFolder *pcf;
+	std::optional<FoldedSearcher> searcherFolded;
+	std::vector<char> searchThing;
+	size_t lenSearch = 0;
+	bool possibleStart[UCHAR_MAX + 1];	///< Only set for case-insensitive UTF-8
+public:
+	// UTF-8 search will not be self-synchronizing when case-sensitive and starting with a trail byte
+	static bool Handles(std::string_view search, bool caseSensitive, int codePage) noexcept {
+		return !search.empty() && ((codePage == 0) ||
+			((codePage == CpUtf8) && !(caseSensitive && UTF8IsTrailByte(search[0]))));
+	}
+	LiteralSearcher(std::string_view search_, bool caseSensitive_, int codePage, CaseFolder *pcf_) :
+		search(search_), caseSensitive(caseSensitive_), utf8(codePage == CpUtf8), pcf(pcf_) {
+		if (caseSensitive) {
+			lenSearch = search.length();
+		} else if (utf8) {
+			searchThing.resize((search.length() + 1) * UTF8MaxBytes * maxFoldingExpansion + 1);
+			lenSearch = pcf->Fold(&searchThing[0], searchThing.size(), search.data(), search.length());
+			// ASCII characters fold to ASCII so only ASCII bytes that fold to the start of the
+			// search can start a match. Non-ASCII characters are always checked fully.
+			for (int i = 0; i <= UCHAR_MAX; i++) {
+				possibleStart[i] = !UTF8IsAscii(static_cast<char>(i)) ||
+					(MakeLowerCase(static_cast<char>(i)) == searchThing[0]);
+			}
+		} else {
+			searcherFolded.emplace(pcf, search.data(), search.length());
+			lenSearch = search.length();
+		}
+	}
+	// The longest text that may match
+	Sci::Position MaxMatchLength() const noexcept {
+		return (utf8 && !caseSensitive) ? lenSearch * UTF8MaxBytes : lenSearch;
+	}
+	// Calls accept with the position and length of each match that starts in [pos, endStart)
+	// and ends by limitPos until accept returns true. Returns the accepted position or -1.
+	template <typename Accept>
+	Sci::Position Find(const SplitView view, Sci::Position pos, Sci::Position endStart, Sci::Position limitPos, Accept accept) const {
+		const Sci::Position lengthFind = search.length();
+		if (caseSensitive) {
+			// This is a fast case where there is no need to test byte values to iterate
+			// so becomes the equivalent of a memchr+memcmp loop.
+			const Sci::Position endSearch = std::min(endStart, limitPos - lengthFind + 1);
+			const unsigned char charStartSearch = search[0];
+			const std::string_view suffix(search.data() + 1, lengthFind - 1);
+			while (pos < endSearch) {
+				pos = SplitFindChar(view, pos, endSearch - pos, charStartSearch);
+				if (pos < 0) {
+					break;
+				}
+				if (SplitMatch(view, pos + 1, suffix) && accept(pos, lengthFind)) {
+					return pos;
+				}
+				pos++;
+			}
+		} else if (utf8) {
+			while (pos < endStart) {
+				pos = SplitSkipASCII(view, pos, endStart, possibleStart);
+				if (pos >= endStart) {
+					break;
+				}
+				int widthFirstCharacter = 1;
+				const Sci::Position endMatch = MatchFoldedUTF8(view, pos, limitPos, pcf,
+					searchThing, lenSearch, widthFirstCharacter);
+				if ((endMatch >= 0) && accept(pos, endMatch - pos)) {
+					return pos;
+				}
+				pos += widthFirstCharacter;
+			}
+		} else {
+			const Sci::Position endSearch = std::min(endStart, limitPos - lengthFind + 1);
+			while (pos < endSearch) {
+				pos = searcherFolded->Find(view, pos, endSearch);
+				if (pos < 0) {
+					break;
+				}
+				if (accept(pos, lengthFind)) {
+					return pos;
+				}
+				pos++;
+			}
+		}
+		return -1;
+	}
+};
+
+}
+
+BackgroundSearch::BackgroundSearch(int id_, const std::vector<SharedBlock> &blocks_, std::unique_ptr<CaseFolder> pcf_,
+	std::string_view search_, FindOption flags, int codePage) :
+	id(id_),
+	blocks(blocks_),
+	search(search_),
+	pcf(std::move(pcf_)),
+	word(FlagSet(flags, FindOption::WholeWord)),
+	wordStart(FlagSet(flags, FindOption::WordStart)) {
+	Sci::Position position = 0;
+	for (const SharedBlock &block : blocks) {
+		starts.push_back(position);
+		position += block->text.length();
+	}
+	starts.push_back(position);
+	searcher = std::make_unique<LiteralSearcher>(search, FlagSet(flags, FindOption::MatchCase), codePage, pcf.get());
+}
+
+BackgroundSearch::~BackgroundSearch() {
+	if (worker.joinable()) {
+		cancelled = true;
+		try {
+			worker.join();
+		} catch (const std::system_error &) {
+			// Only fails if deadlocked or already joined
+		}
+	}
+}
+
+void BackgroundSearch::Start(Sci::Position minPos, Sci::Position maxPos) {
+	worker = std::thread(&BackgroundSearch::Search, this, minPos, maxPos);
+}
+
+void BackgroundSearch::Search(Sci::Position minPos, Sci::Position maxPos) noexcept {
+	try {
+		// Each block is searched through a view that continues with enough of the following
+		// blocks to hold any match starting in the block.
+		const Sci::Position lengthTail = searcher->MaxMatchLength() + UTF8MaxBytes;
+		std::string tail;
+		std::vector<std::pair<Sci::Position, Sci::Position>> matches;
+		const auto itFirst = std::upper_bound(starts.begin(), starts.end() - 1, minPos);
+		size_t block = std::max<ptrdiff_t>(itFirst - starts.begin() - 1, 0);
+		for (; (block < blocks.size()) && (starts[block] < maxPos) && !cancelled; block++) {
+			const std::string &text = blocks[block]->text;
+			tail.clear();
+			for (size_t after = block + 1; (after < blocks.size()) && (static_cast<Sci::Position>(tail.length()) < lengthTail); after++) {
+				tail.append(blocks[after]->text, 0, lengthTail - tail.length());
+			}
+			const SplitView view { text.data(), text.length(), tail.data() - text.length(), text.length() + tail.length() };
+			const Sci::Position start = starts[block];
+			searcher->Find(view, std::max<Sci::Position>(minPos - start, 0), std::min(maxPos, starts[block + 1]) - start,
+				std::min<Sci::Position>(maxPos - start, view.length),
+				[&matches, start](Sci::Position position, Sci::Position lengthMatch) {
+				matches.emplace_back(start + position, lengthMatch);
+				return false;
+			});
+			if (!matches.empty()) {
+				std::lock_guard<std::mutex> guard(mutex);
+				found.insert(found.end(), matches.begin(), matches.end());
+				matches.clear();
+			}
+		}
+	} catch (...) {
+		// Out of memory so finish with the matches found so far
+	}
+	std::lock_guard<std::mutex> guard(mutex);
+	finished = true;
+}
+
+// Returns the next match that satisfies the word options and does not overlap the previous
+// match, -1 when no match is ready yet or -2 when all the matches have been taken.
+Sci::Position BackgroundSearch::Next(const Document *pdoc, Sci::Position *length) {
+	while (true) {
+		if (next == taken.size()) {
+			taken.clear();
+			next = 0;
+			bool done = false;
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				taken.swap(found);
+				done = finished;
+			}
+			if (taken.empty()) {
+				return done ? -2 : -1;
+			}
+		}
+		const auto [position, lengthMatch] = taken[next++];
+		// Every match is reported by the worker but FindText continues after each accepted match
+		if ((position >= endAccepted) && pdoc->MatchesWordOptions(word, wordStart, position, lengthMatch)) {
+			endAccepted = position + lengthMatch;
+			*length = lengthMatch;
+			return position;
+		}
+	}
 }
 
 /**
@@ -2135,112 +3394,63 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 			pos = NextPosition(pos, increment);
 		}
 		const SplitView cbView = cb.AllView();
+		if (forward && LiteralSearcher::Handles(std::string_view(search, lengthFind), caseSensitive, dbcsCodePage)) {
+			const LiteralSearcher searcher(std::string_view(search, lengthFind), caseSensitive, dbcsCodePage, pcf.get());
+			return searcher.Find(cbView, pos, endPos, endPos,
+				[this, word, wordStart, length](Sci::Position position, Sci::Position lengthMatch) {
+				if (MatchesWordOptions(word, wordStart, position, lengthMatch)) {
+					*length = lengthMatch;
+					return true;
+				}
+				return false;
+			});
+		}
 		if (caseSensitive) {
 			const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
 			const unsigned char charStartSearch =  search[0];
-			if (forward && ((0 == dbcsCodePage) || (CpUtf8 == dbcsCodePage && !UTF8IsTrailByte(charStartSearch)))) {
-				// This is a fast case where there is no need to test byte values to iterate
-				// so becomes the equivalent of a memchr+memcmp loop.
-				// UTF-8 search will not be self-synchronizing when starts with trail byte
-				const std::string_view suffix(search + 1, lengthFind - 1);
-				while (pos < endSearch) {
-					pos = SplitFindChar(cbView, pos, limitPos - pos, charStartSearch);
-					if (pos < 0) {
-						break;
+			while (forward ? (pos < endSearch) : (pos >= endSearch)) {
+				const unsigned char leadByte = cbView.CharAt(pos);
+				if (leadByte == charStartSearch) {
+					bool found = (pos + lengthFind) <= limitPos;
+					// SplitMatch could be called here but it is slower with g++ -O2
+					for (int indexSearch = 1; (indexSearch < lengthFind) && found; indexSearch++) {
+						found = cbView.CharAt(pos + indexSearch) == search[indexSearch];
 					}
-					if (SplitMatch(cbView, pos + 1, suffix) && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
+					if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
 						return pos;
 					}
-					pos++;
 				}
-			} else {
-				while (forward ? (pos < endSearch) : (pos >= endSearch)) {
-					const unsigned char leadByte = cbView.CharAt(pos);
-					if (leadByte == charStartSearch) {
-						bool found = (pos + lengthFind) <= limitPos;
-						// SplitMatch could be called here but it is slower with g++ -O2
-						for (int indexSearch = 1; (indexSearch < lengthFind) && found; indexSearch++) {
-							found = cbView.CharAt(pos + indexSearch) == search[indexSearch];
-						}
-						if (found && MatchesWordOptions(word, wordStart, pos, lengthFind)) {
-							return pos;
+				if (forward && UTF8IsAscii(leadByte)) {
+					pos++;
+				} else {
+					if (dbcsCodePage) {
+						if (!NextCharacter(pos, increment)) {
+							break;
 						}
-					}
-					if (forward && UTF8IsAscii(leadByte)) {
-						pos++;
 					} else {
-						if (dbcsCodePage) {
-							if (!NextCharacter(pos, increment)) {
-								break;
-							}
-						} else {
-							pos += increment;
-						}
+						pos += increment;
 					}
 				}
 			}
 		} else if (CpUtf8 == dbcsCodePage) {
-			constexpr size_t maxFoldingExpansion = 4;
+			// Forward searches are handled by LiteralSearcher
 			std::vector<char> searchThing((lengthFind+1) * UTF8MaxBytes * maxFoldingExpansion + 1);
 			const size_t lenSearch =
 				pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
-			while (forward ? (pos < endPos) : (pos >= endPos)) {
+			while (pos >= endPos) {
 				int widthFirstCharacter = 1;
-				Sci::Position posIndexDocument = pos;
-				size_t indexSearch = 0;
-				bool characterMatches = true;
-				while (indexSearch < lenSearch) {
-					const unsigned char leadByte = cbView.CharAt(posIndexDocument);
-					int widthChar = 1;
-					size_t lenFlat = 1;
-					if (UTF8IsAscii(leadByte)) {
-						if ((posIndexDocument + 1) > limitPos) {
-							break;
-						}
-						characterMatches = searchThing[indexSearch] == MakeLowerCase(leadByte);
-					} else {
-						char bytes[UTF8MaxBytes]{ static_cast<char>(leadByte) };
-						const int widthCharBytes = UTF8BytesOfLead[leadByte];
-						for (int b = 1; b < widthCharBytes; b++) {
-							bytes[b] = cbView.CharAt(posIndexDocument + b);
-						}
-						widthChar = UTF8Classify(reinterpret_cast<const unsigned char *>(bytes), widthCharBytes) & UTF8MaskWidth;
-						if (!indexSearch) {	// First character
-							widthFirstCharacter = widthChar;
-						}
-						if ((posIndexDocument + widthChar) > limitPos) {
-							break;
-						}
-						char folded[UTF8MaxBytes * maxFoldingExpansion + 1];
-						lenFlat = pcf->Fold(folded, sizeof(folded), bytes, widthChar);
-						// memcmp may examine lenFlat bytes in both arguments so assert it doesn't read past end of searchThing
-						assert((indexSearch + lenFlat) <= searchThing.size());
-						// Does folded match the buffer
-						characterMatches = 0 == memcmp(folded, &searchThing[0] + indexSearch, lenFlat);
-					}
-					if (!characterMatches) {
-						break;
-					}
-					posIndexDocument += widthChar;
-					indexSearch += lenFlat;
-				}
-				if (characterMatches && (indexSearch == lenSearch)) {
-					if (MatchesWordOptions(word, wordStart, pos, posIndexDocument - pos)) {
-						*length = posIndexDocument - pos;
-						return pos;
-					}
+				const Sci::Position endMatch = MatchFoldedUTF8(cbView, pos, limitPos, pcf.get(),
+					searchThing, lenSearch, widthFirstCharacter);
+				if ((endMatch >= 0) && MatchesWordOptions(word, wordStart, pos, endMatch - pos)) {
+					*length = endMatch - pos;
+					return pos;
 				}
-				if (forward) {
-					pos += widthFirstCharacter;
-				} else {
-					if (!NextCharacter(pos, increment)) {
-						break;
-					}
+				if (!NextCharacter(pos, increment)) {
+					break;
 				}
 			}
 		} else if (dbcsCodePage) {
 			constexpr size_t maxBytesCharacter = 2;
-			constexpr size_t maxFoldingExpansion = 4;
 			std::vector<char> searchThing((lengthFind+1) * maxBytesCharacter * maxFoldingExpansion + 1);
 			const size_t lenSearch = pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
 			while (forward ? (pos < endPos) : (pos >= endPos)) {
@@ -2294,7 +3504,8 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 				}
 			}
 		} else {
-			const Sci::Position endSearch = (startPos <= endPos) ? endPos - lengthFind + 1 : endPos;
+			// Forward searches are handled by LiteralSearcher
+			const Sci::Position endSearch = endPos;
 			std::vector<char> searchThing(lengthFind + 1);
 			pcf->Fold(&searchThing[0], searchThing.size(), search, lengthFind);
 			while (forward ? (pos < endSearch) : (pos >= endSearch)) {
@@ -2321,6 +3532,54 @@ Sci::Position Document::FindText(Sci::Position minPos, Sci::Position maxPos, con
 	return -1;
 }
 
+// Start finding all the matches of literal text in a range on a worker thread with pcfSearch
+// folding case. Returns an identifier for taking the matches or 0 when the search can not be
+// performed in the background so the caller should use FindText.
+int Document::SearchAllStart(Sci::Position minPos, Sci::Position maxPos, const char *search, Sci::Position length,
+	FindOption flags, std::unique_ptr<CaseFolder> pcfSearch) {
+	if ((length <= 0) || (minPos > maxPos) || !pcfSearch || FlagSet(flags, FindOption::RegExp))
+		return 0;
+	const std::string_view text(search, length);
+	if (!LiteralSearcher::Handles(text, FlagSet(flags, FindOption::MatchCase), dbcsCodePage))
+		return 0;
+	searchLast = (searchLast == INT_MAX) ? 1 : searchLast + 1;
+	std::unique_ptr<BackgroundSearch> background = std::make_unique<BackgroundSearch>(
+		searchLast, SnapshotCache().Refresh(this), std::move(pcfSearch), text, flags, dbcsCodePage);
+	try {
+		background->Start(MovePositionOutsideChar(minPos, 1, false), MovePositionOutsideChar(maxPos, 1, false));
+	} catch (const std::system_error &) {
+		return 0;
+	}
+	searches.push_back(std::move(background));
+	return searchLast;
+}
+
+// Returns the start of the next match of a search and sets length, -1 when no match is ready
+// yet or -2 when the search has finished and all its matches have been taken.
+Sci::Position Document::SearchAllNext(int search, Sci::Position *length) {
+	for (auto it = searches.begin(); it != searches.end(); ++it) {
+		if ((*it)->Id() == search) {
+			const Sci::Position pos = (*it)->Next(this, length);
+			if (pos == -2) {
+				searches.erase(it);
+			}
+			return pos;
+		}
+	}
+	return -2;
+}
+
+void Document::SearchAllCancel(int search) noexcept {
+	searches.erase(std::remove_if(searches.begin(), searches.end(),
+		[search](const std::unique_ptr<BackgroundSearch> &background) noexcept {
+		return background->Id() == search;
+	}), searches.end());
+}
+
+void Document::SearchAllStop() noexcept {
+	searches.clear();
+}
+
 const char *Document::SubstituteByPosition(const char *text, Sci::Position *length) {
 	if (regex)
 		return regex->SubstituteByPosition(this, text, length);
@@ -2397,7 +3656,7 @@ bool SCI_METHOD Document::SetStyles(Sci_Position length, const char *styles) {
 		bool didChange = false;
 		Sci::Position startMod = 0;
 		Sci::Position endMod = 0;
-		for (int iPos = 0; iPos < length; iPos++, endStyled++) {
+		for (Sci::Position iPos = 0; iPos < length; iPos++, endStyled++) {
 			PLATFORM_ASSERT(endStyled < Length());
 			if (cb.SetStyleAt(endStyled, styles[iPos])) {
 				if (!didChange) {
@@ -2417,6 +3676,37 @@ bool SCI_METHOD Document::SetStyles(Sci_Position length, const char *styles) {
 	}
 }
 
+// Each run is filled as a block and there is one notification covering all changed runs.
+bool SCI_METHOD Document::SetStyleRuns(Sci_Position runs, const Sci_Position *lengths, const char *styles) {
+	if (enteredStyling != 0) {
+		return false;
+	} else {
+		enteredStyling++;
+		bool didChange = false;
+		Sci::Position startMod = 0;
+		Sci::Position endMod = 0;
+		for (Sci::Position run = 0; run < runs; run++) {
+			const Sci::Position length = lengths[run];
+			PLATFORM_ASSERT(length >= 0 && endStyled + length <= Length());
+			if (cb.SetStyleFor(endStyled, length, styles[run])) {
+				if (!didChange) {
+					startMod = endStyled;
+				}
+				didChange = true;
+				endMod = endStyled + length;
+			}
+			endStyled += length;
+		}
+		if (didChange) {
+			const DocModification mh(ModificationFlags::ChangeStyle | ModificationFlags::User,
+			                   startMod, endMod - startMod);
+			NotifyModified(mh);
+		}
+		enteredStyling--;
+		return true;
+	}
+}
+
 void Document::EnsureStyledTo(Sci::Position pos) {
 	if ((enteredStyling == 0) && (pos > GetEndStyled())) {
 		IncrementStyleClock();
@@ -2441,6 +3731,17 @@ void Document::StyleToAdjustingLineDuration(Sci::Position pos) {
 	durationStyleOneByte.AddSample(pos - stylingStart, epStyling.Duration());
 }
 
+bool Document::StyleInBackground(Sci::Position pos) {
+	if ((enteredStyling == 0) && (pos > GetEndStyled()) && pli && !pli->UseContainerLexing()) {
+		const Sci::Line lineEndStyled = SciLineFromPosition(GetEndStyled());
+		// Chunks take around 20 milliseconds to lex so modifications do not wait long
+		const size_t chunkLength = std::clamp<size_t>(
+			durationStyleOneByte.ActionsInAllowedTime(0.02), 0x1000, 0x100000);
+		return pli->ColouriseInBackground(LineStart(lineEndStyled), pos, chunkLength);
+	}
+	return false;
+}
+
 LexInterface *Document::GetLexInterface() const noexcept {
 	return pli.get();
 }
@@ -2449,6 +3750,23 @@ void Document::SetLexInterface(std::unique_ptr<LexInterface> pLexInterface) noex
 	pli = std::move(pLexInterface);
 }
 
+BlockCache &Document::SnapshotCache() {
+	if (!blockCache) {
+		blockCache = std::make_unique<BlockCache>();
+	}
+	return *blockCache;
+}
+
+// Forget the cached blocks when line ends or fold levels change without notifications.
+void Document::ClearSnapshot() noexcept {
+	if (pli) {
+		pli->StopBackground();
+	}
+	if (blockCache) {
+		blockCache->Clear();
+	}
+}
+
 int SCI_METHOD Document::SetLineState(Sci_Position line, int state) {
 	const int statePrevious = States()->SetLineState(line, state, LinesTotal());
 	if (state != statePrevious) {
@@ -2460,7 +3778,7 @@ int SCI_METHOD Document::SetLineState(Sci_Position line, int state) {
 }
 
 int SCI_METHOD Document::GetLineState(Sci_Position line) const {
-	return States()->GetLineState(line);
+	return States()->ValueAt(line);
 }
 
 Sci::Line Document::GetMaxLineState() const noexcept {
@@ -2651,6 +3969,13 @@ void Document::NotifyModified(DocModification mh) {
 	} else if (FlagSet(mh.modificationType, ModificationFlags::DeleteText)) {
 		decorations->DeleteRange(mh.position, mh.length);
 	}
+	if (FlagSet(mh.modificationType, ModificationFlags::InsertText | ModificationFlags::DeleteText)) {
+		// Positions found by searches would be wrong
+		SearchAllStop();
+	}
+	if (blockCache) {
+		blockCache->Modified(mh);
+	}
 	for (const WatcherWithUserData &watcher : watchers) {
 		watcher.watcher->NotifyModified(this, mh, watcher.userData);
 	}
@@ -2817,6 +4142,25 @@ Sci::Position Document::BraceMatch(Sci::Position position, Sci::Position /*maxRe
 	return - 1;
 }
 
+#ifndef NO_CXX11_REGEX
+
+/**
+ * The most recently compiled std::regex so repeating a search does not compile it again.
+ */
+struct Cxx11RegexProgram {
+	std::string pattern;
+	std::regex::flag_type flags = std::regex::ECMAScript;
+	bool wide = false;
+	bool valid = false;
+	std::regex regexp;
+	std::wregex wregexp;
+	bool Matches(const char *pattern_, std::regex::flag_type flags_, bool wide_) const noexcept {
+		return valid && (flags == flags_) && (wide == wide_) && (pattern == pattern_);
+	}
+};
+
+#endif
+
 /**
  * Implementation of RegexSearchBase for the default built-in regular expression engine
  */
@@ -2832,6 +4176,9 @@ public:
 
 private:
 	RESearch search;
+#ifndef NO_CXX11_REGEX
+	Cxx11RegexProgram cxx11Program;
+#endif
 	std::string substituted;
 };
 
@@ -3178,7 +4525,7 @@ bool MatchOnLines(const Document *doc, const Regex &regexp, const RESearchRange
 }
 
 Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci::Position maxPos, const char *s,
-	bool caseSensitive, Sci::Position *length, RESearch &search) {
+	bool caseSensitive, Sci::Position *length, RESearch &search, Cxx11RegexProgram &program) {
 	const RESearchRange resr(doc, minPos, maxPos);
 	try {
 		//ElapsedPeriod ep;
@@ -3195,17 +4542,26 @@ Sci::Position Cxx11RegexFindText(const Document *doc, Sci::Position minPos, Sci:
 		// Clear the RESearch so can fill in matches
 		search.Clear();
 
-		bool matched = false;
-		if (CpUtf8 == doc->dbcsCodePage) {
-			const std::wstring ws = WStringFromUTF8(s);
-			std::wregex regexp;
-			regexp.assign(ws, flagsRe);
-			matched = MatchOnLines<UTF8Iterator>(doc, regexp, resr, search);
+		const bool wide = CpUtf8 == doc->dbcsCodePage;
+		if (!program.Matches(s, flagsRe, wide)) {
+			program.valid = false;
+			if (wide) {
+				const std::wstring ws = WStringFromUTF8(s);
+				program.wregexp.assign(ws, flagsRe);
+			} else {
+				program.regexp.assign(s, flagsRe);
+			}
+			program.pattern = s;
+			program.flags = flagsRe;
+			program.wide = wide;
+			program.valid = true;
+		}
 
+		bool matched = false;
+		if (wide) {
+			matched = MatchOnLines<UTF8Iterator>(doc, program.wregexp, resr, search);
 		} else {
-			std::regex regexp;
-			regexp.assign(s, flagsRe);
-			matched = MatchOnLines<ByteIterator>(doc, regexp, resr, search);
+			matched = MatchOnLines<ByteIterator>(doc, program.regexp, resr, search);
 		}
 
 		Sci::Position posMatch = -1;
@@ -3239,7 +4595,7 @@ Sci::Position BuiltinRegex::FindText(Document *doc, Sci::Position minPos, Sci::P
 #ifndef NO_CXX11_REGEX
 	if (FlagSet(flags, FindOption::Cxx11RegEx)) {
 			return Cxx11RegexFindText(doc, minPos, maxPos, s,
-			caseSensitive, length, search);
+			caseSensitive, length, search, cxx11Program);
 	}
 #endif
 
@@ -89,6 +89,14 @@ public:
 	}
 };
 
+/**
+ * A range of the document and the text to replace it with.
+ */
+struct RangeReplacement {
+	Range range;
+	std::string_view text;
+};
+
 /**
  * Interface class for regular expression searching
  */
@@ -186,11 +194,16 @@ using LexerInstance = std::unique_ptr<Scintilla::ILexer5, LexerReleaser>;
 // LexInterface defines the interface to ILexer used in Document.
 // The LexState subclass is actually created and that is used within ScintillaBase
 // to provide more methods that are exposed through Scintilla's external API.
+class BlockCache;
+class BackgroundLexer;
+class BackgroundSearch;
+
 class LexInterface {
 protected:
 	Document *pdoc;
 	LexerInstance instance;
 	bool performingStyle;	///< Prevent reentrance
+	std::unique_ptr<BackgroundLexer> background;	///< Declared after instance so stops before it is released
 public:
 	explicit LexInterface(Document *pdoc_) noexcept;
 	// Deleted so LexInterface objects can not be copied.
@@ -201,6 +214,8 @@ public:
 	virtual ~LexInterface() noexcept;
 	void SetInstance(ILexer5 *instance_) noexcept;
 	void Colourise(Sci::Position start, Sci::Position end);
+	bool ColouriseInBackground(Sci::Position start, Sci::Position end, size_t chunkLength);
+	void StopBackground() noexcept;
 	virtual Scintilla::LineEndType LineEndTypesSupported();
 	bool UseContainerLexing() const noexcept;
 };
@@ -255,7 +270,7 @@ struct CharacterExtracted {
 
 /**
  */
-class Document : PerLine, public Scintilla::IDocument, public Scintilla::ILoader {
+class Document : PerLine, public Scintilla::IDocument5, public Scintilla::ILoader {
 
 public:
 	/** Used to pair watcher pointer with user data. */
@@ -299,6 +314,10 @@ private:
 
 	bool matchesValid;
 	std::unique_ptr<RegexSearchBase> regex;
+	// Declared before pli as a background lexing pass returns its blocks to the cache when it stops
+	std::unique_ptr<BlockCache> blockCache;
+	std::vector<std::unique_ptr<BackgroundSearch>> searches;
+	int searchLast;
 	std::unique_ptr<LexInterface> pli;
 
 public:
@@ -341,7 +360,7 @@ public:
 	Scintilla::LineEndType GetLineEndTypesActive() const noexcept { return cb.GetLineEndTypes(); }
 
 	int SCI_METHOD Version() const override {
-		return Scintilla::dvRelease4;
+		return Scintilla::dvRelease5;
 	}
 
 	void SCI_METHOD SetErrorStatus(int status) override;
@@ -377,6 +396,7 @@ public:
 	bool DeleteChars(Sci::Position pos, Sci::Position len);
 	Sci::Position InsertString(Sci::Position position, const char *s, Sci::Position insertLength);
 	Sci::Position InsertString(Sci::Position position, std::string_view sv);
+	Sci::Position ReplaceRanges(const std::vector<RangeReplacement> &replacements, Sci::Position *positionEnd=nullptr);
 	void ChangeInsertion(const char *s, Sci::Position length);
 	int SCI_METHOD AddData(const char *data, Sci_Position length) override;
 	void * SCI_METHOD ConvertToDocument() override;
@@ -385,6 +405,9 @@ public:
 	bool CanUndo() const noexcept { return cb.CanUndo(); }
 	bool CanRedo() const noexcept { return cb.CanRedo(); }
 	void DeleteUndoHistory() { cb.DeleteUndoHistory(); }
+	void SetUndoMemoryLimit(size_t limit) { cb.SetUndoMemoryLimit(limit); }
+	size_t UndoMemoryLimit() const noexcept { return cb.UndoMemoryLimit(); }
+	size_t UndoMemoryUsed() const noexcept { return cb.UndoMemoryUsed(); }
 	bool SetUndoCollection(bool collectUndo) {
 		return cb.SetUndoCollection(collectUndo);
 	}
@@ -408,6 +431,7 @@ public:
 
 	const char * SCI_METHOD BufferPointer() override { return cb.BufferPointer(); }
 	const char *RangePointer(Sci::Position position, Sci::Position rangeLength) noexcept { return cb.RangePointer(position, rangeLength); }
+	const char * SCI_METHOD ContiguousRangePointer(Sci_Position position, Sci_Position rangeLength) const override;
 	Sci::Position GapPosition() const noexcept { return cb.GapPosition(); }
 
 	int SCI_METHOD GetLineIndentation(Sci_Position line) override;
@@ -484,6 +508,11 @@ public:
 	bool HasCaseFolder() const noexcept;
 	void SetCaseFolder(std::unique_ptr<CaseFolder> pcf_) noexcept;
 	Sci::Position FindText(Sci::Position minPos, Sci::Position maxPos, const char *search, Scintilla::FindOption flags, Sci::Position *length);
+	int SearchAllStart(Sci::Position minPos, Sci::Position maxPos, const char *search, Sci::Position length,
+		Scintilla::FindOption flags, std::unique_ptr<CaseFolder> pcfSearch);
+	Sci::Position SearchAllNext(int search, Sci::Position *length);
+	void SearchAllCancel(int search) noexcept;
+	void SearchAllStop() noexcept;
 	const char *SubstituteByPosition(const char *text, Sci::Position *length);
 	Scintilla::LineCharacterIndexType LineCharacterIndex() const noexcept;
 	void AllocateLineCharacterIndex(Scintilla::LineCharacterIndexType lineCharacterIndex);
@@ -499,15 +528,18 @@ public:
 	void SCI_METHOD StartStyling(Sci_Position position) override;
 	bool SCI_METHOD SetStyleFor(Sci_Position length, char style) override;
 	bool SCI_METHOD SetStyles(Sci_Position length, const char *styles) override;
+	bool SCI_METHOD SetStyleRuns(Sci_Position runs, const Sci_Position *lengths, const char *styles) override;
 	Sci::Position GetEndStyled() const noexcept { return endStyled; }
 	void EnsureStyledTo(Sci::Position pos);
 	void StyleToAdjustingLineDuration(Sci::Position pos);
+	bool StyleInBackground(Sci::Position pos);
 	int GetStyleClock() const noexcept { return styleClock; }
 	void IncrementStyleClock() noexcept;
 	void SCI_METHOD DecorationSetCurrentIndicator(int indicator) override;
 	void SCI_METHOD DecorationFillRange(Sci_Position position, int value, Sci_Position fillLength) override;
 	LexInterface *GetLexInterface() const noexcept;
 	void SetLexInterface(std::unique_ptr<LexInterface> pLexInterface) noexcept;
+	BlockCache &SnapshotCache();
 
 	int SCI_METHOD SetLineState(Sci_Position line, int state) override;
 	int SCI_METHOD GetLineState(Sci_Position line) const override;
@@ -547,6 +579,7 @@ public:
 	Sci::Position BraceMatch(Sci::Position position, Sci::Position maxReStyle, Sci::Position startPos, bool useStartPos) noexcept;
 
 private:
+	void ClearSnapshot() noexcept;
 	void NotifyModifyAttempt();
 	void NotifySavePoint(bool atSavePoint);
 	void NotifyModified(DocModification mh);
@@ -617,7 +650,7 @@ public:
 		position(act.position),
 		length(act.lenData),
 		linesAdded(linesAdded_),
-		text(act.data.get()),
+		text(act.data),
 		line(0),
 		foldLevelNow(Scintilla::FoldLevel::None),
 		foldLevelPrev(Scintilla::FoldLevel::None),
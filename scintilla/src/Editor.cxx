@@ -25,6 +25,8 @@
 #include <iterator>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <future>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -188,6 +190,7 @@ Editor::Editor() : durationWrapOneByte(0.000001, 0.00000001, 0.00001) {
 	willRedrawAll = false;
 	idleStyling = IdleStyling::None;
 	needIdleStyling = false;
+	idleStylingThreaded = false;
 
 	modEventMask = ModificationFlags::EventMaskAll;
 	commandEvents = true;
@@ -1509,10 +1512,52 @@ bool Editor::WrapOneLine(Surface *surface, Sci::Line lineToWrap) {
 	return pcs->SetHeight(lineToWrap, linesWrapped);
 }
 
+// Wrap a block of lines concurrently on the layout threads then set all their heights.
+// Each line is laid out into a temporary LineLayout as the layout cache is not thread safe.
+bool Editor::WrapBlock(Surface *surface, Sci::Line lineToWrap, Sci::Line lineToWrapEnd) {
+	const Sci::Line lines = lineToWrapEnd - lineToWrap;
+	std::vector<int> heights(lines, 1);
+	std::atomic<Sci::Line> nextIndex = 0;
+	const size_t threads = std::min<size_t>(view.GetLayoutThreads(), lines);
+	std::vector<std::future<void>> futures;
+	for (size_t th = 0; th < threads; th++) {
+		std::future<void> fut = std::async(std::launch::async,
+			[this, surface, lineToWrap, lines, &heights, &nextIndex]() {
+			while (true) {
+				const Sci::Line i = nextIndex.fetch_add(1, std::memory_order_acq_rel);
+				if (i >= lines) {
+					break;
+				}
+				const Sci::Line line = lineToWrap + i;
+				LineLayout ll(line, static_cast<int>(pdoc->LineStart(line + 1) - pdoc->LineStart(line) + 1));
+				view.LayoutLine(*this, surface, vs, &ll, wrapWidth, true);
+				heights[i] = ll.lines;
+			}
+		});
+		futures.push_back(std::move(fut));
+	}
+	for (std::future<void> &f : futures) {
+		f.get();
+	}
+
+	bool wrapOccurred = false;
+	for (Sci::Line i = 0; i < lines; i++) {
+		int linesWrapped = heights[i];
+		if (vs.annotationVisible != AnnotationVisible::Hidden) {
+			linesWrapped += pdoc->AnnotationLines(lineToWrap + i);
+		}
+		if (pcs->SetHeight(lineToWrap + i, linesWrapped)) {
+			wrapOccurred = true;
+		}
+	}
+	return wrapOccurred;
+}
+
 // Perform  wrapping for a subset of the lines needing wrapping.
 // wsAll: wrap all lines which need wrapping in this single call
 // wsVisible: wrap currently visible lines
 // wsIdle: wrap one page + 100 lines
+// wsAll and wsIdle use multiple threads when layout threads are enabled.
 // Return true if wrapping occurred.
 bool Editor::WrapLines(WrapScope ws) {
 	Sci::Line goodTopLine = topLine;
@@ -1537,6 +1582,7 @@ bool Editor::WrapLines(WrapScope ws) {
 			// Idle processing not supported so full wrap required.
 			ws = WrapScope::wsAll;
 		}
+		const unsigned int threads = (ws == WrapScope::wsVisible) ? 1 : view.GetLayoutThreads();
 		// Decide where to start wrapping
 		Sci::Line lineToWrap = wrapPending.start;
 		Sci::Line lineToWrapEnd = std::min(wrapPending.end, pdoc->LinesTotal());
@@ -1570,7 +1616,7 @@ bool Editor::WrapLines(WrapScope ws) {
 			constexpr double secondsAllowed = 0.01;
 			const size_t actionsInAllowedTime = std::clamp<Sci::Line>(
 				durationWrapOneByte.ActionsInAllowedTime(secondsAllowed),
-				0x200, 0x20000);
+				0x200, 0x20000 * threads);
 			lineToWrapEnd = pdoc->LineFromPositionAfter(lineToWrap, actionsInAllowedTime);
 		}
 		const Sci::Line lineEndNeedWrap = std::min(wrapPending.end, pdoc->LinesTotal());
@@ -1592,6 +1638,14 @@ bool Editor::WrapLines(WrapScope ws) {
 
 				const size_t bytesBeingWrapped = pdoc->LineStart(lineToWrapEnd) - pdoc->LineStart(lineToWrap);
 				ElapsedPeriod epWrapping;
+				if ((threads > 1) && (lineToWrapEnd - lineToWrap > 1) &&
+					surface->SupportsFeature(Supports::ThreadSafeMeasureWidths)) {
+					wrapOccurred = WrapBlock(surface, lineToWrap, lineToWrapEnd);
+					while (lineToWrap < lineToWrapEnd) {
+						wrapPending.Wrapped(lineToWrap);
+						lineToWrap++;
+					}
+				}
 				while (lineToWrap < lineToWrapEnd) {
 					if (WrapOneLine(surface, lineToWrap)) {
 						wrapOccurred = true;
@@ -4252,6 +4306,29 @@ Sci::Position Editor::SearchInTarget(const char *text, Sci::Position length) {
 	}
 }
 
+/**
+ * Start finding all the matches of text in the target range on a worker thread.
+ * @return An identifier for SearchAllNext or 0 if the search can not be performed in the background.
+ */
+int Editor::SearchAllInTarget(const char *text, Sci::Position length) {
+	return pdoc->SearchAllStart(targetRange.start.Position(), targetRange.end.Position(), text, length,
+		searchFlags, CaseFolderForEncoding());
+}
+
+/**
+ * Set the target to the next match found by a search started with SearchAllInTarget.
+ * @return The position of the match, -1 if none is ready yet or -2 if all have been taken.
+ */
+Sci::Position Editor::SearchAllNext(int search) {
+	Sci::Position lengthFound = 0;
+	const Sci::Position pos = pdoc->SearchAllNext(search, &lengthFound);
+	if (pos >= 0) {
+		targetRange.start.SetPosition(pos);
+		targetRange.end.SetPosition(pos + lengthFound);
+	}
+	return pos;
+}
+
 void Editor::GoToLine(Sci::Line lineNo) {
 	if (lineNo > pdoc->LinesTotal())
 		lineNo = pdoc->LinesTotal();
@@ -5104,6 +5181,10 @@ void Editor::TickFor(TickReason reason) {
 			}
 			FineTickerCancel(TickReason::dwell);
 			break;
+		case TickReason::style:
+			FineTickerCancel(TickReason::style);
+			StartIdleStyling(true);
+			break;
 		default:
 			// tickPlatform handled by subclass
 			break;
@@ -5228,10 +5309,19 @@ void Editor::IdleStyle() {
 	const Sci::Position posAfterArea = PositionAfterArea(GetClientRectangle());
 	const Sci::Position endGoal = (idleStyling >= IdleStyling::AfterVisible) ?
 		pdoc->Length() : posAfterArea;
-	const Sci::Position posAfterMax = PositionAfterMaxStyling(endGoal, false);
-	pdoc->StyleToAdjustingLineDuration(posAfterMax);
+	// Once the visible text is styled, the remainder may be lexed on a worker thread
+	const bool threaded = idleStylingThreaded && (pdoc->GetEndStyled() >= posAfterArea) &&
+		pdoc->StyleInBackground(endGoal);
+	if (!threaded) {
+		const Sci::Position posAfterMax = PositionAfterMaxStyling(endGoal, false);
+		pdoc->StyleToAdjustingLineDuration(posAfterMax);
+	}
 	if (pdoc->GetEndStyled() >= endGoal) {
 		needIdleStyling = false;
+	} else if (threaded) {
+		// Check for more results from the worker on a timer instead of spinning in idle
+		needIdleStyling = false;
+		FineTickerStart(TickReason::style, 10, 5);
 	}
 }
 
@@ -5735,6 +5825,25 @@ Sci::Position Editor::ReplaceTarget(ReplaceType replaceType, std::string_view te
 	return text.length();
 }
 
+// Replace many ranges at once and set the target to the span of the changes.
+Sci::Position Editor::ReplaceRanges(const TextReplacement *replacements, size_t count) {
+	std::vector<RangeReplacement> ranges;
+	ranges.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		const TextReplacement &replacement = replacements[i];
+		ranges.push_back({ Range(replacement.chrg.cpMin, replacement.chrg.cpMax),
+			std::string_view(replacement.text, replacement.length) });
+	}
+	// The end is reported by the document as it may stop early or the insertions may be changed
+	Sci::Position positionEnd = 0;
+	const Sci::Position replaced = pdoc->ReplaceRanges(ranges, &positionEnd);
+	if (replaced > 0) {
+		targetRange = SelectionSegment(SelectionPosition(ranges.front().range.start),
+			SelectionPosition(positionEnd));
+	}
+	return replaced;
+}
+
 bool Editor::IsUnicodeMode() const noexcept {
 	return pdoc && (CpUtf8 == pdoc->dbcsCodePage);
 }
@@ -6262,10 +6371,26 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 		PLATFORM_ASSERT(lParam);
 		return ReplaceTarget(ReplaceType::minimal, ViewFromParams(lParam, wParam));
 
+	case Message::ReplaceRanges:
+		if (lParam == 0)
+			return 0;
+		return ReplaceRanges(static_cast<const TextReplacement *>(PtrFromSPtr(lParam)), wParam);
+
 	case Message::SearchInTarget:
 		PLATFORM_ASSERT(lParam);
 		return SearchInTarget(ConstCharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
 
+	case Message::SearchAllInTarget:
+		PLATFORM_ASSERT(lParam);
+		return SearchAllInTarget(ConstCharPtrFromSPtr(lParam), PositionFromUPtr(wParam));
+
+	case Message::SearchAllNext:
+		return SearchAllNext(static_cast<int>(wParam));
+
+	case Message::SearchAllCancel:
+		pdoc->SearchAllCancel(static_cast<int>(wParam));
+		break;
+
 	case Message::SetSearchFlags:
 		searchFlags = static_cast<FindOption>(wParam);
 		break;
@@ -6450,6 +6575,16 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetUndoCollection:
 		return pdoc->IsCollectingUndo();
 
+	case Message::SetUndoMemoryLimit:
+		pdoc->SetUndoMemoryLimit(wParam);
+		return 0;
+
+	case Message::GetUndoMemoryLimit:
+		return pdoc->UndoMemoryLimit();
+
+	case Message::GetUndoMemoryUsed:
+		return pdoc->UndoMemoryUsed();
+
 	case Message::BeginUndoAction:
 		pdoc->BeginUndoAction();
 		return 0;
@@ -6874,6 +7009,16 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetIdleStyling:
 		return static_cast<sptr_t>(idleStyling);
 
+	case Message::SetIdleStylingThreaded:
+		idleStylingThreaded = wParam != 0;
+		if (!idleStylingThreaded && pdoc->GetLexInterface()) {
+			pdoc->GetLexInterface()->StopBackground();
+		}
+		break;
+
+	case Message::GetIdleStylingThreaded:
+		return idleStylingThreaded;
+
 	case Message::SetWrapMode:
 		if (vs.SetWrapState(static_cast<Wrap>(wParam))) {
 			xOffset = 0;
@@ -6941,6 +7086,9 @@ sptr_t Editor::WndProc(Message iMessage, uptr_t wParam, sptr_t lParam) {
 	case Message::GetPositionCache:
 		return view.posCache->GetSize();
 
+	case Message::GetPositionCacheStatistic:
+		return view.posCache->Statistic(static_cast<PositionCacheStatistic>(wParam));
+
 	case Message::SetLayoutThreads:
 		view.SetLayoutThreads(static_cast<unsigned int>(wParam));
 		break;
@@ -314,6 +314,12 @@ int LineState::GetLineState(Sci::Line line) {
 	return lineStates[line];
 }
 
+int LineState::ValueAt(Sci::Line line) const noexcept {
+	if ((line < 0) || (line >= lineStates.Length()))
+		return 0;
+	return lineStates.ValueAt(line);
+}
+
 Sci::Line LineState::GetMaxLineState() const noexcept {
 	return lineStates.Length();
 }
@@ -89,6 +89,8 @@ public:
 
 	int SetLineState(Sci::Line line, int state, Sci::Line lines);
 	int GetLineState(Sci::Line line);
+	// Does not extend so may be called concurrently while the document is not being modified
+	int ValueAt(Sci::Line line) const noexcept;
 	Sci::Line GetMaxLineState() const noexcept;
 };
 
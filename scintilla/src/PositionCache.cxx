@@ -22,6 +22,7 @@
 #include <iterator>
 #include <memory>
 #include <mutex>
+#include <array>
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
@@ -817,7 +818,7 @@ bool BreakFinder::More() const noexcept {
 class PositionCacheEntry {
 	uint16_t styleNumber;
 	uint16_t len;
-	uint16_t clock;
+	uint32_t clock;
 	std::unique_ptr<XYPOSITION[]> positions;
 public:
 	PositionCacheEntry() noexcept;
@@ -828,19 +829,33 @@ public:
 	void operator=(const PositionCacheEntry &) = delete;
 	void operator=(PositionCacheEntry &&) = delete;
 	~PositionCacheEntry();
-	void Set(unsigned int styleNumber_, std::string_view sv, const XYPOSITION *positions_, uint16_t clock_);
+	void Set(unsigned int styleNumber_, std::string_view sv, const XYPOSITION *positions_, uint32_t clock_);
 	void Clear() noexcept;
 	bool Retrieve(unsigned int styleNumber_, std::string_view sv, XYPOSITION *positions_) const noexcept;
 	static size_t Hash(unsigned int styleNumber_, std::string_view sv) noexcept;
+	bool Empty() const noexcept;
 	bool NewerThan(const PositionCacheEntry &other) const noexcept;
+	void Touch(uint32_t clock_) noexcept;
 	void ResetClock() noexcept;
 };
 
+// The cache is split into shards, each with its own lock, so that layout threads
+// measuring different strings rarely wait on each other.
 class PositionCache : public IPositionCache {
-	std::vector<PositionCacheEntry> pces;
-	std::mutex mutex;
-	uint16_t clock;
-	bool allClear;
+	static constexpr size_t shardCount = 16;
+	struct Shard {
+		std::vector<PositionCacheEntry> pces;
+		std::mutex mutex;
+		uint32_t clock = 1;
+		bool allClear = true;
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t evictions = 0;
+		void Clear() noexcept;
+		uint32_t Tick() noexcept;
+	};
+	std::array<Shard, shardCount> shards;
+	size_t size;
 public:
 	PositionCache();
 	// Deleted so LineAnnotation objects can not be copied.
@@ -853,6 +868,7 @@ public:
 	void Clear() noexcept override;
 	void SetSize(size_t size_) override;
 	size_t GetSize() const noexcept override;
+	size_t Statistic(PositionCacheStatistic statistic) const noexcept override;
 	void MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
 		std::string_view sv, XYPOSITION *positions, bool needsLocking) override;
 };
@@ -872,7 +888,7 @@ PositionCacheEntry::PositionCacheEntry(const PositionCacheEntry &other) :
 }
 
 void PositionCacheEntry::Set(unsigned int styleNumber_, std::string_view sv,
-	const XYPOSITION *positions_, uint16_t clock_) {
+	const XYPOSITION *positions_, uint32_t clock_) {
 	Clear();
 	styleNumber = static_cast<uint16_t>(styleNumber_);
 	len = static_cast<uint16_t>(sv.length());
@@ -915,23 +931,25 @@ size_t PositionCacheEntry::Hash(unsigned int styleNumber_, std::string_view sv)
 	return h1 ^ (h2 << 1);
 }
 
+bool PositionCacheEntry::Empty() const noexcept {
+	return !positions;
+}
+
 bool PositionCacheEntry::NewerThan(const PositionCacheEntry &other) const noexcept {
 	return clock > other.clock;
 }
 
+void PositionCacheEntry::Touch(uint32_t clock_) noexcept {
+	clock = clock_;
+}
+
 void PositionCacheEntry::ResetClock() noexcept {
 	if (clock > 0) {
 		clock = 1;
 	}
 }
 
-PositionCache::PositionCache() {
-	clock = 1;
-	pces.resize(0x400);
-	allClear = true;
-}
-
-void PositionCache::Clear() noexcept {
+void PositionCache::Shard::Clear() noexcept {
 	if (!allClear) {
 		for (PositionCacheEntry &pce : pces) {
 			pce.Clear();
@@ -941,13 +959,57 @@ void PositionCache::Clear() noexcept {
 	allClear = true;
 }
 
+uint32_t PositionCache::Shard::Tick() noexcept {
+	clock++;
+	if (clock == UINT32_MAX) {
+		// Wrap the clock round and reset all cache entries so none get stuck with a high clock.
+		for (PositionCacheEntry &pce : pces) {
+			pce.ResetClock();
+		}
+		clock = 2;
+	}
+	return clock;
+}
+
+PositionCache::PositionCache() : size(0) {
+	SetSize(0x400);
+}
+
+void PositionCache::Clear() noexcept {
+	for (Shard &shard : shards) {
+		shard.Clear();
+	}
+}
+
 void PositionCache::SetSize(size_t size_) {
 	Clear();
-	pces.resize(size_);
+	// Spread entries evenly over the shards with the first shards taking any remainder.
+	for (size_t i = 0; i < shardCount; i++) {
+		shards[i].pces.resize(size_ / shardCount + ((i < size_ % shardCount) ? 1 : 0));
+	}
+	size = size_;
 }
 
 size_t PositionCache::GetSize() const noexcept {
-	return pces.size();
+	return size;
+}
+
+size_t PositionCache::Statistic(PositionCacheStatistic statistic) const noexcept {
+	size_t total = 0;
+	for (const Shard &shard : shards) {
+		switch (statistic) {
+		case PositionCacheStatistic::Hits:
+			total += shard.hits;
+			break;
+		case PositionCacheStatistic::Misses:
+			total += shard.misses;
+			break;
+		case PositionCacheStatistic::Evictions:
+			total += shard.evictions;
+			break;
+		}
+	}
+	return total;
 }
 
 void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
@@ -963,50 +1025,59 @@ void PositionCache::MeasureWidths(Surface *surface, const ViewStyle &vstyle, uns
 		}
 	}
 
-	size_t probe = pces.size();	// Out of bounds
-	if ((!pces.empty()) && (sv.length() < 30)) {
+	Shard *shard = nullptr;
+	size_t probe = 0;
+	if ((size > 0) && (sv.length() < 30)) {
 		// Only store short strings in the cache so it doesn't churn with
 		// long comments with only a single comment.
 
-		// Two way associative: try two probe positions.
+		// Low bits of the hash choose the shard, the rest the slots within it.
 		const size_t hashValue = PositionCacheEntry::Hash(styleNumber, sv);
-		probe = hashValue % pces.size();
-		std::unique_lock<std::mutex> guard(mutex, std::defer_lock);
-		if (needsLocking) {
-			guard.lock();
-		}
-		if (pces[probe].Retrieve(styleNumber, sv, positions)) {
-			return;
-		}
-		const size_t probe2 = (hashValue * 37) % pces.size();
-		if (pces[probe2].Retrieve(styleNumber, sv, positions)) {
-			return;
-		}
-		// Not found. Choose the oldest of the two slots to replace
-		if (pces[probe].NewerThan(pces[probe2])) {
-			probe = probe2;
+		shard = &shards[hashValue % shardCount];
+		std::vector<PositionCacheEntry> &pces = shard->pces;
+		if (pces.empty()) {
+			shard = nullptr;
+		} else {
+			std::unique_lock<std::mutex> guard(shard->mutex, std::defer_lock);
+			if (needsLocking) {
+				guard.lock();
+			}
+			// Two way associative: try two probe positions.
+			const size_t hashShard = hashValue / shardCount;
+			probe = hashShard % pces.size();
+			if (pces[probe].Retrieve(styleNumber, sv, positions)) {
+				pces[probe].Touch(shard->Tick());
+				shard->hits++;
+				return;
+			}
+			const size_t probe2 = (hashShard * 37) % pces.size();
+			if (pces[probe2].Retrieve(styleNumber, sv, positions)) {
+				pces[probe2].Touch(shard->Tick());
+				shard->hits++;
+				return;
+			}
+			shard->misses++;
+			// Not found. Choose the least recently used of the two slots to replace
+			if (pces[probe].NewerThan(pces[probe2])) {
+				probe = probe2;
+			}
 		}
 	}
 
 	const Font *fontStyle = style.font.get();
 	surface->MeasureWidths(fontStyle, sv, positions);
-	if (probe < pces.size()) {
+	if (shard) {
 		// Store into cache
-		std::unique_lock<std::mutex> guard(mutex, std::defer_lock);
+		std::unique_lock<std::mutex> guard(shard->mutex, std::defer_lock);
 		if (needsLocking) {
 			guard.lock();
 		}
-		clock++;
-		if (clock > 60000) {
-			// Since there are only 16 bits for the clock, wrap it round and
-			// reset all cache entries so none get stuck with a high clock.
-			for (PositionCacheEntry &pce : pces) {
-				pce.ResetClock();
-			}
-			clock = 2;
+		PositionCacheEntry &pce = shard->pces[probe];
+		if (!pce.Empty()) {
+			shard->evictions++;
 		}
-		allClear = false;
-		pces[probe].Set(styleNumber, sv, positions, clock);
+		shard->allClear = false;
+		pce.Set(styleNumber, sv, positions, shard->Tick());
 	}
 }
 
@@ -254,6 +254,7 @@ public:
 	virtual void Clear() noexcept = 0;
 	virtual void SetSize(size_t size_) = 0;
 	virtual size_t GetSize() const noexcept = 0;
+	virtual size_t Statistic(Scintilla::PositionCacheStatistic statistic) const noexcept = 0;
 	virtual void MeasureWidths(Surface *surface, const ViewStyle &vstyle, unsigned int styleNumber,
 		std::string_view sv, XYPOSITION *positions, bool needsLocking) = 0;
 };
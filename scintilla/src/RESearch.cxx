@@ -205,6 +205,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <iterator>
 
@@ -257,6 +258,9 @@ RESearch::RESearch(CharClassify *charClassTable) {
 	std::fill(bittab, std::end(bittab), nul);
 	std::fill(tagstk, std::end(tagstk), 0);
 	std::fill(nfa, std::end(nfa), '\0');
+	compiledCaseSensitive = false;
+	compiledPosix = false;
+	std::fill(compiledWordChars, std::end(compiledWordChars), nul);
 	Clear();
 }
 
@@ -432,6 +436,43 @@ int RESearch::GetBackslashExpression(
 	return result;
 }
 
+/*
+ * The compiled program depends on the word characters as well as the pattern
+ * and options so they are all compared to decide if the program can be reused.
+ */
+bool RESearch::IsCompiled(const char *pattern, Sci::Position length, bool caseSensitive, bool posix) const noexcept {
+	if ((sta != OKP) || (caseSensitive != compiledCaseSensitive) || (posix != compiledPosix) ||
+		(std::string_view(pattern, length) != compiledPattern)) {
+		return false;
+	}
+	for (int c = 0; c < MAXCHR; c++) {
+		const bool wasWord = compiledWordChars[c / CHRBIT] & (1 << (c % CHRBIT));
+		if (iswordc(static_cast<unsigned char>(c)) != wasWord) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void RESearch::SetCompiled(const char *pattern, Sci::Position length, bool caseSensitive, bool posix) noexcept {
+	try {
+		compiledPattern.assign(pattern, length);
+	} catch (...) {
+		// Can not remember the pattern so ensure it will be compiled next time
+		sta = NOP;
+		return;
+	}
+	compiledCaseSensitive = caseSensitive;
+	compiledPosix = posix;
+	constexpr unsigned char nul = 0;
+	std::fill(compiledWordChars, std::end(compiledWordChars), nul);
+	for (int c = 0; c < MAXCHR; c++) {
+		if (iswordc(static_cast<unsigned char>(c))) {
+			compiledWordChars[c / CHRBIT] |= static_cast<unsigned char>(1 << (c % CHRBIT));
+		}
+	}
+}
+
 const char *RESearch::Compile(const char *pattern, Sci::Position length, bool caseSensitive, bool posix) noexcept {
 	char *mp=nfa;          /* nfa pointer       */
 	char *lp=nullptr;      /* saved pointer     */
@@ -453,6 +494,8 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 		else
 			return badpat("No previous regular expression");
 	}
+	if (IsCompiled(pattern, length, caseSensitive, posix))
+		return nullptr;
 	sta = NOP;
 
 	const char *p=pattern;     /* pattern pointer   */
@@ -731,6 +774,7 @@ const char *RESearch::Compile(const char *pattern, Sci::Position length, bool ca
 		return badpat((posix ? "Unmatched (" : "Unmatched \\("));
 	*mp = END;
 	sta = OKP;
+	SetCompiled(pattern, length, caseSensitive, posix);
 	return nullptr;
 }
 
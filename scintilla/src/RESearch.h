@@ -44,6 +44,8 @@ private:
 	static constexpr int CHRBIT = 8;
 	static constexpr int BITBLK = MAXCHR / CHRBIT;
 
+	bool IsCompiled(const char *pattern, Sci::Position length, bool caseSensitive, bool posix) const noexcept;
+	void SetCompiled(const char *pattern, Sci::Position length, bool caseSensitive, bool posix) noexcept;
 	void ChSet(unsigned char c) noexcept;
 	void ChSetWithCase(unsigned char c, bool caseSensitive) noexcept;
 	int GetBackslashExpression(const char *pattern, int &incr) noexcept;
@@ -57,6 +59,11 @@ private:
 	unsigned char bittab[BITBLK]; /* bit table for CCL pre-set bits */
 	int failure;
 	CharClassify *charClass;
+	// Key of the program in nfa so the same pattern is not compiled again for each search
+	std::string compiledPattern;
+	bool compiledCaseSensitive;
+	bool compiledPosix;
+	unsigned char compiledWordChars[BITBLK];
 	bool iswordc(unsigned char x) const noexcept {
 		return charClass->IsWord(x);
 	}
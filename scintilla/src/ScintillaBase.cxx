@@ -607,7 +607,10 @@ LexState *ScintillaBase::DocumentLexState() {
 	if (!pdoc->GetLexInterface()) {
 		pdoc->SetLexInterface(std::make_unique<LexState>(pdoc));
 	}
-	return dynamic_cast<LexState *>(pdoc->GetLexInterface());
+	LexState *lexState = dynamic_cast<LexState *>(pdoc->GetLexInterface());
+	// Calls to the lexer must not overlap with lexing on a worker thread
+	lexState->StopBackground();
+	return lexState;
 }
 
 const char *LexState::DescribeWordListSets() {
@@ -60,6 +60,16 @@ protected:
 		}
 	}
 
+	static bool FillPart(T *first, T *last, const T &v) noexcept {
+		// Only write from the first difference so unchanged ranges are just compared
+		first = std::find_if(first, last, [&v](const T &element) noexcept { return !(element == v); });
+		if (first == last) {
+			return false;
+		}
+		std::fill(first, last, v);
+		return true;
+	}
+
 	void Init() {
 		body.clear();
 		body.shrink_to_fit();
@@ -138,6 +148,24 @@ public:
 		}
 	}
 
+	/// Set a range of elements to a value without rearranging the buffer.
+	/// Returns true if any element changed.
+	bool FillRange(ptrdiff_t position, const T &v, ptrdiff_t fillLength) noexcept {
+		PLATFORM_ASSERT(position >= 0 && fillLength >= 0 && (position + fillLength) <= lengthBody);
+		bool changed = false;
+		if (position < part1Length) {
+			const ptrdiff_t range1Length = std::min(fillLength, part1Length - position);
+			changed = FillPart(body.data() + position, body.data() + position + range1Length, v);
+			position += range1Length;
+			fillLength -= range1Length;
+		}
+		if (fillLength > 0) {
+			T *start = body.data() + gapLength + position;
+			changed = FillPart(start, start + fillLength, v) || changed;
+		}
+		return changed;
+	}
+
 	/// Retrieve the element at a particular position.
 	/// The position must be within bounds or an assertion is triggered.
 	const T &operator[](ptrdiff_t position) const noexcept {
@@ -318,6 +346,19 @@ public:
 		}
 	}
 
+	/// Return a pointer to a range of elements if they are already contiguous
+	/// otherwise nullptr. Does not rearrange the buffer.
+	const T *ContiguousRangePointer(ptrdiff_t position, ptrdiff_t rangeLength) const noexcept {
+		if (position < part1Length) {
+			if ((position + rangeLength) > part1Length) {
+				return nullptr;
+			}
+			return body.data() + position;
+		} else {
+			return body.data() + position + gapLength;
+		}
+	}
+
 	/// Return a pointer to a single element.
 	/// Does not rearrange the buffer.
 	const T *ElementPointer(ptrdiff_t position) const noexcept {
@@ -6,15 +6,159 @@
 // The License.txt file describes the conditions under which this software may be distributed.
 
 #include <cstdlib>
+#include <cstdint>
+#include <cstring>
 
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define UNICONVERSION_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(UNICONVERSION_SSE2) && (defined(__x86_64__) || defined(_M_X64)) && \
+	(defined(_MSC_VER) || defined(__GNUC__))
+// AVX2 code is compiled for x64 but is only called after checking the processor supports it
+#define UNICONVERSION_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
 
 #include "UniConversion.h"
 
 namespace Scintilla::Internal {
 
+namespace {
+
+// Scanners that return the length of the ASCII prefix of a byte range.
+// Blocks are checked for a byte with its top bit set and the block containing
+// the first such byte is then finished one byte at a time.
+
+size_t AsciiPrefixPortable(const unsigned char *us, size_t len) noexcept {
+	constexpr uint64_t highBits = 0x8080808080808080U;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+		uint64_t block;
+		memcpy(&block, us + i, sizeof(block));
+		if (block & highBits) {
+			break;
+		}
+	}
+	while ((i < len) && UTF8IsAscii(us[i])) {
+		i++;
+	}
+	return i;
+}
+
+#if defined(UNICONVERSION_SSE2)
+
+size_t AsciiPrefixSSE2(const unsigned char *us, size_t len) noexcept {
+	size_t i = 0;
+	for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(us + i));
+		if (_mm_movemask_epi8(block)) {
+			break;
+		}
+	}
+	return i + AsciiPrefixPortable(us + i, len - i);
+}
+
+#endif
+
+#if defined(UNICONVERSION_AVX2)
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("avx2")))
+#endif
+size_t AsciiPrefixAVX2(const unsigned char *us, size_t len) noexcept {
+	size_t i = 0;
+	for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(us + i));
+		if (_mm256_movemask_epi8(block)) {
+			break;
+		}
+	}
+	// Avoid the penalty for mixing AVX with the SSE code that finishes the scan
+	_mm256_zeroupper();
+	return i + AsciiPrefixSSE2(us + i, len - i);
+}
+
+bool ProcessorHasAVX2() noexcept {
+#if defined(_MSC_VER)
+	int info[4] {};
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	constexpr int osXSave = 1 << 27;
+	constexpr int avx = 1 << 28;
+	if ((info[2] & (osXSave | avx)) != (osXSave | avx)) {
+		return false;
+	}
+	// Operating system must save the SSE and AVX registers
+	if ((_xgetbv(0) & 0x6) != 0x6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	constexpr int avx2 = 1 << 5;
+	return (info[1] & avx2) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+using AsciiPrefixFunction = size_t (*)(const unsigned char *us, size_t len) noexcept;
+
+AsciiPrefixFunction ChooseAsciiPrefix() noexcept {
+#if defined(UNICONVERSION_AVX2)
+	if (ProcessorHasAVX2()) {
+		return AsciiPrefixAVX2;
+	}
+#endif
+#if defined(UNICONVERSION_SSE2)
+	return AsciiPrefixSSE2;
+#else
+	return AsciiPrefixPortable;
+#endif
+}
+
+}
+
+size_t UTF8AsciiPrefixLength(std::string_view svu8) noexcept {
+	static const AsciiPrefixFunction asciiPrefix = ChooseAsciiPrefix();
+	return asciiPrefix(reinterpret_cast<const unsigned char *>(svu8.data()), svu8.length());
+}
+
+namespace {
+
+// Text mixing ASCII with other characters has many short runs of ASCII where
+// calling the block scanner costs more than it saves so only treat text as a
+// run when it starts with a block of ASCII, otherwise return 0.
+inline size_t AsciiRunLength(std::string_view svu8, size_t start) noexcept {
+	constexpr uint64_t highBits = 0x8080808080808080U;
+	uint64_t block;
+	if (start + sizeof(block) > svu8.length()) {
+		return 0;
+	}
+	memcpy(&block, svu8.data() + start, sizeof(block));
+	if (block & highBits) {
+		return 0;
+	}
+	start += sizeof(block);
+	return sizeof(block) + UTF8AsciiPrefixLength(std::string_view(svu8.data() + start, svu8.length() - start));
+}
+
+}
+
 size_t UTF8Length(std::wstring_view wsv) noexcept {
 	size_t len = 0;
 	for (size_t i = 0; i < wsv.length() && wsv[i];) {
@@ -99,6 +243,13 @@ void UTF8FromUTF32Character(int uch, char *putf) noexcept {
 size_t UTF16Length(std::string_view svu8) noexcept {
 	size_t ulen = 0;
 	for (size_t i = 0; i< svu8.length();) {
+		// Each ASCII byte is one UTF-16 code unit
+		const size_t lenAscii = AsciiRunLength(svu8, i);
+		if (lenAscii) {
+			i += lenAscii;
+			ulen += lenAscii;
+			continue;
+		}
 		const unsigned char ch = svu8[i];
 		const unsigned int byteCount = UTF8BytesOfLead[ch];
 		const unsigned int utf16Len = UTF16LengthFromUTF8ByteCount(byteCount);
@@ -117,6 +268,14 @@ constexpr unsigned char TrailByteValue(unsigned char c) {
 size_t UTF16FromUTF8(std::string_view svu8, wchar_t *tbuf, size_t tlen) {
 	size_t ui = 0;
 	for (size_t i = 0; i < svu8.length();) {
+		// Widen a run of ASCII bytes at once
+		const size_t lenAscii = std::min(AsciiRunLength(svu8, i), tlen - ui);
+		if (lenAscii) {
+			std::copy_n(svu8.data() + i, lenAscii, tbuf + ui);
+			i += lenAscii;
+			ui += lenAscii;
+			continue;
+		}
 		unsigned char ch = svu8[i];
 		const unsigned int byteCount = UTF8BytesOfLead[ch];
 		unsigned int value;
@@ -176,6 +335,12 @@ size_t UTF16FromUTF8(std::string_view svu8, wchar_t *tbuf, size_t tlen) {
 size_t UTF32Length(std::string_view svu8) noexcept {
 	size_t ulen = 0;
 	for (size_t i = 0; i < svu8.length();) {
+		const size_t lenAscii = AsciiRunLength(svu8, i);
+		if (lenAscii) {
+			i += lenAscii;
+			ulen += lenAscii;
+			continue;
+		}
 		const unsigned char ch = svu8[i];
 		const unsigned int byteCount = UTF8BytesOfLead[ch];
 		i += byteCount;
@@ -187,6 +352,13 @@ size_t UTF32Length(std::string_view svu8) noexcept {
 size_t UTF32FromUTF8(std::string_view svu8, unsigned int *tbuf, size_t tlen) {
 	size_t ui = 0;
 	for (size_t i = 0; i < svu8.length();) {
+		const size_t lenAscii = std::min(AsciiRunLength(svu8, i), tlen - ui);
+		if (lenAscii) {
+			std::copy_n(svu8.data() + i, lenAscii, tbuf + ui);
+			i += lenAscii;
+			ui += lenAscii;
+			continue;
+		}
 		unsigned char ch = svu8[i];
 		const unsigned int byteCount = UTF8BytesOfLead[ch];
 		unsigned int value;
@@ -367,6 +539,13 @@ bool UTF8IsValid(std::string_view svu8) noexcept {
 	const unsigned char *us = reinterpret_cast<const unsigned char *>(svu8.data());
 	size_t remaining = svu8.length();
 	while (remaining > 0) {
+		// ASCII is always valid so skip over a run of it
+		const size_t lenAscii = AsciiRunLength(svu8, svu8.length() - remaining);
+		if (lenAscii) {
+			us += lenAscii;
+			remaining -= lenAscii;
+			continue;
+		}
 		const int utf8Status = UTF8Classify(us, remaining);
 		if (utf8Status & UTF8MaskInvalid) {
 			return false;
@@ -385,6 +564,13 @@ std::string FixInvalidUTF8(const std::string &text) {
 	const char *s = text.c_str();
 	size_t remaining = text.size();
 	while (remaining > 0) {
+		const size_t lenAscii = AsciiRunLength(text, text.size() - remaining);
+		if (lenAscii) {
+			result.append(s, lenAscii);
+			s += lenAscii;
+			remaining -= lenAscii;
+			continue;
+		}
 		const int utf8Status = UTF8Classify(reinterpret_cast<const unsigned char *>(s), remaining);
 		if (utf8Status & UTF8MaskInvalid) {
 			// Replacement character 0xFFFD = UTF8:"efbfbd".
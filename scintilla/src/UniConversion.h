@@ -27,6 +27,8 @@ size_t UTF32FromUTF8(std::string_view svu8, unsigned int *tbuf, size_t tlen);
 std::wstring WStringFromUTF8(std::string_view svu8);
 unsigned int UTF16FromUTF32Character(unsigned int val, wchar_t *tbuf) noexcept;
 bool UTF8IsValid(std::string_view svu8) noexcept;
+// Length of the leading run of ASCII bytes, scanned with SIMD where available
+size_t UTF8AsciiPrefixLength(std::string_view svu8) noexcept;
 std::string FixInvalidUTF8(const std::string &text);
 
 extern const unsigned char UTF8BytesOfLead[256];
@@ -46,6 +46,14 @@ class FINDTEXTFULL(ctypes.Structure):
 		('cpMaxText', c_ssize_t),
 	)
 
+class TEXTREPLACEMENT(ctypes.Structure):
+	_fields_= (\
+		('cpMin', c_ssize_t),
+		('cpMax', c_ssize_t),
+		('text', c_char_p),
+		('length', c_ssize_t),
+	)
+
 class SciCall:
 	def __init__(self, fn, ptr, msg, stringResult=False):
 		self._fn = fn
@@ -203,6 +211,15 @@ class ScintillaCallable:
 		#~ print(start, end, ft.cpMinText, ft.cpMaxText)
 		return pos
 
+	def ReplaceRangesBytes(self, replacements):
+		trs = (TEXTREPLACEMENT * len(replacements))()
+		for tr, (start, end, text) in zip(trs, replacements):
+			tr.cpMin = start
+			tr.cpMax = end
+			tr.text = text
+			tr.length = len(text)
+		return self.ReplaceRanges(len(replacements), ctypes.byref(trs))
+
 	def Contents(self):
 		return self.ByteRange(0, self.Length)
 
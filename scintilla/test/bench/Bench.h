@@ -0,0 +1,74 @@
+/** @file Bench.h
+ ** Minimal harness for benchmarking Scintilla internal data structures.
+ **/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+namespace Bench {
+
+// Deterministic pseudo-random numbers (xorshift32) so each run works on the same data.
+class Random {
+	uint32_t state;
+public:
+	explicit Random(uint32_t seed=1) noexcept : state(seed ? seed : 1) {
+	}
+	uint32_t Next() noexcept {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+	// Value in [0, limit)
+	uint32_t Below(uint32_t limit) noexcept {
+		return Next() % limit;
+	}
+};
+
+// Text resembling source code with the given number of lines.
+std::string GenerateText(size_t lines, uint32_t seed=1);
+
+// Stops the optimizer removing results that are otherwise unused.
+void Consume(size_t value) noexcept;
+
+// A benchmark function performs any setup then calls Time once with the code to measure.
+// The harness calls the function several times and reports the median and minimum.
+class Run {
+	double seconds = 0.0;
+	size_t items = 0;
+public:
+	template <typename Measured>
+	void Time(size_t items_, Measured measured) {
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		measured();
+		const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		seconds = std::chrono::duration<double>(end - start).count();
+		items = items_;
+	}
+	double Seconds() const noexcept {
+		return seconds;
+	}
+	size_t Items() const noexcept {
+		return items;
+	}
+};
+
+using Function = void (*)(Run &run);
+
+struct Case {
+	std::string name;
+	Function function;
+};
+
+std::vector<Case> &Cases();
+
+// Adds a benchmark to the list run by main: define a static array of these in each file.
+struct Registrar {
+	Registrar(const char *name, Function function) {
+		Cases().push_back({ name, function });
+	}
+};
+
+}
+
+#endif
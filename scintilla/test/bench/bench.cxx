@@ -0,0 +1,149 @@
+/** @file bench.cxx
+ ** Benchmarks for Scintilla internal data structures.
+ ** Writes one line of comma separated values for each benchmark to stdout.
+ **/
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <chrono>
+
+#include "ScintillaTypes.h"
+
+#include "Debugging.h"
+#include "Geometry.h"
+#include "Platform.h"
+
+#include "Bench.h"
+
+using namespace Scintilla::Internal;
+
+// Needed for PLATFORM_ASSERT in code being tested
+
+void Platform::Assert(const char *c, const char *file, int line) noexcept {
+	fprintf(stderr, "Assertion [%s] failed at %s %d\n", c, file, line);
+	abort();
+}
+
+void Platform::DebugPrintf(const char *format, ...) noexcept {
+	char buffer[2000];
+	va_list pArguments;
+	va_start(pArguments, format);
+	vsprintf(buffer, format, pArguments);
+	va_end(pArguments);
+	fprintf(stderr, "%s", buffer);
+}
+
+// Needed by ViewStyle which is linked in for the layout cache but nothing is drawn
+
+std::shared_ptr<Font> Font::Allocate(const FontParameters &) {
+	return {};
+}
+
+ColourRGBA Platform::Chrome() {
+	return ColourRGBA(0xe0, 0xe0, 0xe0);
+}
+
+ColourRGBA Platform::ChromeHighlight() {
+	return ColourRGBA(0xff, 0xff, 0xff);
+}
+
+const char *Platform::DefaultFont() {
+	return "Verdana";
+}
+
+int Platform::DefaultFontSize() {
+	return 10;
+}
+
+namespace Bench {
+
+std::vector<Case> &Cases() {
+	static std::vector<Case> cases;
+	return cases;
+}
+
+namespace {
+
+volatile size_t sink = 0;
+
+}
+
+void Consume(size_t value) noexcept {
+	sink = sink + value;
+}
+
+std::string GenerateText(size_t lines, uint32_t seed) {
+	const char *const words[] = {
+		"int", "return", "if", "else", "for", "while", "const", "static",
+		"position", "line", "length", "style", "document", "buffer", "value", "count",
+		"=", "+", "-", "<", "(", ")", "0", "1", "42", "nullptr", "->", "::",
+	};
+	constexpr uint32_t wordCount = static_cast<uint32_t>(std::size(words));
+	Random random(seed);
+	std::string text;
+	for (size_t line = 0; line < lines; line++) {
+		text.append(random.Below(4), '\t');
+		const uint32_t lineWords = random.Below(12);
+		for (uint32_t word = 0; word < lineWords; word++) {
+			if (word > 0) {
+				text.push_back(' ');
+			}
+			text.append(words[random.Below(wordCount)]);
+		}
+		if (random.Below(8) == 0) {
+			text.append(" // comment");
+		}
+		text.push_back('\n');
+	}
+	return text;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+	// Arguments are an optional count of repeats then optional name filters
+	int repeats = 5;
+	std::vector<std::string_view> filters;
+	for (int arg = 1; arg < argc; arg++) {
+		if ((0 == strcmp(argv[arg], "--repeat")) && (arg + 1 < argc)) {
+			repeats = std::max(atoi(argv[++arg]), 1);
+		} else {
+			filters.emplace_back(argv[arg]);
+		}
+	}
+
+	printf("benchmark,items,repeats,median_ms,min_ms,median_ns_per_item\n");
+	for (const Bench::Case &benchCase : Bench::Cases()) {
+		if (!filters.empty() && std::none_of(filters.begin(), filters.end(), [&benchCase](std::string_view filter) {
+				return benchCase.name.find(filter) != std::string::npos;
+			})) {
+			continue;
+		}
+		std::vector<double> samples;
+		size_t items = 0;
+		for (int repeat = 0; repeat < repeats; repeat++) {
+			Bench::Run run;
+			benchCase.function(run);
+			samples.push_back(run.Seconds());
+			items = run.Items();
+		}
+		std::sort(samples.begin(), samples.end());
+		const double median = samples[samples.size() / 2];
+		const double nsPerItem = items ? median * 1e9 / static_cast<double>(items) : 0.0;
+		printf("%s,%zu,%d,%.3f,%.3f,%.2f\n", benchCase.name.c_str(), items, repeats,
+			median * 1e3, samples.front() * 1e3, nsPerItem);
+		fflush(stdout);
+	}
+	return 0;
+}
@@ -0,0 +1,49 @@
+# Build the benchmarks with Microsoft Visual C++ using nmake
+# Tested with Visual C++ 2019
+
+DEL = del /q
+EXE = benchmark.exe
+
+INCLUDEDIRS = /I../../include /I../../src
+
+CXXFLAGS = /MP /EHsc /std:c++17 /O2 /DNDEBUG /nologo /wd 4805 $(INCLUDEDIRS)
+
+# Files in this directory containing benchmarks
+BENCHSRC=bench*.cxx
+# Files being measured from scintilla/src directory
+# ViewStyle and its dependencies are needed by PositionCache
+BENCHEDSRC=\
+ ../../src/CaseConvert.cxx \
+ ../../src/CaseFolder.cxx \
+ ../../src/CellBuffer.cxx \
+ ../../src/ChangeHistory.cxx \
+ ../../src/CharacterCategoryMap.cxx \
+ ../../src/CharacterType.cxx \
+ ../../src/CharClassify.cxx \
+ ../../src/ContractionState.cxx \
+ ../../src/Decoration.cxx \
+ ../../src/Document.cxx \
+ ../../src/Geometry.cxx \
+ ../../src/Indicator.cxx \
+ ../../src/LineMarker.cxx \
+ ../../src/PerLine.cxx \
+ ../../src/PositionCache.cxx \
+ ../../src/RESearch.cxx \
+ ../../src/RunStyles.cxx \
+ ../../src/Selection.cxx \
+ ../../src/Style.cxx \
+ ../../src/UniConversion.cxx \
+ ../../src/UniqueString.cxx \
+ ../../src/ViewStyle.cxx \
+ ../../src/XPM.cxx
+
+all: $(EXE)
+
+bench: $(EXE)
+	$(EXE)
+
+clean:
+	$(DEL) $(EXE) *.o *.obj *.exe
+
+$(EXE): $(BENCHSRC) $(BENCHEDSRC)
+	$(CXX) $(CXXFLAGS) /Fe$@ $**
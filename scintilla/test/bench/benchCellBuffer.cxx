@@ -0,0 +1,152 @@
+/** @file benchCellBuffer.cxx
+ ** Benchmarks for CellBuffer insertion, deletion, undo and redo.
+ **/
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "ScintillaTypes.h"
+
+#include "Debugging.h"
+
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "SparseVector.h"
+#include "ChangeHistory.h"
+#include "CellBuffer.h"
+
+#include "Bench.h"
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+constexpr size_t documentLines = 100000;
+
+void Load(CellBuffer &cb, const std::string &text) {
+	cb.SetUndoCollection(false);
+	bool startSequence = false;
+	cb.InsertString(0, text.c_str(), text.length(), startSequence);
+	cb.SetUndoCollection(true);
+}
+
+void LoadText(Bench::Run &run) {
+	const std::string text = Bench::GenerateText(documentLines * 10);
+	CellBuffer cb(true, false);
+	cb.SetUndoCollection(false);
+	run.Time(text.length(), [&]() {
+		bool startSequence = false;
+		cb.InsertString(0, text.c_str(), text.length(), startSequence);
+	});
+	Bench::Consume(cb.Lines());
+}
+
+void InsertTyping(Bench::Run &run) {
+	// Single characters added one after another with undo collection as when typing
+	constexpr int characters = 200000;
+	const std::string text = Bench::GenerateText(documentLines);
+	CellBuffer cb(true, false);
+	Load(cb, text);
+	const std::string typed = Bench::GenerateText(characters / 20, 2);
+	Sci::Position position = cb.Length() / 2;
+	run.Time(characters, [&]() {
+		for (int i = 0; i < characters; i++) {
+			bool startSequence = false;
+			cb.InsertString(position, &typed[i % typed.length()], 1, startSequence);
+			position++;
+		}
+	});
+	Bench::Consume(cb.Lines());
+}
+
+void InsertRandom(Bench::Run &run) {
+	// Lines pasted at random places in the document
+	constexpr int insertions = 2000;
+	const std::string text = Bench::GenerateText(documentLines);
+	CellBuffer cb(true, false);
+	Load(cb, text);
+	const std::string line = "\tposition = document->LineStart(line) + 1;\n";
+	Bench::Random random;
+	run.Time(insertions, [&]() {
+		for (int i = 0; i < insertions; i++) {
+			const Sci::Line lineInsert = random.Below(static_cast<uint32_t>(cb.Lines()));
+			bool startSequence = false;
+			cb.InsertString(cb.LineStart(lineInsert), line.c_str(), line.length(), startSequence);
+		}
+	});
+	Bench::Consume(cb.Lines());
+}
+
+void DeleteRandom(Bench::Run &run) {
+	// Whole lines deleted from random places in the document
+	constexpr int deletions = 2000;
+	const std::string text = Bench::GenerateText(documentLines);
+	CellBuffer cb(true, false);
+	Load(cb, text);
+	Bench::Random random;
+	run.Time(deletions, [&]() {
+		for (int i = 0; i < deletions; i++) {
+			const Sci::Line lineDelete = random.Below(static_cast<uint32_t>(cb.Lines() - 1));
+			const Sci::Position start = cb.LineStart(lineDelete);
+			bool startSequence = false;
+			cb.DeleteChars(start, cb.LineStart(lineDelete + 1) - start, startSequence);
+		}
+	});
+	Bench::Consume(cb.Lines());
+}
+
+void UndoRedo(Bench::Run &run) {
+	// Undo then redo a history of insertions and deletions at random positions which do not coalesce
+	constexpr int edits = 2000;
+	const std::string text = Bench::GenerateText(documentLines);
+	CellBuffer cb(true, false);
+	Load(cb, text);
+	Bench::Random random;
+	for (int i = 0; i < edits; i++) {
+		const Sci::Position position = random.Below(static_cast<uint32_t>(cb.Length() - 10));
+		bool startSequence = false;
+		if (i % 2) {
+			cb.DeleteChars(position, 5, startSequence);
+		} else {
+			cb.InsertString(position, "value", 5, startSequence);
+		}
+	}
+	run.Time(edits * 2, [&]() {
+		while (cb.CanUndo()) {
+			const int steps = cb.StartUndo();
+			for (int step = 0; step < steps; step++) {
+				cb.PerformUndoStep();
+			}
+		}
+		while (cb.CanRedo()) {
+			const int steps = cb.StartRedo();
+			for (int step = 0; step < steps; step++) {
+				cb.PerformRedoStep();
+			}
+		}
+	});
+	Bench::Consume(cb.Length());
+}
+
+const Bench::Registrar registrars[] = {
+	{ "CellBuffer/LoadText", LoadText },
+	{ "CellBuffer/InsertTyping", InsertTyping },
+	{ "CellBuffer/InsertRandom", InsertRandom },
+	{ "CellBuffer/DeleteRandom", DeleteRandom },
+	{ "CellBuffer/UndoRedo", UndoRedo },
+};
+
+}
@@ -0,0 +1,131 @@
+/** @file benchContractionState.cxx
+ ** Benchmarks for ContractionState which maps between document and display lines.
+ **/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "Debugging.h"
+
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "ContractionState.h"
+
+#include "Bench.h"
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+constexpr Sci::Line documentLines = 1000000;
+
+std::unique_ptr<IContractionState> Create() {
+	std::unique_ptr<IContractionState> cs = ContractionStateCreate(false);
+	cs->InsertLines(0, documentLines);
+	return cs;
+}
+
+// Fold away the body of every block of 10 lines
+void FoldBlocks(IContractionState &cs) {
+	for (Sci::Line line = 0; line + 10 <= documentLines; line += 10) {
+		cs.SetExpanded(line, false);
+		cs.SetVisible(line + 1, line + 9, false);
+	}
+}
+
+void InsertLines(Bench::Run &run) {
+	constexpr int insertions = 100000;
+	std::unique_ptr<IContractionState> cs = ContractionStateCreate(false);
+	cs->InsertLines(0, 1);
+	run.Time(insertions, [&]() {
+		for (int i = 0; i < insertions; i++) {
+			cs->InsertLines(cs->LinesInDoc() / 2, 1);
+		}
+	});
+	Bench::Consume(cs->LinesInDoc());
+}
+
+void Fold(Bench::Run &run) {
+	std::unique_ptr<IContractionState> cs = Create();
+	run.Time(documentLines / 10, [&]() {
+		FoldBlocks(*cs);
+	});
+	Bench::Consume(cs->LinesDisplayed());
+}
+
+void Unfold(Bench::Run &run) {
+	std::unique_ptr<IContractionState> cs = Create();
+	FoldBlocks(*cs);
+	run.Time(documentLines / 10, [&]() {
+		for (Sci::Line line = 0; line + 10 <= documentLines; line += 10) {
+			cs->SetExpanded(line, true);
+			cs->SetVisible(line + 1, line + 9, true);
+		}
+	});
+	Bench::Consume(cs->LinesDisplayed());
+}
+
+void DisplayFromDoc(Bench::Run &run) {
+	constexpr int lookups = 1000000;
+	std::unique_ptr<IContractionState> cs = Create();
+	FoldBlocks(*cs);
+	Bench::Random random;
+	run.Time(lookups, [&]() {
+		size_t sum = 0;
+		for (int i = 0; i < lookups; i++) {
+			sum += cs->DisplayFromDoc(random.Below(documentLines));
+		}
+		Bench::Consume(sum);
+	});
+}
+
+void DocFromDisplay(Bench::Run &run) {
+	constexpr int lookups = 1000000;
+	std::unique_ptr<IContractionState> cs = Create();
+	FoldBlocks(*cs);
+	const Sci::Line linesDisplayed = cs->LinesDisplayed();
+	Bench::Random random;
+	run.Time(lookups, [&]() {
+		size_t sum = 0;
+		for (int i = 0; i < lookups; i++) {
+			sum += cs->DocFromDisplay(random.Below(static_cast<uint32_t>(linesDisplayed)));
+		}
+		Bench::Consume(sum);
+	});
+}
+
+void SetHeight(Bench::Run &run) {
+	// Wrapping sets the height of each line in turn
+	std::unique_ptr<IContractionState> cs = Create();
+	Bench::Random random;
+	run.Time(documentLines, [&]() {
+		for (Sci::Line line = 0; line < documentLines; line++) {
+			cs->SetHeight(line, 1 + random.Below(3));
+		}
+	});
+	Bench::Consume(cs->LinesDisplayed());
+}
+
+const Bench::Registrar registrars[] = {
+	{ "ContractionState/InsertLines", InsertLines },
+	{ "ContractionState/Fold", Fold },
+	{ "ContractionState/Unfold", Unfold },
+	{ "ContractionState/DisplayFromDoc", DisplayFromDoc },
+	{ "ContractionState/DocFromDisplay", DocFromDisplay },
+	{ "ContractionState/SetHeight", SetHeight },
+};
+
+}
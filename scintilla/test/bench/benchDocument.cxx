@@ -0,0 +1,190 @@
+/** @file benchDocument.cxx
+ ** Benchmarks for searching and styling a Document.
+ **/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "ScintillaTypes.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+
+#include "Debugging.h"
+
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+
+#include "Bench.h"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+constexpr size_t documentLines = 200000;
+
+// Find every match in the document, returning the number of matches
+size_t FindAll(Document &doc, const char *search, FindOption flags) {
+	size_t matches = 0;
+	Sci::Position position = 0;
+	while (position < doc.Length()) {
+		Sci::Position length = strlen(search);
+		const Sci::Position found = doc.FindText(position, doc.Length(), search, flags, &length);
+		if (found < 0) {
+			break;
+		}
+		matches++;
+		position = found + std::max<Sci::Position>(length, 1);
+	}
+	return matches;
+}
+
+void Find(Bench::Run &run, const char *search, FindOption flags) {
+	const std::string text = Bench::GenerateText(documentLines);
+	Document doc(DocumentOption::Default);
+	doc.InsertString(0, text);
+	doc.SetCaseFolder(std::make_unique<CaseFolderUnicode>());
+	run.Time(text.length(), [&]() {
+		Bench::Consume(FindAll(doc, search, flags));
+	});
+}
+
+void FindLiteral(Bench::Run &run) {
+	// "comment" appears on about 1 line in 8
+	Find(run, "comment", FindOption::MatchCase);
+}
+
+void FindLiteralRare(Bench::Run &run) {
+	// Not present so measures scanning the whole document
+	Find(run, "absent", FindOption::MatchCase);
+}
+
+void FindLiteralCaseInsensitive(Bench::Run &run) {
+	Find(run, "Comment", FindOption::None);
+}
+
+void FindWholeWord(Bench::Run &run) {
+	Find(run, "line", FindOption::MatchCase | FindOption::WholeWord);
+}
+
+void FindRegex(Bench::Run &run) {
+	Find(run, "le[a-z]*th", FindOption::MatchCase | FindOption::RegExp);
+}
+
+void FindRegexCxx11(Bench::Run &run) {
+	Find(run, "le[a-z]*th", FindOption::MatchCase | FindOption::RegExp | FindOption::Cxx11RegEx);
+}
+
+// Style runs as a lexer would produce with run lengths below maxRun
+struct StyleRuns {
+	std::vector<Sci_Position> lengths;
+	std::vector<char> styles;
+};
+
+StyleRuns GenerateRuns(Sci::Position length, uint32_t maxRun) {
+	StyleRuns runs;
+	Bench::Random random;
+	Sci::Position position = 0;
+	while (position < length) {
+		const Sci::Position run = std::min<Sci::Position>(random.Below(maxRun) + 1, length - position);
+		runs.lengths.push_back(run);
+		runs.styles.push_back(static_cast<char>(random.Below(30) + 1));
+		position += run;
+	}
+	return runs;
+}
+
+// Sends runs in pieces covering up to flushSize bytes like LexAccessor
+constexpr Sci::Position flushSize = 4000;
+
+void SetStyles(Bench::Run &run, uint32_t maxRun) {
+	const std::string text = Bench::GenerateText(documentLines);
+	Document doc(DocumentOption::Default);
+	doc.InsertString(0, text);
+	const StyleRuns runs = GenerateRuns(doc.Length(), maxRun);
+	run.Time(text.length(), [&]() {
+		doc.StartStyling(0);
+		std::string styles;
+		for (size_t i = 0; i < runs.lengths.size(); i++) {
+			styles.append(runs.lengths[i], runs.styles[i]);
+			if (static_cast<Sci::Position>(styles.length()) >= flushSize) {
+				doc.SetStyles(styles.length(), styles.c_str());
+				styles.clear();
+			}
+		}
+		doc.SetStyles(styles.length(), styles.c_str());
+	});
+}
+
+void SetStyleRuns(Bench::Run &run, uint32_t maxRun) {
+	const std::string text = Bench::GenerateText(documentLines);
+	Document doc(DocumentOption::Default);
+	doc.InsertString(0, text);
+	const StyleRuns runs = GenerateRuns(doc.Length(), maxRun);
+	run.Time(text.length(), [&]() {
+		doc.StartStyling(0);
+		size_t first = 0;
+		Sci::Position pending = 0;
+		for (size_t i = 0; i < runs.lengths.size(); i++) {
+			pending += runs.lengths[i];
+			if (pending >= flushSize) {
+				doc.SetStyleRuns(i + 1 - first, runs.lengths.data() + first, runs.styles.data() + first);
+				first = i + 1;
+				pending = 0;
+			}
+		}
+		doc.SetStyleRuns(runs.lengths.size() - first, runs.lengths.data() + first, runs.styles.data() + first);
+	});
+}
+
+void SetStylesShortRuns(Bench::Run &run) {
+	SetStyles(run, 12);
+}
+
+void SetStyleRunsShortRuns(Bench::Run &run) {
+	SetStyleRuns(run, 12);
+}
+
+void SetStylesLongRuns(Bench::Run &run) {
+	SetStyles(run, 400);
+}
+
+void SetStyleRunsLongRuns(Bench::Run &run) {
+	SetStyleRuns(run, 400);
+}
+
+const Bench::Registrar registrars[] = {
+	{ "Document/FindLiteral", FindLiteral },
+	{ "Document/FindLiteralRare", FindLiteralRare },
+	{ "Document/FindLiteralCaseInsensitive", FindLiteralCaseInsensitive },
+	{ "Document/FindWholeWord", FindWholeWord },
+	{ "Document/FindRegex", FindRegex },
+	{ "Document/FindRegexCxx11", FindRegexCxx11 },
+	{ "Document/SetStylesShortRuns", SetStylesShortRuns },
+	{ "Document/SetStyleRunsShortRuns", SetStyleRunsShortRuns },
+	{ "Document/SetStylesLongRuns", SetStylesLongRuns },
+	{ "Document/SetStyleRunsLongRuns", SetStyleRunsLongRuns },
+};
+
+}
@@ -0,0 +1,119 @@
+/** @file benchLineLayoutCache.cxx
+ ** Benchmarks for LineLayoutCache.
+ **/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "ScintillaTypes.h"
+#include "ILoader.h"
+#include "ILexer.h"
+
+#include "Debugging.h"
+#include "Geometry.h"
+#include "Platform.h"
+
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "UniqueString.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "Indicator.h"
+#include "LineMarker.h"
+#include "Style.h"
+#include "ViewStyle.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+#include "Selection.h"
+#include "PositionCache.h"
+
+#include "Bench.h"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+constexpr Sci::Line documentLines = 100000;
+constexpr Sci::Line linesOnScreen = 60;
+
+void ScrollPage(Bench::Run &run, LineCache level) {
+	// Scroll down one line at a time retrieving each visible line as painting does
+	constexpr Sci::Line scrolls = 20000;
+	LineLayoutCache llc;
+	llc.SetLevel(level);
+	const Sci::Line lineCaret = linesOnScreen / 2;
+	run.Time(scrolls * linesOnScreen, [&]() {
+		for (Sci::Line top = 0; top < scrolls; top++) {
+			for (Sci::Line line = top; line < top + linesOnScreen; line++) {
+				const int maxChars = 40 + (line % 80);
+				std::shared_ptr<LineLayout> ll = llc.Retrieve(line, lineCaret, maxChars, 1, linesOnScreen, documentLines);
+				Bench::Consume(ll->maxLineLength);
+			}
+		}
+	});
+}
+
+void ScrollLevelPage(Bench::Run &run) {
+	ScrollPage(run, LineCache::Page);
+}
+
+void ScrollLevelDocument(Bench::Run &run) {
+	ScrollPage(run, LineCache::Document);
+}
+
+void RetrieveRandom(Bench::Run &run) {
+	// Jumping around a document that caches every line
+	constexpr int retrievals = 1000000;
+	LineLayoutCache llc;
+	llc.SetLevel(LineCache::Document);
+	Bench::Random random;
+	run.Time(retrievals, [&]() {
+		for (int i = 0; i < retrievals; i++) {
+			const Sci::Line line = random.Below(documentLines);
+			std::shared_ptr<LineLayout> ll = llc.Retrieve(line, 0, 100, 1, linesOnScreen, documentLines);
+			Bench::Consume(ll->maxLineLength);
+		}
+	});
+}
+
+void RestyleDocument(Bench::Run &run) {
+	// Each change of style clock invalidates every cached line
+	constexpr int restyles = 200;
+	LineLayoutCache llc;
+	llc.SetLevel(LineCache::Document);
+	for (Sci::Line line = 0; line < documentLines; line++) {
+		llc.Retrieve(line, 0, 100, 1, linesOnScreen, documentLines);
+	}
+	run.Time(restyles, [&]() {
+		for (int styleClock = 2; styleClock < restyles + 2; styleClock++) {
+			std::shared_ptr<LineLayout> ll = llc.Retrieve(styleClock, 0, 100, styleClock, linesOnScreen, documentLines);
+			Bench::Consume(ll->maxLineLength);
+		}
+	});
+}
+
+const Bench::Registrar registrars[] = {
+	{ "LineLayoutCache/ScrollLevelPage", ScrollLevelPage },
+	{ "LineLayoutCache/ScrollLevelDocument", ScrollLevelDocument },
+	{ "LineLayoutCache/RetrieveRandom", RetrieveRandom },
+	{ "LineLayoutCache/RestyleDocument", RestyleDocument },
+};
+
+}
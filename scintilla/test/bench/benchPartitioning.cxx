@@ -0,0 +1,102 @@
+/** @file benchPartitioning.cxx
+ ** Benchmarks for Partitioning.
+ **/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "Debugging.h"
+
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+
+#include "Bench.h"
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+// Partitions are used for line starts so use a line length that is typical of source code
+constexpr Sci::Position lineLength = 40;
+constexpr Sci::Position partitions = 1000000;
+
+void Fill(Partitioning<Sci::Position> &lines) {
+	// Insert all the text into the first partition then split it as loading a file does
+	lines.InsertText(0, (partitions + 1) * lineLength);
+	for (Sci::Position partition = 1; partition <= partitions; partition++) {
+		lines.InsertPartition(partition, partition * lineLength);
+	}
+}
+
+void InsertPartition(Bench::Run &run) {
+	Partitioning<Sci::Position> lines;
+	run.Time(partitions, [&]() {
+		Fill(lines);
+	});
+	Bench::Consume(lines.Partitions());
+}
+
+void PartitionFromPosition(Bench::Run &run) {
+	constexpr int lookups = 1000000;
+	Partitioning<Sci::Position> lines;
+	Fill(lines);
+	const Sci::Position length = lines.Length();
+	Bench::Random random;
+	run.Time(lookups, [&]() {
+		size_t sum = 0;
+		for (int i = 0; i < lookups; i++) {
+			sum += lines.PartitionFromPosition(random.Below(static_cast<uint32_t>(length)));
+		}
+		Bench::Consume(sum);
+	});
+}
+
+void InsertTextTyping(Bench::Run &run) {
+	// Typing moves forward through the document with a lookup for each character
+	constexpr int insertions = 1000000;
+	Partitioning<Sci::Position> lines;
+	Fill(lines);
+	Sci::Position position = lines.Length() / 2;
+	run.Time(insertions, [&]() {
+		for (int i = 0; i < insertions; i++) {
+			const Sci::Position partition = lines.PartitionFromPosition(position);
+			lines.InsertText(partition, 1);
+			position += (i % 10 == 0) ? lineLength : 1;
+		}
+	});
+	Bench::Consume(lines.Length());
+}
+
+void InsertTextRandom(Bench::Run &run) {
+	// Edits spread through the document force the step to be applied each time
+	constexpr int insertions = 2000;
+	Partitioning<Sci::Position> lines;
+	Fill(lines);
+	Bench::Random random;
+	run.Time(insertions, [&]() {
+		for (int i = 0; i < insertions; i++) {
+			lines.InsertText(random.Below(partitions), 1);
+			Bench::Consume(lines.PositionFromPartition(partitions - 1));
+		}
+	});
+}
+
+const Bench::Registrar registrars[] = {
+	{ "Partitioning/InsertPartition", InsertPartition },
+	{ "Partitioning/PartitionFromPosition", PartitionFromPosition },
+	{ "Partitioning/InsertTextTyping", InsertTextTyping },
+	{ "Partitioning/InsertTextRandom", InsertTextRandom },
+};
+
+}
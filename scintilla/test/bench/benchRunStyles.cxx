@@ -0,0 +1,131 @@
+/** @file benchRunStyles.cxx
+ ** Benchmarks for RunStyles.
+ **/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "Debugging.h"
+
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+
+#include "Bench.h"
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+// RunStyles<Sci::Position, int> is the type used for indicators
+using Runs = RunStyles<Sci::Position, int>;
+
+constexpr Sci::Position documentLength = 10000000;
+constexpr int runs = 20000;
+
+// Mark short ranges through the document as happens when highlighting search matches
+void FillSpread(Runs &rs, Bench::Random &random) {
+	for (int i = 0; i < runs; i++) {
+		rs.FillRange(random.Below(documentLength - 20), 1, 1 + random.Below(20));
+	}
+}
+
+void FillRangeRandom(Bench::Run &run) {
+	Runs rs;
+	rs.InsertSpace(0, documentLength);
+	Bench::Random random;
+	run.Time(runs, [&]() {
+		FillSpread(rs, random);
+	});
+	Bench::Consume(rs.Runs());
+}
+
+void FillRangeSequential(Bench::Run &run) {
+	// Lexer-like pattern of adjacent runs with alternating values
+	constexpr Sci::Position sequentialLength = 1000000;
+	Runs rs;
+	rs.InsertSpace(0, sequentialLength);
+	Bench::Random random;
+	run.Time(sequentialLength, [&]() {
+		Sci::Position position = 0;
+		int value = 0;
+		while (position < sequentialLength) {
+			const Sci::Position lengthRun = std::min<Sci::Position>(1 + random.Below(8), sequentialLength - position);
+			rs.FillRange(position, value, lengthRun);
+			position += lengthRun;
+			value = (value + 1) % 4;
+		}
+	});
+	Bench::Consume(rs.Runs());
+}
+
+void ValueAt(Bench::Run &run) {
+	constexpr int lookups = 1000000;
+	Runs rs;
+	rs.InsertSpace(0, documentLength);
+	Bench::Random random;
+	FillSpread(rs, random);
+	run.Time(lookups, [&]() {
+		size_t sum = 0;
+		for (int i = 0; i < lookups; i++) {
+			sum += rs.ValueAt(random.Below(documentLength));
+		}
+		Bench::Consume(sum);
+	});
+}
+
+void FindNextChange(Bench::Run &run) {
+	// Iterate over all the runs as drawing does
+	Runs rs;
+	rs.InsertSpace(0, documentLength);
+	Bench::Random random;
+	FillSpread(rs, random);
+	run.Time(rs.Runs(), [&]() {
+		size_t sum = 0;
+		for (Sci::Position position = 0; position < documentLength;) {
+			position = rs.FindNextChange(position, documentLength);
+			sum++;
+		}
+		Bench::Consume(sum);
+	});
+}
+
+void InsertDeleteRandom(Bench::Run &run) {
+	constexpr int edits = 20000;
+	Runs rs;
+	rs.InsertSpace(0, documentLength);
+	Bench::Random random;
+	FillSpread(rs, random);
+	run.Time(edits, [&]() {
+		for (int i = 0; i < edits; i++) {
+			const Sci::Position position = random.Below(documentLength - 10);
+			if (i % 2) {
+				rs.DeleteRange(position, 5);
+			} else {
+				rs.InsertSpace(position, 5);
+			}
+		}
+	});
+	Bench::Consume(rs.Runs());
+}
+
+const Bench::Registrar registrars[] = {
+	{ "RunStyles/FillRangeRandom", FillRangeRandom },
+	{ "RunStyles/FillRangeSequential", FillRangeSequential },
+	{ "RunStyles/ValueAt", ValueAt },
+	{ "RunStyles/FindNextChange", FindNextChange },
+	{ "RunStyles/InsertDeleteRandom", InsertDeleteRandom },
+};
+
+}
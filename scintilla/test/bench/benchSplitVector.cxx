@@ -0,0 +1,105 @@
+/** @file benchSplitVector.cxx
+ ** Benchmarks for SplitVector.
+ **/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+
+#include "Debugging.h"
+
+#include "Position.h"
+#include "SplitVector.h"
+
+#include "Bench.h"
+
+using namespace Scintilla::Internal;
+
+namespace {
+
+constexpr int elements = 1000000;
+
+void InsertAppend(Bench::Run &run) {
+	SplitVector<int> sv;
+	run.Time(elements, [&]() {
+		for (int i = 0; i < elements; i++) {
+			sv.Insert(i, i);
+		}
+	});
+	Bench::Consume(sv.Length());
+}
+
+void InsertRandom(Bench::Run &run) {
+	// Each insertion moves the gap so this measures gap movement
+	constexpr int insertions = 5000;
+	SplitVector<int> sv;
+	sv.InsertValue(0, elements, 0);
+	Bench::Random random;
+	run.Time(insertions, [&]() {
+		for (int i = 0; i < insertions; i++) {
+			sv.Insert(random.Below(sv.Length()), i);
+		}
+	});
+	Bench::Consume(sv.Length());
+}
+
+void InsertNearby(Bench::Run &run) {
+	// Typing and small cursor movements keep the gap close to the edit
+	SplitVector<int> sv;
+	sv.InsertValue(0, elements, 0);
+	Bench::Random random;
+	ptrdiff_t position = elements / 2;
+	run.Time(elements, [&]() {
+		for (int i = 0; i < elements; i++) {
+			position = std::clamp<ptrdiff_t>(position + random.Below(9) - 4, 0, sv.Length());
+			sv.Insert(position, i);
+		}
+	});
+	Bench::Consume(sv.Length());
+}
+
+void ReadSequential(Bench::Run &run) {
+	SplitVector<int> sv;
+	sv.InsertValue(0, elements, 1);
+	// Place the gap in the middle so reads cross it
+	sv.Insert(elements / 2, 1);
+	run.Time(sv.Length(), [&]() {
+		size_t sum = 0;
+		for (ptrdiff_t i = 0; i < sv.Length(); i++) {
+			sum += sv.ValueAt(i);
+		}
+		Bench::Consume(sum);
+	});
+}
+
+void DeleteRandom(Bench::Run &run) {
+	constexpr int deletions = 5000;
+	SplitVector<int> sv;
+	sv.InsertValue(0, elements, 0);
+	Bench::Random random;
+	run.Time(deletions, [&]() {
+		for (int i = 0; i < deletions; i++) {
+			sv.Delete(random.Below(sv.Length()));
+		}
+	});
+	Bench::Consume(sv.Length());
+}
+
+const Bench::Registrar registrars[] = {
+	{ "SplitVector/InsertAppend", InsertAppend },
+	{ "SplitVector/InsertRandom", InsertRandom },
+	{ "SplitVector/InsertNearby", InsertNearby },
+	{ "SplitVector/ReadSequential", ReadSequential },
+	{ "SplitVector/DeleteRandom", DeleteRandom },
+};
+
+}
@@ -673,6 +673,27 @@ class TestSimple(unittest.TestCase):
 		self.ed.ReplaceTargetMinimal(len(rep), rep)
 		self.assertEquals(self.ed.Contents(), b"a3cd")
 
+	def testReplaceRanges(self):
+		self.ed.SetContents(b"ab\ncd\nef")
+		self.ed.EmptyUndoBuffer()
+		count = self.ed.ReplaceRangesBytes([(0, 1, b"xyz"), (3, 5, b""), (6, 6, b"-")])
+		self.assertEquals(count, 3)
+		self.assertEquals(self.ed.Contents(), b"xyzb\n\n-ef")
+		self.assertEquals(self.ed.LineCount, 3)
+		self.assertEquals(self.ed.TargetStart, 0)
+		self.assertEquals(self.ed.TargetEnd, 7)
+		# Whole batch is one undo step
+		self.ed.Undo()
+		self.assertEquals(self.ed.Contents(), b"ab\ncd\nef")
+		self.assertEquals(self.ed.CanUndo(), 0)
+		self.ed.Redo()
+		self.assertEquals(self.ed.Contents(), b"xyzb\n\n-ef")
+
+		# Overlapping or unsorted ranges are rejected without change
+		count = self.ed.ReplaceRangesBytes([(2, 4, b"1"), (3, 5, b"2")])
+		self.assertEquals(count, -1)
+		self.assertEquals(self.ed.Contents(), b"xyzb\n\n-ef")
+
 	def testTargetWhole(self):
 		self.ed.SetContents(b"abcd")
 		self.ed.TargetStart = 1
@@ -1318,6 +1339,13 @@ class TestSearch(unittest.TestCase):
 		pos = self.ed.FindBytesFull(0, self.ed.Length, b"big", 0)
 		self.assertEquals(pos, 2)
 
+	def testFindRangeEnd(self):
+		# Matches must not extend past the end of the range
+		self.assertEquals(self.ed.FindBytes(0, 4, b"big", self.ed.SCFIND_MATCHCASE), -1)
+		self.assertEquals(self.ed.FindBytes(0, 5, b"big", self.ed.SCFIND_MATCHCASE), 2)
+		self.assertEquals(self.ed.FindBytes(0, 4, b"BIG", 0), -1)
+		self.assertEquals(self.ed.FindBytes(0, 5, b"BIG", 0), 2)
+
 	def testFindEmpty(self):
 		pos = self.ed.FindBytes(0, self.ed.Length, b"", 0)
 		self.assertEquals(pos, 0)
@@ -1380,6 +1408,27 @@ class TestSearch(unittest.TestCase):
 		self.assertEquals(10, self.ed.FindBytes(0, self.ed.Length, b"\t$", flags))
 		self.assertEquals(0, self.ed.FindBytes(0, self.ed.Length, b"([a]).*\0", flags))
 
+	def testRERepeated(self):
+		# Compiled expressions are reused so check that changed options and word characters are seen
+		flags = self.ed.SCFIND_REGEXP
+		self.assertEquals(2, self.ed.FindBytes(0, self.ed.Length, b"B.G", flags))
+		self.assertEquals(-1, self.ed.FindBytes(0, self.ed.Length, b"B.G",
+			flags | self.ed.SCFIND_MATCHCASE))
+		self.assertEquals(2, self.ed.FindBytes(0, self.ed.Length, b"B.G", flags))
+		self.assertEquals(2, self.ed.FindBytes(0, self.ed.Length, b"\<b", flags))
+		self.ed.SetWordChars(0, b"abcdefghijklmnopqrstuvwxyz\t")
+		self.assertEquals(6, self.ed.FindBytes(0, self.ed.Length, b"\<b", flags))
+		self.ed.SetCharsDefault()
+		self.assertEquals(2, self.ed.FindBytes(0, self.ed.Length, b"\<b", flags))
+
+	def testCxx11RERepeated(self):
+		flags = self.ed.SCFIND_REGEXP | self.ed.SCFIND_CXX11REGEX
+		self.assertEquals(2, self.ed.FindBytes(0, self.ed.Length, b"B.G", flags))
+		self.assertEquals(-1, self.ed.FindBytes(0, self.ed.Length, b"B.G",
+			flags | self.ed.SCFIND_MATCHCASE))
+		self.assertEquals(2, self.ed.FindBytes(0, self.ed.Length, b"B.G", flags))
+		self.assertEquals(6, self.ed.FindBytes(3, self.ed.Length, b"B.A", flags))
+
 	def testCxx11RETooMany(self):
 		# For bug #2281
 		self.ed.InsertText(0, b"3ringsForTheElvenKing")
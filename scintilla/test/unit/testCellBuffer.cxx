@@ -6,6 +6,7 @@
 #include <cassert>
 #include <cstring>
 #include <stdexcept>
+#include <string>
 #include <string_view>
 #include <vector>
 #include <optional>
@@ -31,6 +32,20 @@ using namespace Scintilla::Internal;
 
 // Test CellBuffer.
 
+void UndoBlock(CellBuffer &cb) {
+	const int steps = cb.StartUndo();
+	for (int step = 0; step < steps; step++) {
+		cb.PerformUndoStep();
+	}
+}
+
+void RedoBlock(CellBuffer &cb) {
+	const int steps = cb.StartRedo();
+	for (int step = 0; step < steps; step++) {
+		cb.PerformRedoStep();
+	}
+}
+
 TEST_CASE("CellBuffer") {
 
 	const char sText[] = "Scintilla";
@@ -136,6 +151,88 @@ TEST_CASE("CellBuffer") {
 		REQUIRE(!cb.CanRedo());
 	}
 
+	SECTION("UndoArena") {
+		// Operations larger than an arena block and operations that truncate redo text
+		const std::string sLarge(UndoArena::blockSize + 10, 'L');
+		const std::string sSmall(100, 's');
+		bool startSequence = false;
+		for (int i = 0; i < 3; i++) {
+			cb.BeginUndoAction();
+			cb.InsertString(cb.Length(), sSmall.c_str(), sSmall.length(), startSequence);
+			cb.EndUndoAction();
+		}
+		cb.BeginUndoAction();
+		const char *cpChange = cb.InsertString(0, sLarge.c_str(), sLarge.length(), startSequence);
+		REQUIRE(memcmp(cpChange, sLarge.c_str(), sLarge.length()) == 0);
+		cb.EndUndoAction();
+		cb.BeginUndoAction();
+		cb.DeleteChars(0, 50, startSequence);
+		cb.EndUndoAction();
+		REQUIRE(cb.Length() == static_cast<Sci::Position>(sLarge.length() + 3 * sSmall.length() - 50));
+
+		UndoBlock(cb);
+		UndoBlock(cb);
+		REQUIRE(cb.Length() == static_cast<Sci::Position>(3 * sSmall.length()));
+		RedoBlock(cb);
+		REQUIRE(cb.Length() == static_cast<Sci::Position>(sLarge.length() + 3 * sSmall.length()));
+		REQUIRE(cb.CanRedo());
+
+		// Replaces the deletion that could have been redone
+		cb.BeginUndoAction();
+		cb.InsertString(0, "[]", 2, startSequence);
+		cb.EndUndoAction();
+		REQUIRE(!cb.CanRedo());
+		REQUIRE(cb.CharAt(0) == '[');
+		UndoBlock(cb);
+		UndoBlock(cb);
+		REQUIRE(cb.Length() == static_cast<Sci::Position>(3 * sSmall.length()));
+		REQUIRE(cb.CharAt(0) == 's');
+		UndoBlock(cb);
+		UndoBlock(cb);
+		UndoBlock(cb);
+		REQUIRE(cb.Length() == 0);
+		REQUIRE(!cb.CanUndo());
+		for (int i = 0; i < 5; i++) {
+			RedoBlock(cb);
+		}
+		REQUIRE(!cb.CanRedo());
+		REQUIRE(cb.Length() == static_cast<Sci::Position>(sLarge.length() + 3 * sSmall.length() + 2));
+		REQUIRE(cb.UndoMemoryUsed() > sLarge.length());
+	}
+
+	SECTION("UndoMemoryLimit") {
+		const std::string sChunk(1000, 'c');
+		constexpr int operations = 100;
+		constexpr size_t limit = 20000;
+		cb.SetUndoMemoryLimit(limit);
+		REQUIRE(cb.UndoMemoryLimit() == limit);
+		bool startSequence = false;
+		for (int i = 0; i < operations; i++) {
+			cb.BeginUndoAction();
+			cb.InsertString(cb.Length(), sChunk.c_str(), sChunk.length(), startSequence);
+			cb.EndUndoAction();
+		}
+		REQUIRE(cb.Length() == static_cast<Sci::Position>(operations * sChunk.length()));
+		// Oldest operations discarded but the most recent can be undone and redone
+		int undone = 0;
+		while (cb.CanUndo()) {
+			UndoBlock(cb);
+			undone++;
+		}
+		REQUIRE(undone > 0);
+		REQUIRE(undone < operations);
+		REQUIRE(static_cast<size_t>(undone) * sChunk.length() < limit);
+		REQUIRE(cb.Length() == static_cast<Sci::Position>((operations - undone) * sChunk.length()));
+		REQUIRE(!cb.IsSavePoint());
+		while (cb.CanRedo()) {
+			RedoBlock(cb);
+		}
+		REQUIRE(cb.Length() == static_cast<Sci::Position>(operations * sChunk.length()));
+
+		cb.DeleteUndoHistory();
+		REQUIRE(cb.UndoMemoryUsed() < limit);
+	}
+
 	SECTION("LineEndTypes") {
 		REQUIRE(cb.GetLineEndTypes() == LineEndType::Default);
 		cb.SetLineEndTypes(LineEndType::Unicode);
@@ -155,6 +252,58 @@ TEST_CASE("CellBuffer") {
 
 }
 
+TEST_CASE("LazyStyles") {
+
+	const char sText[] = "Scintilla";
+	const Sci::Position sLength = static_cast<Sci::Position>(strlen(sText));
+
+	CellBuffer cb(true, false, true);
+	bool startSequence = false;
+	cb.InsertString(0, sText, sLength, startSequence);
+
+	SECTION("Unstyled") {
+		REQUIRE(cb.HasLazyStyles());
+		REQUIRE(0 == cb.StylesAllocated());
+		REQUIRE(0 == cb.StyleAt(3));
+		// Setting style 0 does not allocate
+		REQUIRE(!cb.SetStyleFor(0, sLength, 0));
+		REQUIRE(!cb.SetStyleAt(4, 0));
+		REQUIRE(0 == cb.StylesAllocated());
+	}
+
+	SECTION("Styled") {
+		REQUIRE(cb.SetStyleFor(2, 3, 5));
+		REQUIRE(5 == cb.StylesAllocated());
+		REQUIRE(0 == cb.StyleAt(1));
+		REQUIRE(5 == cb.StyleAt(4));
+		REQUIRE(0 == cb.StyleAt(5));
+		REQUIRE(cb.SetStyleAt(6, 7));
+		REQUIRE(7 == cb.StylesAllocated());
+		unsigned char styles[9] {};
+		cb.GetStyleRange(styles, 0, sLength);
+		const unsigned char expected[9] = { 0, 0, 5, 5, 5, 0, 7, 0, 0 };
+		REQUIRE(memcmp(styles, expected, sizeof(styles)) == 0);
+	}
+
+	SECTION("Modification") {
+		cb.SetStyleFor(0, 4, 1);
+		REQUIRE(4 == cb.StylesAllocated());
+		// Insertion after styled text does not allocate
+		cb.InsertString(6, "ab", 2, startSequence);
+		REQUIRE(4 == cb.StylesAllocated());
+		// Insertion inside styled text does
+		cb.InsertString(2, "cd", 2, startSequence);
+		REQUIRE(6 == cb.StylesAllocated());
+		REQUIRE(0 == cb.StyleAt(2));
+		REQUIRE(1 == cb.StyleAt(4));
+		// Deletion across end of styled text
+		cb.DeleteChars(5, 3, startSequence);
+		REQUIRE(5 == cb.StylesAllocated());
+		REQUIRE(1 == cb.StyleAt(4));
+		REQUIRE(0 == cb.StyleAt(5));
+	}
+}
+
 TEST_CASE("CharacterIndex") {
 
 	CellBuffer cb(true, false);
@@ -743,20 +892,6 @@ History HistoryOf(const CellBuffer &cb) {
 	return { HistoryInsertions(cb), HistoryDeletions(cb) };
 }
 
-void UndoBlock(CellBuffer &cb) {
-	const int steps = cb.StartUndo();
-	for (int step = 0; step < steps; step++) {
-		cb.PerformUndoStep();
-	}
-}
-
-void RedoBlock(CellBuffer &cb) {
-	const int steps = cb.StartRedo();
-	for (int step = 0; step < steps; step++) {
-		cb.PerformRedoStep();
-	}
-}
-
 TEST_CASE("CellBufferWithChangeHistory") {
 
 	SECTION("StraightUndoRedoSaveRevertRedo") {
@@ -1018,4 +1153,56 @@ TEST_CASE("CellBufferLong") {
 		}
 	}
 }
-#endif
\ No newline at end of file
+#endif
+TEST_CASE("CellBufferLargeInsert") {
+
+	// Large insertions find line ends on multiple threads so check that they match
+	// the line starts found by a simple scan over each byte.
+
+	RandomSequence rseq;
+	std::string text;
+	const std::string_view pieces[] = { "\r", "\n", "\r\n", "\xe2\x80\xa8", "\xc2\x85", "\xe2\x82\xac", "abcdefghijklmnopqrstuvwxyz" };
+	while (text.length() < 10'000'000) {
+		text.append(pieces[rseq.Next() % std::size(pieces)]);
+	}
+	const Sci::Position length = static_cast<Sci::Position>(text.length());
+
+	for (const LineEndType lineEndType : { LineEndType::Default, LineEndType::Unicode }) {
+		std::vector<Sci::Position> lineStarts { 0 };
+		for (Sci::Position position = 0; position < length; position++) {
+			const std::string_view rest = std::string_view(text).substr(position);
+			if (rest[0] == '\r') {
+				if ((rest.length() > 1) && (rest[1] == '\n')) {
+					position++;
+				}
+				lineStarts.push_back(position + 1);
+			} else if (rest[0] == '\n') {
+				lineStarts.push_back(position + 1);
+			} else if (lineEndType == LineEndType::Unicode) {
+				if ((rest.substr(0, 3) == "\xe2\x80\xa8") || (rest.substr(0, 3) == "\xe2\x80\xa9")) {
+					position += 2;
+					lineStarts.push_back(position + 1);
+				} else if (rest.substr(0, 2) == "\xc2\x85") {
+					position++;
+					lineStarts.push_back(position + 1);
+				}
+			}
+		}
+
+		CellBuffer cbLarge(true, false);
+		cbLarge.SetUTF8Substance(true);
+		cbLarge.SetLineEndTypes(lineEndType);
+		bool startSequence = false;
+		cbLarge.InsertString(0, text.c_str(), length, startSequence);
+		REQUIRE(cbLarge.Lines() == static_cast<Sci::Line>(lineStarts.size()));
+		Sci::Line lineDifferent = -1;
+		for (Sci::Line line = 0; line < cbLarge.Lines(); line++) {
+			if (cbLarge.LineStart(line) != lineStarts[line]) {
+				lineDifferent = line;
+				break;
+			}
+		}
+		REQUIRE(lineDifferent == -1);
+		REQUIRE(cbLarge.LineStart(cbLarge.Lines()) == length);
+	}
+}
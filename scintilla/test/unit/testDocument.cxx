@@ -0,0 +1,378 @@
+/** @file testDocument.cxx
+ ** Unit Tests for Scintilla internal data structures
+ **/
+
+#include <cstddef>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <chrono>
+
+#include "ScintillaTypes.h"
+
+#include "ILoader.h"
+#include "ILexer.h"
+
+#include "Debugging.h"
+
+#include "CharacterCategoryMap.h"
+#include "Position.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+
+#include "catch.hpp"
+
+using namespace Scintilla;
+using namespace Scintilla::Internal;
+
+namespace {
+
+// Implement low quality reproducible pseudo-random numbers.
+// Pseudo-random algorithm based on R. G. Dromey "How to Solve it by Computer" page 122.
+
+class RandomSequence {
+	static constexpr int mult = 109;
+	static constexpr int incr = 853;
+	static constexpr int modulus = 4096;
+	int randomValue = 127;
+public:
+	int Next() noexcept {
+		randomValue = (mult * randomValue + incr) % modulus;
+		return randomValue;
+	}
+	// Values up to modulus * modulus for positions in longer documents
+	Sci::Position Below(Sci::Position limit) noexcept {
+		const Sci::Position value = static_cast<Sci::Position>(Next()) * modulus + Next();
+		return (limit > 0) ? value % limit : 0;
+	}
+};
+
+// A lexer where each line depends on the lines before it: /* */ comments continue over
+// lines through the style of the line end and braces set line states and fold levels.
+class LexerComments final : public ILexer5 {
+public:
+	static constexpr int styleDefault = 0;
+	static constexpr int styleComment = 1;
+	static constexpr int styleBrace = 2;
+
+	int SCI_METHOD Version() const override {
+		return lvRelease5;
+	}
+	void SCI_METHOD Release() override {
+		delete this;
+	}
+	const char * SCI_METHOD PropertyNames() override {
+		return "";
+	}
+	int SCI_METHOD PropertyType(const char *) override {
+		return 0;
+	}
+	const char * SCI_METHOD DescribeProperty(const char *) override {
+		return "";
+	}
+	Sci_Position SCI_METHOD PropertySet(const char *, const char *) override {
+		return -1;
+	}
+	const char * SCI_METHOD DescribeWordListSets() override {
+		return "";
+	}
+	Sci_Position SCI_METHOD WordListSet(int, const char *) override {
+		return -1;
+	}
+	void SCI_METHOD Lex(Sci_PositionU startPos, Sci_Position lengthDoc, int initStyle, IDocument *pAccess) override {
+		const Sci_Position endPos = startPos + lengthDoc;
+		std::string text(lengthDoc, '\0');
+		pAccess->GetCharRange(text.data(), startPos, lengthDoc);
+		std::string styles(lengthDoc, '\0');
+		Sci_Position line = pAccess->LineFromPosition(startPos);
+		// A comment continues from the style before the range and the line state holds the brace depth
+		bool comment = initStyle == styleComment;
+		int depth = (line > 0) ? pAccess->GetLineState(line - 1) : 0;
+		Sci_Position position = startPos;
+		while (position < endPos) {
+			const Sci_Position lineEnd = std::min(pAccess->LineStart(line + 1), endPos);
+			const int depthStart = depth;
+			for (; position < lineEnd; position++) {
+				const char ch = text[position - startPos];
+				const char chNext = (position + 1 < endPos) ? text[position + 1 - startPos] : '\0';
+				char style = styleDefault;
+				if (comment) {
+					style = styleComment;
+					if ((ch == '*') && (chNext == '/') && (position + 1 < lineEnd)) {
+						styles[position + 1 - startPos] = styleComment;
+						position++;
+						comment = false;
+					}
+				} else if ((ch == '/') && (chNext == '*') && (position + 1 < lineEnd)) {
+					style = styleComment;
+					styles[position + 1 - startPos] = styleComment;
+					position++;
+					comment = true;
+				} else if (ch == '{') {
+					style = styleBrace;
+					depth++;
+				} else if ((ch == '}') && (depth > 0)) {
+					style = styleBrace;
+					depth--;
+				}
+				styles[position - startPos] = style;
+			}
+			pAccess->SetLineState(line, depth);
+			const int header = (depth > depthStart) ? static_cast<int>(FoldLevel::HeaderFlag) : 0;
+			pAccess->SetLevel(line, (static_cast<int>(FoldLevel::Base) + depthStart) | header);
+			line++;
+		}
+		pAccess->StartStyling(startPos);
+		pAccess->SetStyles(lengthDoc, styles.data());
+	}
+	void SCI_METHOD Fold(Sci_PositionU, Sci_Position, int, IDocument *) override {
+	}
+	void * SCI_METHOD PrivateCall(int, void *) override {
+		return nullptr;
+	}
+	int SCI_METHOD LineEndTypesSupported() override {
+		return static_cast<int>(LineEndType::Default);
+	}
+	int SCI_METHOD AllocateSubStyles(int, int) override {
+		return -1;
+	}
+	int SCI_METHOD SubStylesStart(int) override {
+		return -1;
+	}
+	int SCI_METHOD SubStylesLength(int) override {
+		return 0;
+	}
+	int SCI_METHOD StyleFromSubStyle(int subStyle) override {
+		return subStyle;
+	}
+	int SCI_METHOD PrimaryStyleFromStyle(int style) override {
+		return style;
+	}
+	void SCI_METHOD FreeSubStyles() override {
+	}
+	void SCI_METHOD SetIdentifiers(int, const char *) override {
+	}
+	int SCI_METHOD DistanceToSecondaryStyles() override {
+		return 0;
+	}
+	const char * SCI_METHOD GetSubStyleBases() override {
+		return "";
+	}
+	int SCI_METHOD NamedStyles() override {
+		return 0;
+	}
+	const char * SCI_METHOD NameOfStyle(int) override {
+		return "";
+	}
+	const char * SCI_METHOD TagsOfStyle(int) override {
+		return "";
+	}
+	const char * SCI_METHOD DescriptionOfStyle(int) override {
+		return "";
+	}
+	const char * SCI_METHOD GetName() override {
+		return "comments";
+	}
+	int SCI_METHOD GetIdentifier() override {
+		return 0;
+	}
+	const char * SCI_METHOD PropertyGet(const char *) override {
+		return "";
+	}
+};
+
+void SetUpDocument(Document &doc, std::string_view text) {
+	doc.SetDBCSCodePage(CpUtf8);
+	doc.InsertString(0, text);
+	doc.SetLexInterface(std::make_unique<LexInterface>(&doc));
+	doc.GetLexInterface()->SetInstance(new LexerComments());
+}
+
+// Style the whole document with background passes as an application does when idle.
+void StyleAllInBackground(Document &doc) {
+	int attempts = 0;
+	while (doc.GetEndStyled() < doc.Length()) {
+		if (doc.StyleInBackground(doc.Length())) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		} else {
+			doc.EnsureStyledTo(doc.Length());
+		}
+		attempts++;
+		REQUIRE(attempts < 100000);
+	}
+}
+
+// Doubles each insertion as an application may do from an insert check notification.
+class WatcherDoubling final : public DocWatcher {
+public:
+	void NotifyModifyAttempt(Document *, void *) override {
+	}
+	void NotifySavePoint(Document *, void *, bool) override {
+	}
+	void NotifyModified(Document *doc, DocModification mh, void *) override {
+		if (FlagSet(mh.modificationType, ModificationFlags::InsertCheck)) {
+			const std::string doubled = std::string(mh.text, mh.length) + std::string(mh.text, mh.length);
+			doc->ChangeInsertion(doubled.c_str(), doubled.length());
+		}
+	}
+	void NotifyDeleted(Document *, void *) noexcept override {
+	}
+	void NotifyStyleNeeded(Document *, void *, Sci::Position) override {
+	}
+	void NotifyErrorOccurred(Document *, void *, Status) override {
+	}
+};
+
+// Returns the first position or line that differs or -1 when the same.
+Sci::Position StyleDifference(const Document &a, const Document &b) {
+	for (Sci::Position position = 0; position < a.Length(); position++) {
+		if (a.StyleAt(position) != b.StyleAt(position)) {
+			return position;
+		}
+	}
+	return -1;
+}
+
+// The empty line after a final line end is not lexed so keeps older values.
+Sci::Line LineDifference(const Document &a, const Document &b) {
+	for (Sci::Line line = 0; (line < a.LinesTotal()) && (a.LineStart(line) < a.Length()); line++) {
+		if ((a.GetLevel(line) != b.GetLevel(line)) || (a.GetLineState(line) != b.GetLineState(line))) {
+			return line;
+		}
+	}
+	return -1;
+}
+
+}
+
+// Test Document.
+
+TEST_CASE("DocumentBackgroundLexing") {
+
+	// Background lexing reads a snapshot made of blocks that are only copied again when
+	// modified so check it matches lexing on the main thread over many edits.
+
+	RandomSequence rseq;
+	const std::string_view pieces[] = { "int x = 1;\n", "/* comment\n", "*/\n", "{\n", "}\n",
+		"text\r\n", "a\rb\n", "\xc3\xa9", "\n", "  {/* } */\n" };
+	std::string text;
+	while (text.length() < 300'000) {
+		text.append(pieces[rseq.Next() % std::size(pieces)]);
+	}
+
+	Document docBackground(DocumentOption::Default);
+	Document docDirect(DocumentOption::Default);
+	SetUpDocument(docBackground, text);
+	SetUpDocument(docDirect, text);
+
+	StyleAllInBackground(docBackground);
+	docDirect.EnsureStyledTo(docDirect.Length());
+	REQUIRE(StyleDifference(docBackground, docDirect) == -1);
+	REQUIRE(LineDifference(docBackground, docDirect) == -1);
+
+	for (int edit = 0; edit < 120; edit++) {
+		const Sci::Position position = docBackground.MovePositionOutsideChar(
+			rseq.Below(docBackground.Length() + 1), 1, false);
+		const int kind = rseq.Next() % 6;
+		if ((kind <= 1) && (docBackground.Length() > 0)) {
+			const Sci::Position end = docBackground.MovePositionOutsideChar(
+				std::min(position + rseq.Below(5'000) + 1, docBackground.Length()), 1, false);
+			docBackground.DeleteChars(position, end - position);
+			docDirect.DeleteChars(position, end - position);
+		} else if (kind == 2) {
+			docBackground.Undo();
+			docDirect.Undo();
+		} else {
+			std::string insertion;
+			const int count = (kind == 3) ? 1 : rseq.Next() % 2000 + 1;
+			for (int piece = 0; piece < count; piece++) {
+				insertion.append(pieces[rseq.Next() % std::size(pieces)]);
+			}
+			docBackground.InsertString(position, insertion);
+			docDirect.InsertString(position, insertion);
+		}
+		const int after = rseq.Next() % 4;
+		if (after == 0) {
+			// Leave a pass that has published some of its chunks to be stopped by the next edit
+			docBackground.StyleInBackground(docBackground.Length());
+			std::this_thread::sleep_for(std::chrono::milliseconds(rseq.Next() % 4));
+			docBackground.StyleInBackground(docBackground.Length());
+		} else if (after == 1) {
+			// Style part of the document directly as painting does
+			docBackground.EnsureStyledTo(rseq.Below(docBackground.Length() + 1));
+		}
+		if (edit % 3 == 0) {
+			StyleAllInBackground(docBackground);
+			docDirect.EnsureStyledTo(docDirect.Length());
+			REQUIRE(docBackground.Length() == docDirect.Length());
+			REQUIRE(StyleDifference(docBackground, docDirect) == -1);
+			REQUIRE(LineDifference(docBackground, docDirect) == -1);
+		}
+	}
+}
+
+TEST_CASE("DocumentBackgroundLexingStyles") {
+
+	// Opening a comment only changes styles so the blocks styled directly must be copied
+	// again for the pass that continues after them.
+
+	std::string text;
+	while (text.length() < 300'000) {
+		text.append("text\n");
+	}
+
+	Document docBackground(DocumentOption::Default);
+	Document docDirect(DocumentOption::Default);
+	SetUpDocument(docBackground, text);
+	SetUpDocument(docDirect, text);
+	StyleAllInBackground(docBackground);
+
+	docBackground.InsertString(0, "/*");
+	docDirect.InsertString(0, "/*");
+	docBackground.EnsureStyledTo(200'000);
+	StyleAllInBackground(docBackground);
+	docDirect.EnsureStyledTo(docDirect.Length());
+	REQUIRE(StyleDifference(docBackground, docDirect) == -1);
+	REQUIRE(LineDifference(docBackground, docDirect) == -1);
+}
+
+TEST_CASE("DocumentReplaceRanges") {
+
+	Document doc(DocumentOption::Default);
+	doc.InsertString(0, "abcdefgh");
+
+	SECTION("End") {
+		const std::vector<RangeReplacement> replacements = { { Range(0, 1), "xyz" }, { Range(3, 5), "" } };
+		Sci::Position positionEnd = -1;
+		REQUIRE(doc.ReplaceRanges(replacements, &positionEnd) == 2);
+		REQUIRE(doc.Length() == 8);
+		REQUIRE(positionEnd == 5);
+	}
+
+	SECTION("ChangedInsertion") {
+		// The end follows the text actually inserted, not the text requested
+		WatcherDoubling watcher;
+		doc.AddWatcher(&watcher, nullptr);
+		const std::vector<RangeReplacement> replacements = { { Range(1, 2), "12" }, { Range(4, 4), "3" } };
+		Sci::Position positionEnd = -1;
+		REQUIRE(doc.ReplaceRanges(replacements, &positionEnd) == 2);
+		doc.RemoveWatcher(&watcher, nullptr);
+		std::string text(doc.Length(), '\0');
+		doc.GetCharRange(text.data(), 0, doc.Length());
+		REQUIRE(text == "a1212cd33efgh");
+		REQUIRE(positionEnd == 9);
+	}
+}
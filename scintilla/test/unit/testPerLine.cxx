@@ -266,6 +266,16 @@ TEST_CASE("LineState") {
 		REQUIRE(1 == ls.GetMaxLineState());
 	}
 
+	SECTION("ValueAt") {
+		REQUIRE(0 == ls.ValueAt(0));
+		REQUIRE(0 == ls.SetLineState(1, 200, 2));
+		REQUIRE(200 == ls.ValueAt(1));
+		REQUIRE(0 == ls.ValueAt(-1));
+		REQUIRE(0 == ls.ValueAt(5));
+		// ValueAt does not expand
+		REQUIRE(3 == ls.GetMaxLineState());
+	}
+
 	SECTION("InsertRemoveLine") {
 		REQUIRE(0 == ls.GetMaxLineState());
 		ls.SetLineState(1, 1, 3);
@@ -371,6 +371,46 @@ TEST_CASE("SplitVector") {
 		REQUIRE(lengthAfterInsertion == sv.GapPosition());
 	}
 
+	SECTION("ContiguousRangePointer") {
+		sv.InsertFromArray(0, testArray, 0, lengthTestArray);
+		sv.Insert(2, 99);
+		REQUIRE(3 == sv.GapPosition());
+		// Before the gap
+		const int *before = sv.ContiguousRangePointer(0, 3);
+		REQUIRE(before);
+		REQUIRE(3 == before[0]);
+		REQUIRE(99 == before[2]);
+		// After the gap
+		const int *after = sv.ContiguousRangePointer(3, sv.Length() - 3);
+		REQUIRE(after);
+		for (int i=3; i<sv.Length(); i++) {
+			REQUIRE((i+3-1) == after[i-3]);
+		}
+		// Spanning the gap is not contiguous and the gap does not move
+		REQUIRE(!sv.ContiguousRangePointer(1, 4));
+		REQUIRE(3 == sv.GapPosition());
+	}
+
+	SECTION("FillRange") {
+		sv.InsertValue(0, 10, 0);
+		sv.Insert(4, 1);
+		REQUIRE(5 == sv.GapPosition());
+		// Spanning the gap
+		REQUIRE(sv.FillRange(2, 7, 6));
+		REQUIRE(5 == sv.GapPosition());
+		for (int i=0; i<sv.Length(); i++) {
+			REQUIRE(((i>=2 && i<8) ? 7 : 0) == sv.ValueAt(i));
+		}
+		// Unchanged
+		REQUIRE(!sv.FillRange(3, 7, 4));
+		REQUIRE(!sv.FillRange(0, 0, 0));
+		// Only after the gap
+		REQUIRE(sv.FillRange(6, 3, 3));
+		REQUIRE(7 == sv.ValueAt(5));
+		REQUIRE(3 == sv.ValueAt(8));
+		REQUIRE(0 == sv.ValueAt(9));
+	}
+
 	SECTION("DeleteBackAndForth") {
 		sv.InsertValue(0, 10, 87);
 		for (int i=0; i<10; i+=2) {
@@ -4,6 +4,7 @@
 
 #include <cstring>
 
+#include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -15,6 +16,7 @@
 
 #include "UniConversion.h"
 
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "catch.hpp"
 
 using namespace Scintilla::Internal;
@@ -359,3 +361,184 @@ TEST_CASE("UTF8Classify") {
 		REQUIRE(UTFClass("\xF0\x9F\x9Fq") == (1 | UTF8MaskInvalid));
 	}
 }
+
+namespace {
+
+// The scalar implementations that preceded the ASCII fast path are kept here
+// to check the faster code gives the same results and to benchmark against.
+
+size_t UTF16LengthScalar(std::string_view svu8) noexcept {
+	size_t ulen = 0;
+	for (size_t i = 0; i < svu8.length();) {
+		const unsigned char ch = svu8[i];
+		const unsigned int byteCount = UTF8BytesOfLead[ch];
+		const unsigned int utf16Len = UTF16LengthFromUTF8ByteCount(byteCount);
+		i += byteCount;
+		ulen += (i > svu8.length()) ? 1 : utf16Len;
+	}
+	return ulen;
+}
+
+size_t UTF16FromUTF8Scalar(std::string_view svu8, wchar_t *tbuf, size_t tlen) {
+	size_t ui = 0;
+	for (size_t i = 0; i < svu8.length();) {
+		unsigned char ch = svu8[i];
+		const unsigned int byteCount = UTF8BytesOfLead[ch];
+		unsigned int value;
+
+		if (i + byteCount > svu8.length()) {
+			// Trying to read past end but still have space to write
+			if (ui < tlen) {
+				tbuf[ui] = ch;
+				ui++;
+			}
+			break;
+		}
+
+		const size_t outLen = UTF16LengthFromUTF8ByteCount(byteCount);
+		if (ui + outLen > tlen) {
+			throw std::runtime_error("UTF16FromUTF8Scalar: attempted write beyond end");
+		}
+
+		i++;
+		switch (byteCount) {
+		case 1:
+			tbuf[ui] = ch;
+			break;
+		case 2:
+			value = (ch & 0x1F) << 6;
+			ch = svu8[i++];
+			value += ch & 0x3F;
+			tbuf[ui] = static_cast<wchar_t>(value);
+			break;
+		case 3:
+			value = (ch & 0xF) << 12;
+			ch = svu8[i++];
+			value += (ch & 0x3F) << 6;
+			ch = svu8[i++];
+			value += ch & 0x3F;
+			tbuf[ui] = static_cast<wchar_t>(value);
+			break;
+		default:
+			value = (ch & 0x7) << 18;
+			ch = svu8[i++];
+			value += (ch & 0x3F) << 12;
+			ch = svu8[i++];
+			value += (ch & 0x3F) << 6;
+			ch = svu8[i++];
+			value += ch & 0x3F;
+			tbuf[ui] = static_cast<wchar_t>(((value - 0x10000) >> 10) + SURROGATE_LEAD_FIRST);
+			ui++;
+			tbuf[ui] = static_cast<wchar_t>((value & 0x3ff) + SURROGATE_TRAIL_FIRST);
+			break;
+		}
+		ui++;
+	}
+	return ui;
+}
+
+bool UTF8IsValidScalar(std::string_view svu8) noexcept {
+	const unsigned char *us = reinterpret_cast<const unsigned char *>(svu8.data());
+	size_t remaining = svu8.length();
+	while (remaining > 0) {
+		const int utf8Status = UTF8Classify(us, remaining);
+		if (utf8Status & UTF8MaskInvalid) {
+			return false;
+		}
+		const int lenChar = utf8Status & UTF8MaskWidth;
+		us += lenChar;
+		remaining -= lenChar;
+	}
+	return true;
+}
+
+// Reproducible text made of lines of ASCII with a proportion of non-ASCII characters
+std::string GenerateText(size_t length, int percentNonAscii) {
+	const char *const nonAscii[] = { "\xC2\xA2", "\xE2\x82\xAC", "\xF0\x90\x8D\x88", "\xE4\xB8\xAD" };
+	std::string text;
+	unsigned int seed = 1;
+	while (text.length() < length) {
+		seed = seed * 1103515245 + 12345;
+		const unsigned int r = (seed >> 16) & 0x7fff;
+		if (static_cast<int>(r % 100) < percentNonAscii) {
+			text.append(nonAscii[r % 4]);
+		} else if (r % 61 == 0) {
+			text.append("\n");
+		} else {
+			text.push_back(static_cast<char>(' ' + r % 95));
+		}
+	}
+	return text;
+}
+
+}
+
+TEST_CASE("UTF8AsciiPrefixLength") {
+
+	SECTION("Empty") {
+		REQUIRE(UTF8AsciiPrefixLength("") == 0);
+	}
+
+	SECTION("Every position of a non-ASCII byte") {
+		// Cover the block sizes of each implementation and their tails
+		for (size_t length = 1; length <= 80; length++) {
+			std::string text(length, 'a');
+			REQUIRE(UTF8AsciiPrefixLength(text) == length);
+			for (size_t position = 0; position < length; position++) {
+				text[position] = '\x80';
+				REQUIRE(UTF8AsciiPrefixLength(text) == position);
+				text[position] = 'a';
+			}
+		}
+	}
+}
+
+TEST_CASE("UniConversionMatchesScalar") {
+
+	for (const int percentNonAscii : { 0, 1, 10, 50, 100 }) {
+		std::string text = GenerateText(5000, percentNonAscii);
+		for (const size_t length : { text.length(), text.length() - 1, text.length() - 2, size_t(37) }) {
+			const std::string_view sv(text.data(), length);
+			const size_t len16 = UTF16LengthScalar(sv);
+			REQUIRE(UTF16Length(sv) == len16);
+			std::wstring ws(len16, 0);
+			std::wstring wsScalar(len16, 0);
+			REQUIRE(UTF16FromUTF8(sv, ws.data(), len16) == UTF16FromUTF8Scalar(sv, wsScalar.data(), len16));
+			REQUIRE(ws == wsScalar);
+			REQUIRE(UTF8IsValid(sv) == UTF8IsValidScalar(sv));
+		}
+		// Invalid byte after a long run of ASCII
+		text.insert(text.length() / 2, "\xFF");
+		REQUIRE(UTF8IsValid(text) == UTF8IsValidScalar(text));
+		REQUIRE(!UTF8IsValid(text));
+	}
+}
+
+// Hidden so only run when asked for: unitTest "[benchmark]"
+TEST_CASE("UniConversionBenchmark", "[.benchmark]") {
+
+	for (const int percentNonAscii : { 0, 2, 50, 100 }) {
+		const std::string text = GenerateText(1000000, percentNonAscii);
+		const std::string suffix = " " + std::to_string(percentNonAscii) + "% non-ASCII";
+		std::wstring ws(UTF16Length(text), 0);
+
+		BENCHMARK("UTF16Length scalar" + suffix) {
+			return UTF16LengthScalar(text);
+		};
+		BENCHMARK("UTF16Length" + suffix) {
+			return UTF16Length(text);
+		};
+		BENCHMARK("UTF16FromUTF8 scalar" + suffix) {
+			return UTF16FromUTF8Scalar(text, ws.data(), ws.length());
+		};
+		BENCHMARK("UTF16FromUTF8" + suffix) {
+			return UTF16FromUTF8(text, ws.data(), ws.length());
+		};
+		BENCHMARK("UTF8IsValid scalar" + suffix) {
+			return UTF8IsValidScalar(text);
+		};
+		BENCHMARK("UTF8IsValid" + suffix) {
+			return UTF8IsValid(text);
+		};
+	}
+}
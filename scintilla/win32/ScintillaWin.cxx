@@ -399,7 +399,7 @@ class ScintillaWin :
 	void IdleWork() override;
 	void QueueIdleWork(WorkItems items, Sci::Position upTo) override;
 	bool SetIdle(bool on) override;
-	UINT_PTR timers[static_cast<int>(TickReason::dwell)+1] {};
+	UINT_PTR timers[static_cast<int>(TickReason::style)+1] {};
 	bool FineTickerRunning(TickReason reason) override;
 	void FineTickerStart(TickReason reason, int millis, int tolerance) override;
 	void FineTickerCancel(TickReason reason) override;
@@ -583,7 +583,7 @@ ScintillaWin::~ScintillaWin() {
 
 void ScintillaWin::Finalise() {
 	ScintillaBase::Finalise();
-	for (TickReason tr = TickReason::caret; tr <= TickReason::dwell;
+	for (TickReason tr = TickReason::caret; tr <= TickReason::style;
 		tr = static_cast<TickReason>(static_cast<int>(tr) + 1)) {
 		FineTickerCancel(tr);
 	}
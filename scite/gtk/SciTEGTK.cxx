@@ -442,6 +442,7 @@ protected:
 
 	guint timerID;
 	guint idlerID;
+	guint idlerAfterID;
 
 	BackgroundStrip backgroundStrip;
 	UserStrip userStrip;
@@ -496,6 +497,8 @@ protected:
 	void TimerEnd(int mask) override;
 	static gboolean IdlerTick(gpointer pSciTE);
 	void SetIdler(bool on) override;
+	static gboolean IdlerAfterTick(gpointer pSciTE);
+	void SetIdlerAfter(int milliseconds) override;
 
 	void GetWindowPosition(int *left, int *top, int *width, int *height, int *maximize) override;
 
@@ -717,6 +720,8 @@ SciTEGTK::SciTEGTK(Extension *ext) : SciTEBase(ext) {
 	startupTimestamp = 0;
 
 	timerID = 0;
+	idlerID = 0;
+	idlerAfterID = 0;
 
 	PropSetFile::SetCaseSensitiveFilenames(true);
 	propsPlatform.Set("PLAT_GTK", "1");
@@ -1159,6 +1164,19 @@ void SciTEGTK::SetIdler(bool on) {
 	}
 }
 
+gboolean SciTEGTK::IdlerAfterTick(gpointer pSciTE) {
+	SciTEGTK *scitew = static_cast<SciTEGTK *>(pSciTE);
+	scitew->idlerAfterID = 0;
+	scitew->SetIdler(true);
+	return FALSE;
+}
+
+void SciTEGTK::SetIdlerAfter(int milliseconds) {
+	if (!idlerAfterID) {
+		idlerAfterID = g_timeout_add(milliseconds, IdlerAfterTick, this);
+	}
+}
+
 void SciTEGTK::GetWindowPosition(int *left, int *top, int *width, int *height, int *maximize) {
 	gtk_window_get_position(GTK_WINDOW(PWidget(wSciTE)), left, top);
 	gtk_window_get_size(GTK_WINDOW(PWidget(wSciTE)), width, height);
@@ -242,6 +242,11 @@ FileWorker.o: \
 	../src/Worker.h \
 	../src/FileWorker.h \
 	../src/Utf8_16.h
+Grep.o: \
+	../src/Grep.cxx \
+	../src/GUI.h \
+	../src/StringHelpers.h \
+	../src/Grep.h
 IFaceTable.o: \
 	../src/IFaceTable.cxx \
 	../src/GUI.h \
@@ -255,6 +260,11 @@ JobQueue.o: \
 	../src/PropSetFile.h \
 	../src/SciTE.h \
 	../src/JobQueue.h
+LexerCache.o: \
+	../src/LexerCache.cxx \
+	../src/GUI.h \
+	../src/FilePath.h \
+	../src/LexerCache.h
 LuaExtension.o: \
 	../src/LuaExtension.cxx \
 	../../scintilla/include/ScintillaTypes.h \
@@ -314,6 +324,7 @@ SciTEBase.o: \
 	../../scintilla/include/Sci_Position.h \
 	../../scintilla/include/ScintillaTypes.h \
 	../../scintilla/include/ScintillaMessages.h \
+	../../scintilla/include/ScintillaStructures.h \
 	../../scintilla/include/ScintillaCall.h \
 	../../scintilla/include/Scintilla.h \
 	../../lexilla/include/SciLexer.h \
@@ -364,6 +375,7 @@ SciTEIO.o: \
 	../../scintilla/include/ILoader.h \
 	../../scintilla/include/Sci_Position.h \
 	../../scintilla/include/ScintillaTypes.h \
+	../../scintilla/include/ScintillaStructures.h \
 	../../scintilla/include/ScintillaCall.h \
 	../src/GUI.h \
 	../src/ScintillaWindow.h \
@@ -382,7 +394,9 @@ SciTEIO.o: \
 	../src/MatchMarker.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
-	../src/Utf8_16.h
+	../src/Utf8_16.h \
+	../src/LexerCache.h \
+	../src/Grep.h
 SciTEProps.o: \
 	../src/SciTEProps.cxx \
 	../../scintilla/include/ILexer.h \
@@ -17,10 +17,20 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
-#include <QTextStream>
 #include <QThread>
 #include <QPair>
 #include <QRegularExpression>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QByteArrayMatcher>
+
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 #include "findinfiles.h"
 
@@ -93,211 +103,567 @@ QString FindFileMsgEvent::GetMessage() const
 
 // ************************************************************************
 
-static void inc_if( int * pValue )
+// Result of searching one file or the listing of one directory. A directory's
+// children are its files followed by its subdirectories so that visiting the
+// tree in order gives the order of a sequential search.
+
+struct ResultSlot
+{
+    bool                    bDone = false;      // file searched or directory listed
+    bool                    bDirectory = false;
+    QString                 sResult;
+    std::vector<std::unique_ptr<ResultSlot>> aChildren;
+};
+
+// Positions of the next occurrence of each case of the first byte of a case
+// insensitive literal search, -1 when there is none and -2 before searching.
+// Successive searches of the same data, each starting after the previous one,
+// share this so the data is only scanned once for each case.
+
+struct LiteralNext
+{
+    int                     iLower = -2;
+    int                     iUpper = -2;
+};
+
+// Shared state of one find in files run. Directory and file tasks run in
+// parallel on a thread pool and hand their results to this object which
+// forwards them to the observer in batches, in the same order whatever
+// order the tasks finish in.
+
+class FindInFilesContext
 {
-    if( pValue )
+public:
+    FindInFilesContext( const QString & sFiles,
+                        const QString & sSearch,
+                        bool bCaseSensitive,
+                        bool bSerachInSubDirs,
+                        bool bRegExpr,
+                        std::atomic<int> * pFoundCount,
+                        std::atomic<int> * pFindFileCount,
+                        std::atomic<int> * pTotalCount,
+                        const QString & sFileTag,
+                        const QString & sLineTag,
+                        QObject * pObserver,
+                        std::atomic<bool> * pStopFlag );
+
+    bool IsStopped() const;
+    bool UseLineMatcher() const;
+    int FindLiteral( const char * pData, int iStart, int iEnd, LiteralNext & aNext ) const;
+    int FindInLine( const QString & sLine, int iFrom ) const;
+
+    ResultSlot * StartSlot();
+    void CompleteFile( ResultSlot * pSlot, const QString & sResult );
+    std::vector<ResultSlot *> CompleteDirectory( ResultSlot * pSlot, int iChildren );
+    void ReportCurrentItem( const QString & sItem );
+    void Flush();
+
+    QThreadPool             m_aPool;
+
+    QStringList             m_aNameFilters;
+    QString                 m_sSearch;
+    QByteArray              m_aSearchUtf8;
+    QByteArrayMatcher       m_aMatcher;
+    QRegularExpression      m_aRegExpr;
+    bool                    m_bCaseSensitive;
+    bool                    m_bSerachInSubDirs;
+    bool                    m_bRegExpr;
+    bool                    m_bAsciiCaseInsensitive;
+    unsigned char           m_aFold[256];
+    std::atomic<int> *      m_pFoundCount;      // total occurences
+    std::atomic<int> *      m_pFindFileCount;   // found in this number of files
+    std::atomic<int> *      m_pTotalCount;      // searched in total files
+    QString                 m_sFileTag;
+    QString                 m_sLineTag;
+    QObject *               m_pObserver;
+    std::atomic<bool> *     m_pStopFlag;
+
+private:
+    void AddCompletedResults();
+    void PostBatch();
+
+    QMutex                  m_aMutex;
+    ResultSlot              m_aRoot;
+    // directories being reported with the index of their next child
+    std::vector<std::pair<ResultSlot *, size_t>> m_aReporting;
+    QString                 m_sBatch;
+    QElapsedTimer           m_aSinceBatch;
+    QElapsedTimer           m_aSinceItem;
+};
+
+// Results are sent to the observer when this much text is waiting or when
+// this many milliseconds have passed since the last batch.
+const int c_iBatchLength = 64 * 1024;
+const int c_iBatchInterval = 100;
+
+// Files are mapped and searched in windows of about this size which end at a
+// line end so that offsets fit in an int and address space is not exhausted.
+const qint64 c_iWindowSize = 256 * 1024 * 1024;
+
+static bool IsAscii( const QByteArray & aText )
+{
+    for( const char ch : aText )
     {
-        *pValue += 1;
+        if( static_cast<unsigned char>(ch) >= 0x80 )
+        {
+            return false;
+        }
     }
+    return true;
 }
 
-static QPair<bool, QString> SingleFileSearch( const QString & sFileName,
-                                 const QString & sSearch,
-                                 bool bCaseSensitive=true,
-                                 bool bRegExpr=true,
-                                 bool bWildcard=false,
-                                 int * pFoundCount=0,
-                                 const QString & sFileTag = "",
-                                 const QString & sLineTag = "",
-                                 QObject * pObserver = 0 )
+FindInFilesContext::FindInFilesContext( const QString & sFiles,
+                                        const QString & sSearch,
+                                        bool bCaseSensitive,
+                                        bool bSerachInSubDirs,
+                                        bool bRegExpr,
+                                        std::atomic<int> * pFoundCount,
+                                        std::atomic<int> * pFindFileCount,
+                                        std::atomic<int> * pTotalCount,
+                                        const QString & sFileTag,
+                                        const QString & sLineTag,
+                                        QObject * pObserver,
+                                        std::atomic<bool> * pStopFlag )
+    : m_aNameFilters( sFiles.split(" ", Qt::SkipEmptyParts) )
+    , m_sSearch( sSearch )
+    , m_aSearchUtf8( sSearch.toUtf8() )
+    , m_aMatcher( sSearch.toUtf8() )
+    , m_bCaseSensitive( bCaseSensitive )
+    , m_bSerachInSubDirs( bSerachInSubDirs )
+    , m_bRegExpr( bRegExpr )
+    , m_bAsciiCaseInsensitive( !bCaseSensitive && IsAscii(sSearch.toUtf8()) )
+    , m_pFoundCount( pFoundCount )
+    , m_pFindFileCount( pFindFileCount )
+    , m_pTotalCount( pTotalCount )
+    , m_sFileTag( sFileTag )
+    , m_sLineTag( sLineTag )
+    , m_pObserver( pObserver )
+    , m_pStopFlag( pStopFlag )
 {
-    QString sRet;
-    bool bFound = false;
+    if( m_bRegExpr )
+    {
+        m_aRegExpr = QRegularExpression( sSearch, bCaseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption );
+        m_aRegExpr.optimize();
+    }
+    for( int i = 0; i < 256; i++ )
+    {
+        m_aFold[i] = static_cast<unsigned char>( (i >= 'A' && i <= 'Z') ? i - 'A' + 'a' : i );
+    }
+    // the root holds the slot of the searched path
+    m_aRoot.bDone = true;
+    m_aRoot.bDirectory = true;
+    m_aRoot.aChildren.push_back( std::make_unique<ResultSlot>() );
+    m_aReporting.emplace_back( &m_aRoot, 0 );
+    m_aSinceBatch.start();
+    m_aSinceItem.start();
+}
 
-    QFile aFile( sFileName );
-    if( !aFile.open(QIODevice::ReadOnly | QIODevice::Text) )
+bool FindInFilesContext::IsStopped() const
+{
+    return m_pStopFlag && *m_pStopFlag;
+}
+
+bool FindInFilesContext::UseLineMatcher() const
+{
+    // raw byte search is possible for case sensitive text and for case insensitive ASCII text
+    return m_bRegExpr || !(m_bCaseSensitive || m_bAsciiCaseInsensitive);
+}
+
+int FindInFilesContext::FindLiteral( const char * pData, int iStart, int iEnd, LiteralNext & aNext ) const
+{
+    const int iLen = m_aSearchUtf8.size();
+    if( iLen == 0 || iEnd - iStart < iLen )
     {
-        sRet = QObject::tr("Error: can not open file ") + sFileName;
+        return -1;
     }
-    else
+    if( m_bCaseSensitive )
     {
-        if( pObserver )
+        const qsizetype iFound = m_aMatcher.indexIn( pData + iStart, iEnd - iStart );
+        return iFound < 0 ? -1 : iStart + static_cast<int>(iFound);
+    }
+    // ASCII case insensitive: look for either case of the first byte with memchr
+    // and only then compare the remaining bytes folded. A case is only scanned
+    // again once its remembered occurrence has been passed.
+    const unsigned char * pSearch = reinterpret_cast<const unsigned char *>( m_aSearchUtf8.constData() );
+    const unsigned char chLower = m_aFold[pSearch[0]];
+    const unsigned char chUpper = static_cast<unsigned char>( (chLower >= 'a' && chLower <= 'z') ? chLower - 'a' + 'A' : chLower );
+    const int iLast = iEnd - iLen;
+    auto NextOf = [pData, iLast]( unsigned char ch, int iPos, int & iNext )
+    {
+        if( iNext == -2 || (iNext >= 0 && iNext < iPos) )
+        {
+            const void * pFound = memchr( pData + iPos, ch, iLast - iPos + 1 );
+            iNext = pFound ? static_cast<int>( static_cast<const char *>( pFound ) - pData ) : -1;
+        }
+        return iNext;
+    };
+    int iPos = iStart;
+    while( iPos <= iLast )
+    {
+        const int iLower = NextOf( chLower, iPos, aNext.iLower );
+        const int iUpper = (chUpper != chLower) ? NextOf( chUpper, iPos, aNext.iUpper ) : -1;
+        if( iLower < 0 && iUpper < 0 )
         {
-            QEvent * pEvent = new SearchInFileMsgEvent(sFileName);
-            QGuiApplication::postEvent(pObserver, pEvent, Qt::LowEventPriority);
+            return -1;
         }
+        iPos = (iLower < 0 || (iUpper >= 0 && iUpper < iLower)) ? iUpper : iLower;
+        int i = 1;
+        while( i < iLen && m_aFold[static_cast<unsigned char>(pData[iPos + i])] == m_aFold[pSearch[i]] )
+        {
+            i++;
+        }
+        if( i == iLen )
+        {
+            return iPos;
+        }
+        iPos++;
+    }
+    return -1;
+}
 
-        QTextStream aInStream( &aFile );
-        //aInStream.setEncoding(QTextStream::UnicodeUTF8);
+int FindInFilesContext::FindInLine( const QString & sLine, int iFrom ) const
+{
+    if( m_bRegExpr )
+    {
+        QRegularExpressionMatch aMatch = m_aRegExpr.match(sLine, iFrom);
+        return aMatch.capturedStart();
+    }
+    return sLine.indexOf(m_sSearch, iFrom, m_bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
+}
+
+ResultSlot * FindInFilesContext::StartSlot()
+{
+    return m_aRoot.aChildren.front().get();
+}
+
+void FindInFilesContext::CompleteFile( ResultSlot * pSlot, const QString & sResult )
+{
+    QMutexLocker aLock( &m_aMutex );
+    pSlot->sResult = sResult;
+    pSlot->bDone = true;
+    AddCompletedResults();
+}
 
-        QRegularExpression * pRegExpr = 0;
-        if( bRegExpr )
+std::vector<ResultSlot *> FindInFilesContext::CompleteDirectory( ResultSlot * pSlot, int iChildren )
+{
+    // the children are returned as the slot may be released once they are all complete
+    std::vector<ResultSlot *> aChildren;
+    QMutexLocker aLock( &m_aMutex );
+    for( int i = 0; i < iChildren; i++ )
+    {
+        pSlot->aChildren.push_back( std::make_unique<ResultSlot>() );
+        aChildren.push_back( pSlot->aChildren.back().get() );
+    }
+    pSlot->bDirectory = true;
+    pSlot->bDone = true;
+    AddCompletedResults();
+    return aChildren;
+}
+
+void FindInFilesContext::AddCompletedResults()
+{
+    // add results in tree order up to the first slot that is not complete
+    while( !m_aReporting.empty() )
+    {
+        ResultSlot * pDirectory = m_aReporting.back().first;
+        size_t & iNext = m_aReporting.back().second;
+        if( iNext >= pDirectory->aChildren.size() )
         {
-            //pRegExpr = new QRegExp(sSearch, bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive, bWildcard ? QRegExp::Wildcard : QRegExp::RegExp/*FixedString*/);
-            QRegularExpression::PatternOptions flags = (bCaseSensitive ? QRegularExpression::CaseInsensitiveOption : QRegularExpression::NoPatternOption);
-            pRegExpr = new QRegularExpression( sSearch, flags );
+            pDirectory->aChildren.clear();
+            m_aReporting.pop_back();
+            continue;
         }
-
-        int iCount = 0;
-        while( !aInStream.atEnd() )
+        ResultSlot * pChild = pDirectory->aChildren[iNext].get();
+        if( !pChild->bDone )
         {
-            QString strLine = aInStream.readLine();
-            iCount++;
+            break;
+        }
+        iNext++;
+        if( pChild->bDirectory )
+        {
+            m_aReporting.emplace_back( pChild, 0 );
+        }
+        else
+        {
+            m_sBatch += pChild->sResult;
+            pChild->sResult.clear();
+        }
+    }
+    if( m_sBatch.size() >= c_iBatchLength || m_aSinceBatch.elapsed() >= c_iBatchInterval )
+    {
+        PostBatch();
+    }
+}
 
-            int iFoundPos = -1;
-            if( bRegExpr && pRegExpr )
-            {
-                //iFoundPos = pRegExpr->indexIn(strLine);
-                QRegularExpressionMatch aMatch = pRegExpr->match(strLine);
-                iFoundPos = aMatch.capturedStart();
-            }
-            else
-            {
-                iFoundPos = strLine.indexOf(sSearch, 0, bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
-            }
-            if( iFoundPos >= 0 )
-            {
-                // found !
-                bFound = true;
+void FindInFilesContext::ReportCurrentItem( const QString & sItem )
+{
+    QMutexLocker aLock( &m_aMutex );
+    if( m_pObserver && m_aSinceItem.elapsed() >= c_iBatchInterval )
+    {
+        m_aSinceItem.restart();
+        QEvent * pEvent = new SearchInFileMsgEvent(sItem);
+        QGuiApplication::postEvent(m_pObserver, pEvent, Qt::LowEventPriority);
+    }
+}
 
-                QString strTemp = sFileTag + QDir::toNativeSeparators(sFileName) + ":" + sLineTag + QString::number( iCount ) + ": " + strLine + "\n";
+void FindInFilesContext::Flush()
+{
+    QMutexLocker aLock( &m_aMutex );
+    PostBatch();
+}
 
-                if( pObserver )
-                {
-                    QEvent * pEvent = new FindFileMsgEvent(strTemp);
-                    QGuiApplication::postEvent(pObserver, pEvent, Qt::LowEventPriority);
-                }
+void FindInFilesContext::PostBatch()
+{
+    m_aSinceBatch.restart();
+    if( m_pObserver && !m_sBatch.isEmpty() )
+    {
+        QEvent * pEvent = new FindFileMsgEvent(m_sBatch);
+        QGuiApplication::postEvent(m_pObserver, pEvent, Qt::LowEventPriority);
+    }
+    m_sBatch.clear();
+}
+
+// ************************************************************************
+
+static QString FoundLine( FindInFilesContext * pContext, const QString & sFileName, qint64 iLine, const QString & sLine )
+{
+    return pContext->m_sFileTag + QDir::toNativeSeparators(sFileName) + ":" + pContext->m_sLineTag + QString::number( iLine ) + ": " + sLine + "\n";
+}
 
-                sRet += strTemp;
+static QString LineText( const char * pData, int iLineStart, int iLineEnd )
+{
+    // same as QTextStream::readLine() on a file opened with QIODevice::Text
+    if( iLineEnd > iLineStart && pData[iLineEnd - 1] == '\r' )
+    {
+        iLineEnd--;
+    }
+    return QString::fromUtf8( pData + iLineStart, iLineEnd - iLineStart );
+}
 
+static int LineEnd( const char * pData, int iPos, int iSize )
+{
+    const void * pLineEnd = memchr( pData + iPos, '\n', iSize - iPos );
+    return pLineEnd ? static_cast<int>( static_cast<const char *>(pLineEnd) - pData ) : iSize;
+}
+
+// iFirstLine is the line number of pData which is the start of a line
+static bool SearchInBytes( FindInFilesContext * pContext, const QString & sFileName, const char * pData, int iSize, qint64 iFirstLine, QString & sRet )
+{
+    bool bFound = false;
+    int iFoundCount = 0;
+    if( pContext->UseLineMatcher() )
+    {
+        // regular expressions and non ASCII case folding need the decoded line
+        qint64 iLine = iFirstLine - 1;
+        for( int iLineStart = 0; iLineStart < iSize && !pContext->IsStopped(); )
+        {
+            const int iLineEnd = LineEnd( pData, iLineStart, iSize );
+            iLine++;
+            const QString strLine = LineText( pData, iLineStart, iLineEnd );
+            int iFoundPos = pContext->FindInLine( strLine, 0 );
+            if( iFoundPos >= 0 )
+            {
+                bFound = true;
+                sRet += FoundLine( pContext, sFileName, iLine, strLine );
                 // count all occurences in this line !
                 while( iFoundPos >= 0 )
                 {
-                    inc_if( pFoundCount );
-
-                    if( bRegExpr && pRegExpr )
-                    {
-                        //iFoundPos = pRegExpr->indexIn(strLine, iFoundPos+1/*pRegExpr->matchedLength()*/);
-                        QRegularExpressionMatch aMatch = pRegExpr->match(strLine, iFoundPos+1);
-                        iFoundPos = aMatch.capturedStart();
-                    }
-                    else
-                    {
-                        iFoundPos = strLine.indexOf(sSearch, iFoundPos+1, bCaseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive);
-                    }
+                    iFoundCount++;
+                    iFoundPos = pContext->FindInLine( strLine, iFoundPos + 1 );
                 }
             }
+            iLineStart = iLineEnd + 1;
         }
-
-        if( pRegExpr )
+    }
+    else
+    {
+        // literal search over the raw bytes, lines are only counted and decoded around matches
+        qint64 iLine = iFirstLine;
+        int iCountedTo = 0;
+        LiteralNext aNext;
+        int iFoundPos = pContext->FindLiteral( pData, 0, iSize, aNext );
+        while( iFoundPos >= 0 && !pContext->IsStopped() )
         {
-            delete pRegExpr;
+            iLine += static_cast<int>( std::count( pData + iCountedTo, pData + iFoundPos, '\n' ) );
+            int iLineStart = iFoundPos;
+            while( iLineStart > 0 && pData[iLineStart - 1] != '\n' )
+            {
+                iLineStart--;
+            }
+            const int iLineEnd = LineEnd( pData, iFoundPos, iSize );
+            bFound = true;
+            sRet += FoundLine( pContext, sFileName, iLine, LineText( pData, iLineStart, iLineEnd ) );
+            // count all occurences in this line !
+            while( iFoundPos >= 0 && iFoundPos < iLineEnd )
+            {
+                iFoundCount++;
+                iFoundPos = pContext->FindLiteral( pData, iFoundPos + 1, iSize, aNext );
+            }
+            iCountedTo = iLineStart;
         }
     }
-
-    return QPair<bool, QString>(bFound, sRet);
+    *pContext->m_pFoundCount += iFoundCount;
+    return bFound;
 }
 
-static QString ProcessSingleFileFind(const QString & sPath,
-          const QString & sFile,
-          const QString & sSearch,
-          bool bCaseSensitive=true,
-          bool bRegExpr=true,
-          bool bWildcard=false,
-          int * pFoundCount=0,
-          int * pFindFileCount=0,
-          int * pTotalCount=0,
-          const QString & sFileTag = "",
-          const QString & sLineTag = "",
-          QObject * pObserver = 0)
+static int WindowLength( const char * pData, int iLength, bool bLastWindow )
 {
-    QString sRet;
-    QString sName = QFileInfo(sPath, sFile).absoluteFilePath();
-    QFileInfo aItemInfo(sName);
-    if(aItemInfo.isFile())
+    if( bLastWindow )
     {
-        QPair<bool, QString> result = SingleFileSearch(sName, sSearch, bCaseSensitive, bRegExpr, bWildcard, pFoundCount, sFileTag, sLineTag, pObserver);
-
-        inc_if( pTotalCount );
-
-        sRet += result.second;
-        if( result.first )
+        return iLength;
+    }
+    // end after the last line end so that lines are not split between windows,
+    // a single line longer than a window is split
+    for( int i = iLength; i > 0; i-- )
+    {
+        if( pData[i - 1] == '\n' )
         {
-            inc_if(pFindFileCount);
+            return i;
         }
-
-        return result.second;
     }
-
-    return "";
+    return iLength;
 }
 
-static std::pair<bool,QString> RecursiveFileSearch( const QString & sPath,
-                                    const QString & sFiles,
-                                    const QString & sSearch,
-                                    bool bCaseSensitive=true,
-                                    bool bSerachInSubDirs=true,
-                                    bool bRegExpr=true,
-                                    bool bWildcard=false,
-                                    int * pFoundCount=0,
-                                    int * pFindFileCount=0,
-                                    int * pTotalCount=0,
-                                    const QString & sFileTag = "",
-                                    const QString & sLineTag = "",
-                                    QObject * pObserver = 0,
-                                    bool * pStopFlag = 0 )
+static void SingleFileSearch( FindInFilesContext * pContext, ResultSlot * pSlot, const QString & sFileName )
 {
     QString sRet;
-    QDir aDir(sPath);
-    QFileInfo aPathInfo(sPath);
-    QStringList::Iterator it;
+    bool bFound = false;
 
-    QStringList aFiles;
-    if( aPathInfo.isDir() )
+    QFile aFile( sFileName );
+    if( aFile.open(QIODevice::ReadOnly) )
     {
-        aFiles = aDir.entryList(sFiles.split(" "), QDir::Files);
+        const qint64 iSize = aFile.size();
+        qint64 iOffset = 0;
+        qint64 iLine = 1;
+        while( iOffset < iSize && !pContext->IsStopped() )
+        {
+            const bool bLastWindow = iSize - iOffset <= c_iWindowSize;
+            const int iMapLength = static_cast<int>( bLastWindow ? iSize - iOffset : c_iWindowSize );
+            // search directly in a mapping of the file, reading it is the fallback
+            const uchar * pMapped = aFile.map(iOffset, iMapLength);
+            QByteArray aData;
+            if( !pMapped )
+            {
+                if( !aFile.seek(iOffset) )
+                {
+                    break;
+                }
+                aData = aFile.read(iMapLength);
+                if( aData.size() != iMapLength )
+                {
+                    break;
+                }
+            }
+            const char * pData = pMapped ? reinterpret_cast<const char *>(pMapped) : aData.constData();
+            const int iLength = WindowLength( pData, iMapLength, bLastWindow );
+            if( SearchInBytes( pContext, sFileName, pData, iLength, iLine, sRet ) )
+            {
+                bFound = true;
+            }
+            if( !bLastWindow )
+            {
+                iLine += std::count( pData, pData + iLength, '\n' );
+            }
+            if( pMapped )
+            {
+                aFile.unmap(const_cast<uchar *>(pMapped));
+            }
+            iOffset += iLength;
+        }
     }
-    else
+
+    *pContext->m_pTotalCount += 1;
+    if( bFound )
     {
-        // no directory given, just an add single file to list of files
-        aFiles.append(sPath);
+        *pContext->m_pFindFileCount += 1;
     }
+    pContext->CompleteFile( pSlot, sRet );
+}
 
-    it = aFiles.begin();
-    while( it != aFiles.end() )
+class FileSearchTask : public QRunnable
+{
+public:
+    FileSearchTask( FindInFilesContext * pContext, ResultSlot * pSlot, const QString & sFileName )
+        : m_pContext( pContext )
+        , m_pSlot( pSlot )
+        , m_sFileName( sFileName )
     {
-        QString strFound = ProcessSingleFileFind(sPath, *it, sSearch, bCaseSensitive, bRegExpr, bWildcard, pFoundCount, pFindFileCount, pTotalCount, sFileTag, sLineTag, pObserver);
+    }
 
-        // handle the stopping flag...
-        if( pStopFlag && *pStopFlag )
+    virtual void run()
+    {
+        if( !m_pContext->IsStopped() )
         {
-            return std::pair<bool,QString>(false, sRet);
+            SingleFileSearch( m_pContext, m_pSlot, m_sFileName );
         }
+    }
 
-        ++it;
+private:
+    FindInFilesContext *    m_pContext;
+    ResultSlot *            m_pSlot;
+    QString                 m_sFileName;
+};
+
+class DirectorySearchTask : public QRunnable
+{
+public:
+    DirectorySearchTask( FindInFilesContext * pContext, ResultSlot * pSlot, const QString & sPath )
+        : m_pContext( pContext )
+        , m_pSlot( pSlot )
+        , m_sPath( sPath )
+    {
     }
 
-    if( bSerachInSubDirs )
+    virtual void run()
     {
-        QStringList dirs = aDir.entryList(QDir::Dirs);
-        it = dirs.begin();
-        while( it != dirs.end() )
+        if( m_pContext->IsStopped() )
+        {
+            return;
+        }
+
+        QFileInfo aPathInfo(m_sPath);
+        if( !aPathInfo.isDir() )
         {
-            if( *it != "." && *it != ".." )
+            // no directory given, just search in the single file
+            if( aPathInfo.isFile() )
             {
-                std::pair<bool,QString> aRet = RecursiveFileSearch(sPath + "/" + *it, sFiles, sSearch, bCaseSensitive, bSerachInSubDirs, bRegExpr, bWildcard, pFoundCount, pFindFileCount, pTotalCount, sFileTag, sLineTag, pObserver, pStopFlag);
-                sRet += aRet.second;
-                if( !aRet.first )
-                {
-                    return std::pair<bool,QString>(aRet.first,sRet);
-                }
+                m_pContext->ReportCurrentItem( aPathInfo.absoluteFilePath() );
+                SingleFileSearch( m_pContext, m_pSlot, aPathInfo.absoluteFilePath() );
             }
-            ++it;
+            else
+            {
+                m_pContext->CompleteFile( m_pSlot, QString() );
+            }
+            return;
+        }
+
+        m_pContext->ReportCurrentItem( m_sPath );
+
+        QDir aDir(m_sPath);
+        const QStringList aFiles = aDir.entryList(m_pContext->m_aNameFilters, QDir::Files);
+        QStringList aDirs;
+        if( m_pContext->m_bSerachInSubDirs )
+        {
+            aDirs = aDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        }
+
+        const std::vector<ResultSlot *> aSlots = m_pContext->CompleteDirectory( m_pSlot, static_cast<int>(aFiles.size() + aDirs.size()) );
+        for( int i = 0; i < aDirs.size(); i++ )
+        {
+            // directories are listed before files are searched so that the pool always has work
+            m_pContext->m_aPool.start( new DirectorySearchTask( m_pContext, aSlots[aFiles.size() + i], m_sPath + "/" + aDirs[i] ), 1 );
+        }
+        for( int i = 0; i < aFiles.size(); i++ )
+        {
+            m_pContext->m_aPool.start( new FileSearchTask( m_pContext, aSlots[i], QFileInfo(m_sPath, aFiles[i]).absoluteFilePath() ) );
         }
     }
 
-    return std::pair<bool,QString>(true, sRet);
-}
+private:
+    FindInFilesContext *    m_pContext;
+    ResultSlot *            m_pSlot;
+    QString                 m_sPath;
+};
 
 class FindInFilesInThread : public QThread
 {
@@ -305,64 +671,45 @@ public:
     FindInFilesInThread(  const QString & sPath,
                     const QString & sFiles,
                     const QString & sSearch,
-                    bool bCaseSensitive=true,
-                    bool bSerachInSubDirs=true,
-                    bool bRegExpr=true,
-                    bool bWildcard=false,
-                    int * pFoundCount=0,
-                    int * pFindFileCount=0,
-                    int * pTotalCount=0,
-                    const QString & sFileTag = "",
-                    const QString & sLineTag = "",
-                    QObject * pObserver = 0,
-                    bool * pStopFlag = 0 )
+                    bool bCaseSensitive,
+                    bool bSerachInSubDirs,
+                    bool bRegExpr,
+                    std::atomic<int> * pFoundCount,
+                    std::atomic<int> * pFindFileCount,
+                    std::atomic<int> * pTotalCount,
+                    const QString & sFileTag,
+                    const QString & sLineTag,
+                    QObject * pObserver,
+                    std::atomic<bool> * pStopFlag )
         : QThread( pObserver )
         , m_sPath( sPath )
-        , m_sFiles( sFiles )
-        , m_sSearch( sSearch )
-        , m_bCaseSensitive( bCaseSensitive )
-        , m_bSerachInSubDirs( bSerachInSubDirs )
-        , m_bRegExpr( bRegExpr )
-        , m_bWildcard( bWildcard )
-        , m_pFoundCount( pFoundCount )
-        , m_pFindFileCount( pFindFileCount )
-        , m_pTotalCount( pTotalCount )
-        , m_sFileTag( sFileTag )
-        , m_sLineTag( sLineTag )
-        , m_pObserver( pObserver )
-        , m_pStopFlag( pStopFlag )
+        , m_aContext( sFiles, sSearch, bCaseSensitive, bSerachInSubDirs, bRegExpr,
+                      pFoundCount, pFindFileCount, pTotalCount, sFileTag, sLineTag, pObserver, pStopFlag )
     {
     }
 
     virtual void run()
     {
-        std::pair<bool,QString> aRet = RecursiveFileSearch( m_sPath,
-                                    m_sFiles,
-                                    m_sSearch,
-                                    m_bCaseSensitive,
-                                    m_bSerachInSubDirs,
-                                    m_bRegExpr,
-                                    m_bWildcard,
-                                    m_pFoundCount,
-                                    m_pFindFileCount,
-                                    m_pTotalCount,
-                                    m_sFileTag,
-                                    m_sLineTag,
-                                    m_pObserver,
-                                    m_pStopFlag );
-        QString strLastMsg = ""+QObject::tr(">Found ")+QString::number(*m_pFoundCount)+QObject::tr(" occurences in ")+QString::number(*m_pFindFileCount)+QObject::tr(" files, searched in total files: ")+QString::number(*m_pTotalCount)+"\n";
-        if( m_pObserver )
+#if QT_VERSION >= QT_VERSION_CHECK(6, 2, 0)
+        m_aContext.m_aPool.setThreadPriority(QThread::LowPriority);
+#endif
+        m_aContext.m_aPool.start( new DirectorySearchTask( &m_aContext, m_aContext.StartSlot(), m_sPath ), 1 );
+        m_aContext.m_aPool.waitForDone();
+        m_aContext.Flush();
+
+        QString strLastMsg = ""+QObject::tr(">Found ")+QString::number(m_aContext.m_pFoundCount->load())+QObject::tr(" occurences in ")+QString::number(m_aContext.m_pFindFileCount->load())+QObject::tr(" files, searched in total files: ")+QString::number(m_aContext.m_pTotalCount->load())+"\n";
+        if( m_aContext.m_pObserver )
         {
             QString strResult;
-            if( !aRet.first )
+            if( m_aContext.IsStopped() )
             {
                 strResult = QObject::tr(">Search stoped !\n");
             }
             QEvent * pEvent = new FindFileMsgEvent(strResult+strLastMsg);
-            QGuiApplication::postEvent(m_pObserver, pEvent, Qt::LowEventPriority);
+            QGuiApplication::postEvent(m_aContext.m_pObserver, pEvent, Qt::LowEventPriority);
 
             QEvent * pEvent2 = new FindFileDoneEvents();
-            QGuiApplication::postEvent(m_pObserver, pEvent2, Qt::LowEventPriority);
+            QGuiApplication::postEvent(m_aContext.m_pObserver, pEvent2, Qt::LowEventPriority);
 
             QThread::usleep(250000);
         }
@@ -373,20 +720,8 @@ public:
     }
 
 private:
-    QString     m_sPath;
-    QString     m_sFiles;
-    QString     m_sSearch;
-    bool        m_bCaseSensitive;
-    bool        m_bSerachInSubDirs;
-    bool        m_bRegExpr;
-    bool        m_bWildcard;
-    int *       m_pFoundCount;      // total occurences
-    int *       m_pFindFileCount;   // found in this number of files
-    int *       m_pTotalCount;      // searched in total files
-    QString     m_sFileTag;
-    QString     m_sLineTag;
-    QObject *   m_pObserver;
-    bool *      m_pStopFlag;
+    QString             m_sPath;
+    FindInFilesContext  m_aContext;
 };
 
 // ************************************************************************
@@ -427,7 +762,7 @@ void FindInFilesAsync::StartSearch( const QString & sSearchDir, const QString &
         m_bStopFlag = false;
         m_pFindThread = new FindInFilesInThread( sSearchDir, sSearchFiles, sFindText,
                                            bCaseSensitive, /*bSerachInSubDirs=*/true,
-                                           bRegularExpr, /*bWildcard=*/false,
+                                           bRegularExpr,
                                            &m_iCount, &m_iFoundFileCount, &m_iTotalFileCount,
                                            /*fileTag=*/"", /*lineTag=*/"", this, &m_bStopFlag );
         connect(m_pFindThread,SIGNAL(finished()),this,SLOT(sltFindThreadFinished()));
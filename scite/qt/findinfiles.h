@@ -17,6 +17,8 @@
 
 #include <QObject>
 
+#include <atomic>
+
 class FindInFilesInThread;
 
 class FindInFilesAsync : public QObject
@@ -45,10 +47,10 @@ protected:
 private:
     FindInFilesInThread *   m_pFindThread;
 
-    bool                    m_bStopFlag;
-    int                     m_iCount;
-    int                     m_iFoundFileCount;
-    int                     m_iTotalFileCount;
+    std::atomic<bool>       m_bStopFlag;
+    std::atomic<int>        m_iCount;
+    std::atomic<int>        m_iFoundFileCount;
+    std::atomic<int>        m_iTotalFileCount;
 };
 
 #endif // FINDINFILES_H
@@ -59,8 +59,10 @@ HEADERS += ../src/Cookie.h\
             ../src/FilePath.h\
             ../src/FileWorker.h\
             ../src/GUI.h\
+            ../src/Grep.h\
             ../src/IFaceTable.h\
             ../src/JobQueue.h\
+            ../src/LexerCache.h\
             ../src/LuaExtension.h\
             ../src/MatchMarker.h\
             ../src/MultiplexExtension.h\
@@ -91,8 +93,10 @@ SOURCES +=  ../src/Cookie.cxx\
             ../src/ExportXML.cxx\
             ../src/FilePath.cxx\
             ../src/FileWorker.cxx\
+            ../src/Grep.cxx\
             ../src/IFaceTable.cxx\
             ../src/JobQueue.cxx\
+            ../src/LexerCache.cxx\
             ../src/LuaExtension.cxx\
             ../src/MatchMarker.cxx\
             ../src/MultiplexExtension.cxx\
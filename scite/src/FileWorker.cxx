@@ -12,11 +12,28 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <memory>
 #include <chrono>
 #include <atomic>
 #include <mutex>
 
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/mman.h>
+
+#else
+
+#include <io.h>
+
+#undef _WIN32_WINNT
+#define _WIN32_WINNT  0x0A00
+#undef NOMINMAX
+#define NOMINMAX 1
+#include <windows.h>
+
+#endif
+
 #include "ILoader.h"
 
 #include "GUI.h"
@@ -29,6 +46,72 @@
 
 constexpr double timeBetweenProgress = 0.4;
 
+/// Size of each AddData call when loading from a mapping.
+/// Kept even so that UTF-16 code units are not split.
+constexpr size_t mappedBlockSize = 16 * blockSize;
+
+namespace {
+
+/// A private copy-on-write view of a whole file.
+/// Utf8_16_Read::convert does not write to its input so pages stay shared with the file cache.
+class FileMapping {
+	char *view = nullptr;
+	size_t length = 0;
+#if !(defined(__unix__) || defined(__APPLE__))
+	HANDLE hMapping {};
+#endif
+public:
+	FileMapping(FILE *fp, size_t length_) noexcept {
+		if (length_ == 0) {
+			return;
+		}
+#if defined(__unix__) || defined(__APPLE__)
+		void *address = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fp), 0);
+		if (address != MAP_FAILED) {
+			view = static_cast<char *>(address);
+			length = length_;
+			madvise(address, length, MADV_SEQUENTIAL);
+		}
+#else
+		HANDLE hFile = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+		hMapping = ::CreateFileMappingW(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (hMapping) {
+			view = static_cast<char *>(::MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, length_));
+			if (view) {
+				length = length_;
+			}
+		}
+#endif
+	}
+	// Deleted so FileMapping objects can not be copied.
+	FileMapping(const FileMapping &) = delete;
+	FileMapping(FileMapping &&) = delete;
+	FileMapping &operator=(const FileMapping &) = delete;
+	FileMapping &operator=(FileMapping &&) = delete;
+	~FileMapping() {
+#if defined(__unix__) || defined(__APPLE__)
+		if (view) {
+			munmap(view, length);
+		}
+#else
+		if (view) {
+			::UnmapViewOfFile(view);
+		}
+		if (hMapping) {
+			::CloseHandle(hMapping);
+		}
+#endif
+	}
+	char *Data() const noexcept {
+		return view;
+	}
+	size_t Length() const noexcept {
+		return length;
+	}
+};
+
+}
+
 FileWorker::FileWorker(WorkerListener *pListener_, const FilePath &path_, size_t size_, FILE *fp_) :
 	pListener(pListener_), path(path_), size(size_), err(0), fp(fp_), sleepTime(0), nextProgress(timeBetweenProgress) {
 }
@@ -40,36 +123,17 @@ double FileWorker::Duration() noexcept {
 	return et.Duration();
 }
 
-FileLoader::FileLoader(WorkerListener *pListener_, Scintilla::ILoader *pLoader_, const FilePath &path_, size_t size_, FILE *fp_) :
-	FileWorker(pListener_, path_, size_, fp_), pLoader(pLoader_), readSoFar(0), unicodeMode(UniMode::uni8Bit) {
+FileLoader::FileLoader(WorkerListener *pListener_, Scintilla::ILoader *pLoader_, const FilePath &path_, size_t size_, FILE *fp_, bool mapped_) :
+	FileWorker(pListener_, path_, size_, fp_), pLoader(pLoader_), readSoFar(0), unicodeMode(UniMode::uni8Bit), mapped(mapped_) {
 	SetSizeJob(size);
 }
 
 void FileLoader::Execute() {
 	if (fp) {
 		Utf8_16_Read convert;
-		std::vector<char> data(blockSize);
-		size_t lenFile = fread(&data[0], 1, blockSize, fp);
-		const UniMode umCodingCookie = CodingCookieValue(std::string_view(data.data(), lenFile));
-		while ((lenFile > 0) && (err == 0) && (!Cancelling())) {
-			GUI::SleepMilliseconds(sleepTime);
-			lenFile = convert.convert(&data[0], lenFile);
-			const char *dataBlock = convert.getNewBuf();
-			err = pLoader->AddData(dataBlock, lenFile);
-			IncrementProgress(lenFile);
-			if (et.Duration() > nextProgress) {
-				nextProgress = et.Duration() + timeBetweenProgress;
-				pListener->PostOnMainThread(WORK_FILEPROGRESS, this);
-			}
-			lenFile = fread(&data[0], 1, blockSize, fp);
-			if ((lenFile == 0) && (err == 0)) {
-				// Handle case where convert is holding a lead surrogate but no more data
-				const size_t lenFileTrail = convert.convert(nullptr, lenFile);
-				if (lenFileTrail) {
-					const char *dataTrail = convert.getNewBuf();
-					err = pLoader->AddData(dataTrail, lenFileTrail);
-				}
-			}
+		UniMode umCodingCookie = UniMode::uni8Bit;
+		if (!(mapped && ReadMapped(convert, umCodingCookie))) {
+			ReadBlocks(convert, umCodingCookie);
 		}
 		fclose(fp);
 		fp = nullptr;
@@ -84,6 +148,61 @@ void FileLoader::Execute() {
 	pListener->PostOnMainThread(WORK_FILEREAD, this);
 }
 
+void FileLoader::AddBlock(Utf8_16_Read &convert, char *data, size_t lenData) {
+	GUI::SleepMilliseconds(sleepTime);
+	const size_t lenConverted = convert.convert(data, lenData);
+	const char *dataBlock = convert.getNewBuf();
+	err = pLoader->AddData(dataBlock, lenConverted);
+	IncrementProgress(lenConverted);
+	if (et.Duration() > nextProgress) {
+		nextProgress = et.Duration() + timeBetweenProgress;
+		pListener->PostOnMainThread(WORK_FILEPROGRESS, this);
+	}
+}
+
+void FileLoader::AddTrail(Utf8_16_Read &convert) {
+	// Handle case where convert is holding a lead surrogate but no more data
+	const size_t lenFileTrail = convert.convert(nullptr, 0);
+	if (lenFileTrail) {
+		const char *dataTrail = convert.getNewBuf();
+		err = pLoader->AddData(dataTrail, lenFileTrail);
+	}
+}
+
+void FileLoader::ReadBlocks(Utf8_16_Read &convert, UniMode &umCodingCookie) {
+	std::vector<char> data(blockSize);
+	size_t lenFile = fread(&data[0], 1, blockSize, fp);
+	umCodingCookie = CodingCookieValue(std::string_view(data.data(), lenFile));
+	while ((lenFile > 0) && (err == 0) && (!Cancelling())) {
+		AddBlock(convert, &data[0], lenFile);
+		lenFile = fread(&data[0], 1, blockSize, fp);
+		if ((lenFile == 0) && (err == 0)) {
+			AddTrail(convert);
+		}
+	}
+}
+
+bool FileLoader::ReadMapped(Utf8_16_Read &convert, UniMode &umCodingCookie) {
+	// Feed the loader directly from a view of the file, avoiding the copy into a read buffer.
+	// The whole file is mapped at once so this is only worthwhile for 64-bit builds.
+	const FileMapping mapping(fp, size);
+	char *view = mapping.Data();
+	if (!view) {
+		return false;
+	}
+	const size_t lenView = mapping.Length();
+	umCodingCookie = CodingCookieValue(std::string_view(view, std::min(lenView, blockSize)));
+	for (size_t position = 0; (position < lenView) && (err == 0) && (!Cancelling());) {
+		const size_t lenBlock = std::min(lenView - position, mappedBlockSize);
+		AddBlock(convert, view + position, lenBlock);
+		position += lenBlock;
+		if ((position == lenView) && (err == 0)) {
+			AddTrail(convert);
+		}
+	}
+	return true;
+}
+
 void FileLoader::Cancel() {
 	FileWorker::Cancel();
 	pLoader->Release();
@@ -11,6 +11,8 @@
 /// Base size of file I/O operations.
 constexpr size_t blockSize = 128 * 1024;
 
+class Utf8_16_Read;
+
 struct FileWorker : public Worker {
 	WorkerListener *pListener;
 	FilePath path;
@@ -35,13 +37,19 @@ public:
 	Scintilla::ILoader *pLoader;
 	size_t readSoFar;
 	UniMode unicodeMode;
+	bool mapped;
 
-	FileLoader(WorkerListener *pListener_, Scintilla::ILoader *pLoader_, const FilePath &path_, size_t size_, FILE *fp_);
+	FileLoader(WorkerListener *pListener_, Scintilla::ILoader *pLoader_, const FilePath &path_, size_t size_, FILE *fp_, bool mapped_=false);
 	void Execute() override;
 	void Cancel() override;
 	bool IsLoading() const noexcept override {
 		return true;
 	}
+private:
+	void AddBlock(Utf8_16_Read &convert, char *data, size_t lenData);
+	void AddTrail(Utf8_16_Read &convert);
+	void ReadBlocks(Utf8_16_Read &convert, UniMode &umCodingCookie);
+	bool ReadMapped(Utf8_16_Read &convert, UniMode &umCodingCookie);
 };
 
 class FileStorer : public FileWorker {
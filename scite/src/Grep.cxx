@@ -0,0 +1,153 @@
+// SciTE - Scintilla based Text Editor
+/** @file Grep.cxx
+ ** Search files for a literal string on several threads.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstring>
+#include <cstdio>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <deque>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <system_error>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "GUI.h"
+#include "StringHelpers.h"
+#include "Grep.h"
+
+namespace {
+
+// Files are read in large blocks and only complete lines are searched so that matches
+// can be found over a whole block instead of line by line.
+constexpr size_t grepBlockSize = 1024 * 1024;
+// Only this much of the start of a file is examined to decide whether it is binary.
+constexpr size_t grepBinaryCheckLength = 64 * 1024;
+
+constexpr bool IsWordCharacter(int ch) noexcept {
+	return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z')  || (ch >= '0' && ch <= '9')  || (ch == '_');
+}
+
+constexpr bool IsLineEndChar(char ch) noexcept {
+	return ch == '\r' || ch == '\n';
+}
+
+// Counts lines ended in a range with "\r\n", "\r", and "\n" each ending one line.
+// A '\r' at the end of the range is counted as it is never followed by a '\n' in this file.
+int CountLineEnds(const char *start, const char *end) noexcept {
+	int lines = 0;
+	for (const char *p = start; p < end; p++) {
+		if (*p == '\n') {
+			lines++;
+		} else if (*p == '\r') {
+			if ((p + 1 == end) || (p[1] != '\n')) {
+				lines++;
+			}
+		}
+	}
+	return lines;
+}
+
+// Appends the lines of a block of complete lines that contain a match to os.
+// The shown and compared part of a line ends at any NUL.
+void GrepLines(const char *start, const char *end, int &lineNumber, const LiteralMatcher &matcher,
+	bool wholeWord, std::string_view fileName, std::string &os) {
+	const size_t searchLength = matcher.Length();
+	const char *counted = start;
+	const char *p = start;
+	// Each search starts at or after the previous one so share what has been scanned
+	LiteralMatcher::FindState state;
+	while (p < end) {
+		const char *match = matcher.Find(p, end, state);
+		if (!match) {
+			break;
+		}
+		const char *lineStart = match;
+		while ((lineStart > p) && !IsLineEndChar(lineStart[-1])) {
+			lineStart--;
+		}
+		const char *lineEnd = match;
+		while ((lineEnd < end) && !IsLineEndChar(*lineEnd)) {
+			lineEnd++;
+		}
+		const char *nul = static_cast<const char *>(memchr(lineStart, '\0', lineEnd - lineStart));
+		const char *lineContent = nul ? nul : lineEnd;
+		bool found = false;
+		for (const char *m = match; m && (m + searchLength <= lineContent); m = matcher.Find(m + 1, lineContent, state)) {
+			if (!wholeWord ||
+				(((m == lineStart) || !IsWordCharacter(m[-1])) &&
+				((m + searchLength == lineContent) || !IsWordCharacter(m[searchLength])))) {
+				found = true;
+				break;
+			}
+		}
+		if (found) {
+			lineNumber += CountLineEnds(counted, lineStart);
+			counted = lineStart;
+			os.append(fileName);
+			os.append(":");
+			os.append(StdStringFromInteger(lineNumber));
+			os.append(":");
+			os.append(lineStart, lineContent - lineStart);
+			os.append("\n");
+		}
+		p = (lineEnd < end) ? lineEnd + 1 : end;
+	}
+	lineNumber += CountLineEnds(counted, end);
+}
+
+}
+
+std::string GrepFile(FILE *fp, std::string_view fileName, const LiteralMatcher &matcher,
+	bool wholeWord, bool binary, const std::function<bool()> &cancelled) {
+	std::string os;
+	std::vector<char> data(grepBlockSize);
+	size_t valid = 0;
+	int lineNumber = 1;
+	bool checkedBinary = false;
+	bool atEnd = false;
+	while (!atEnd) {
+		if (cancelled()) {
+			return std::string();
+		}
+		if (valid == data.size()) {
+			// A line longer than the buffer
+			data.resize(data.size() * 2);
+		}
+		const size_t lenRead = fread(data.data() + valid, 1, data.size() - valid, fp);
+		atEnd = lenRead == 0;
+		valid += lenRead;
+		if (!checkedBinary) {
+			checkedBinary = true;
+			if (!binary && memchr(data.data(), '\0', std::min(valid, grepBinaryCheckLength))) {
+				return os;
+			}
+		}
+		// Search up to the last line end but hold back a final '\r' as it may be followed by '\n'.
+		size_t complete = valid;
+		if (!atEnd) {
+			complete = 0;
+			for (size_t i = valid; i > 0; i--) {
+				if ((data[i - 1] == '\n') || ((data[i - 1] == '\r') && (i < valid))) {
+					complete = i;
+					break;
+				}
+			}
+		}
+		if (complete > 0) {
+			GrepLines(data.data(), data.data() + complete, lineNumber, matcher, wholeWord, fileName, os);
+			memmove(data.data(), data.data() + complete, valid - complete);
+			valid -= complete;
+		}
+	}
+	return os;
+}
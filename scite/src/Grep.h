@@ -0,0 +1,132 @@
+// SciTE - Scintilla based Text Editor
+/** @file Grep.h
+ ** Search files for a literal string on several threads.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef GREP_H
+#define GREP_H
+
+// Files discovered but not yet searched are limited so walking a huge tree does not use much memory.
+constexpr size_t grepQueueLimit = 256;
+
+// Searches the rest of fp, returning the lines containing matches as "fileName:line:text\n".
+// Returns an empty string for binary files unless binary is set and when cancelled returns true.
+std::string GrepFile(FILE *fp, std::string_view fileName, const LiteralMatcher &matcher,
+	bool wholeWord, bool binary, const std::function<bool()> &cancelled);
+
+// Holds files waiting to be searched and the results of searches that finished before
+// all earlier files so that output appears in the same order as a sequential search.
+template <typename Item>
+class GrepPipeline {
+	std::function<bool()> cancelled;
+	std::function<void(const std::string &)> output;
+	std::mutex mutexQueue;
+	std::condition_variable cvQueued;
+	std::condition_variable cvTaken;
+	std::deque<std::pair<size_t, Item>> queue;
+	size_t queueLimit = grepQueueLimit;
+	size_t itemsAdded = 0;
+	bool finished = false;
+	std::mutex mutexResults;
+	std::map<size_t, std::string> results;
+	size_t nextOutput = 0;
+public:
+	GrepPipeline(std::function<bool()> cancelled_, std::function<void(const std::string &)> output_) :
+		cancelled(std::move(cancelled_)), output(std::move(output_)) {
+	}
+	// Deleted so GrepPipeline objects can not be copied.
+	GrepPipeline(const GrepPipeline &) = delete;
+	bool Cancelled() const {
+		return cancelled();
+	}
+	// Waits while the queue is full. Returns false when the search has been cancelled.
+	bool Add(const Item &item) {
+		std::unique_lock<std::mutex> lock(mutexQueue);
+		while (queue.size() >= queueLimit) {
+			if (cancelled()) {
+				return false;
+			}
+			cvTaken.wait_for(lock, std::chrono::milliseconds(100));
+		}
+		queue.emplace_back(itemsAdded++, item);
+		cvQueued.notify_one();
+		return !cancelled();
+	}
+	// When there are no threads to take files, all must be queued.
+	void RemoveLimit() {
+		std::lock_guard<std::mutex> lock(mutexQueue);
+		queueLimit = SIZE_MAX;
+	}
+	// Called by the thread walking the directories after all files have been added.
+	void Finish() {
+		std::lock_guard<std::mutex> lock(mutexQueue);
+		finished = true;
+		cvQueued.notify_all();
+	}
+	// Returns the next file to search or nothing when all have been taken.
+	std::optional<std::pair<size_t, Item>> Take() {
+		std::unique_lock<std::mutex> lock(mutexQueue);
+		cvQueued.wait(lock, [this] { return finished || !queue.empty(); });
+		if (queue.empty()) {
+			return {};
+		}
+		std::pair<size_t, Item> item = std::move(queue.front());
+		queue.pop_front();
+		cvTaken.notify_one();
+		return item;
+	}
+	// Records the result for a file and outputs all results now available in order.
+	void Complete(size_t index, std::string &&result) {
+		std::lock_guard<std::mutex> lock(mutexResults);
+		results.emplace(index, std::move(result));
+		std::string os;
+		for (auto it = results.begin(); it != results.end() && it->first == nextOutput; it = results.erase(it)) {
+			os.append(it->second);
+			nextOutput++;
+		}
+		if (!os.empty() && !cancelled()) {
+			output(os);
+		}
+	}
+};
+
+// Calls walk, which adds the files to search to pipeline, on this thread while threadCount
+// threads search them with search. When no threads can be started, the files are
+// searched on this thread after walk returns.
+template <typename Item>
+void GrepConcurrently(GrepPipeline<Item> &pipeline, unsigned int threadCount,
+	const std::function<void()> &walk, const std::function<std::string(const Item &)> &search) {
+	auto searchFiles = [&pipeline, &search]() {
+		while (std::optional<std::pair<size_t, Item>> item = pipeline.Take()) {
+			std::string os;
+			if (!pipeline.Cancelled()) {
+				os = search(item->second);
+			}
+			pipeline.Complete(item->first, std::move(os));
+		}
+	};
+	std::vector<std::thread> searchers;
+	try {
+		for (unsigned int i = 0; i < threadCount; i++) {
+			searchers.emplace_back(searchFiles);
+		}
+	} catch (std::system_error &) {
+		// Continue with the threads that were started
+	}
+	if (searchers.empty()) {
+		// No threads so search the files after all have been found.
+		pipeline.RemoveLimit();
+		walk();
+		pipeline.Finish();
+		searchFiles();
+	} else {
+		walk();
+		pipeline.Finish();
+		for (std::thread &searcher : searchers) {
+			searcher.join();
+		}
+	}
+}
+
+#endif
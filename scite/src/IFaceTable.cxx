@@ -2388,6 +2388,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_GETHSCROLLBAR",2131},
 	{"SCI_GETIDENTIFIER",2623},
 	{"SCI_GETIDLESTYLING",2693},
+	{"SCI_GETIDLESTYLINGTHREADED",2783},
 	{"SCI_GETIMEINTERACTION",2678},
 	{"SCI_GETINDENT",2123},
 	{"SCI_GETINDENTATIONGUIDES",2133},
@@ -2435,6 +2436,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_GETPASTECONVERTENDINGS",2468},
 	{"SCI_GETPHASESDRAW",2673},
 	{"SCI_GETPOSITIONCACHE",2515},
+	{"SCI_GETPOSITIONCACHESTATISTIC",2784},
 	{"SCI_GETPRIMARYSTYLEFROMSTYLE",4028},
 	{"SCI_GETPRINTCOLOURMODE",2149},
 	{"SCI_GETPRINTMAGNIFICATION",2147},
@@ -2491,6 +2493,8 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_GETTECHNOLOGY",2631},
 	{"SCI_GETTEXTLENGTH",2183},
 	{"SCI_GETUNDOCOLLECTION",2019},
+	{"SCI_GETUNDOMEMORYLIMIT",2786},
+	{"SCI_GETUNDOMEMORYUSED",2787},
 	{"SCI_GETUSETABS",2125},
 	{"SCI_GETVIEWEOL",2355},
 	{"SCI_GETVIEWWS",2020},
@@ -2603,6 +2607,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_SETIDENTIFIER",2622},
 	{"SCI_SETIDENTIFIERS",4024},
 	{"SCI_SETIDLESTYLING",2692},
+	{"SCI_SETIDLESTYLINGTHREADED",2782},
 	{"SCI_SETILEXER",4033},
 	{"SCI_SETIMEINTERACTION",2679},
 	{"SCI_SETINDENT",2122},
@@ -2677,6 +2682,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SCI_SETTARGETSTARTVIRTUALSPACE",2728},
 	{"SCI_SETTECHNOLOGY",2630},
 	{"SCI_SETUNDOCOLLECTION",2012},
+	{"SCI_SETUNDOMEMORYLIMIT",2785},
 	{"SCI_SETUSETABS",2124},
 	{"SCI_SETVIEWEOL",2356},
 	{"SCI_SETVIEWWS",2021},
@@ -2966,6 +2972,7 @@ static IFaceConstant ifaceConstants[] = {
 	{"SC_CURSORREVERSEARROW",7},
 	{"SC_CURSORWAIT",4},
 	{"SC_DOCUMENTOPTION_DEFAULT",0},
+	{"SC_DOCUMENTOPTION_STYLES_LAZY",0x2},
 	{"SC_DOCUMENTOPTION_STYLES_NONE",0x1},
 	{"SC_DOCUMENTOPTION_TEXT_LARGE",0x100},
 	{"SC_EFF_QUALITY_ANTIALIASED",2},
@@ -3133,6 +3140,9 @@ static IFaceConstant ifaceConstants[] = {
 	{"SC_POPUP_ALL",1},
 	{"SC_POPUP_NEVER",0},
 	{"SC_POPUP_TEXT",2},
+	{"SC_POSITIONCACHE_EVICTIONS",2},
+	{"SC_POSITIONCACHE_HITS",0},
+	{"SC_POSITIONCACHE_MISSES",1},
 	{"SC_PRINT_BLACKONWHITE",2},
 	{"SC_PRINT_COLOURONWHITE",3},
 	{"SC_PRINT_COLOURONWHITEDEFAULTBG",4},
@@ -3440,6 +3450,7 @@ static IFaceFunction ifaceFunctions[] = {
 	{"ReleaseAllExtendedStyles", 2552, iface_void, {iface_void, iface_void}},
 	{"ReleaseDocument", 2377, iface_void, {iface_void, iface_pointer}},
 	{"ReleaseLineCharacterIndex", 2712, iface_void, {iface_int, iface_void}},
+	{"ReplaceRanges", 2788, iface_position, {iface_position, iface_pointer}},
 	{"ReplaceRectangular", 2771, iface_void, {iface_length, iface_string}},
 	{"ReplaceSel", 2170, iface_void, {iface_void, iface_string}},
 	{"ReplaceTarget", 2194, iface_position, {iface_length, iface_string}},
@@ -3451,6 +3462,9 @@ static IFaceFunction ifaceFunctions[] = {
 	{"ScrollRange", 2569, iface_void, {iface_position, iface_position}},
 	{"ScrollToEnd", 2629, iface_void, {iface_void, iface_void}},
 	{"ScrollToStart", 2628, iface_void, {iface_void, iface_void}},
+	{"SearchAllCancel", 2791, iface_void, {iface_int, iface_void}},
+	{"SearchAllInTarget", 2789, iface_int, {iface_length, iface_string}},
+	{"SearchAllNext", 2790, iface_position, {iface_int, iface_void}},
 	{"SearchAnchor", 2366, iface_void, {iface_void, iface_void}},
 	{"SearchInTarget", 2197, iface_position, {iface_length, iface_string}},
 	{"SearchNext", 2367, iface_position, {iface_int, iface_string}},
@@ -3637,6 +3651,7 @@ static IFaceProperty ifaceProperties[] = {
 	{"Identifier", 2623, 2622, iface_int, iface_void},
 	{"Identifiers", 0, 4024, iface_string, iface_int},
 	{"IdleStyling", 2693, 2692, iface_int, iface_void},
+	{"IdleStylingThreaded", 2783, 2782, iface_bool, iface_void},
 	{"Indent", 2123, 2122, iface_int, iface_void},
 	{"IndentationGuides", 2133, 2132, iface_int, iface_void},
 	{"IndicAlpha", 2524, 2523, iface_int, iface_int},
@@ -3707,6 +3722,7 @@ static IFaceProperty ifaceProperties[] = {
 	{"PasteConvertEndings", 2468, 2467, iface_bool, iface_void},
 	{"PhasesDraw", 2673, 2674, iface_int, iface_void},
 	{"PositionCache", 2515, 2514, iface_int, iface_void},
+	{"PositionCacheStatistic", 2784, 0, iface_position, iface_int},
 	{"PrimaryStyleFromStyle", 4028, 0, iface_int, iface_int},
 	{"PrintColourMode", 2149, 2148, iface_int, iface_void},
 	{"PrintMagnification", 2147, 2146, iface_int, iface_void},
@@ -3784,6 +3800,8 @@ static IFaceProperty ifaceProperties[] = {
 	{"Technology", 2631, 2630, iface_int, iface_void},
 	{"TextLength", 2183, 0, iface_position, iface_void},
 	{"UndoCollection", 2019, 2012, iface_bool, iface_void},
+	{"UndoMemoryLimit", 2786, 2785, iface_position, iface_void},
+	{"UndoMemoryUsed", 2787, 0, iface_position, iface_void},
 	{"UseTabs", 2125, 2124, iface_bool, iface_void},
 	{"VScrollBar", 2281, 2280, iface_bool, iface_void},
 	{"ViewEOL", 2355, 2356, iface_bool, iface_void},
@@ -3802,9 +3820,9 @@ static IFaceProperty ifaceProperties[] = {
 };
 
 enum {
-	ifaceFunctionCount = 326,
-	ifaceConstantCount = 3076,
-	ifacePropertyCount = 264
+	ifaceFunctionCount = 330,
+	ifaceConstantCount = 3085,
+	ifacePropertyCount = 268
 };
 
 //--Autogenerated
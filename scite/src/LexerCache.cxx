@@ -0,0 +1,186 @@
+// SciTE - Scintilla based Text Editor
+/** @file LexerCache.cxx
+ ** Save and restore the results of lexing a document to avoid lexing it again when reopened.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+#include "GUI.h"
+
+#include "FilePath.h"
+#include "LexerCache.h"
+
+namespace {
+
+// Constants from xxHash64 which mixes 8 bytes at a time so is fast enough to
+// hash large documents while being well distributed.
+constexpr uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t prime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+constexpr uint64_t RotateLeft(uint64_t value, int bits) noexcept {
+	return (value << bits) | (value >> (64 - bits));
+}
+
+constexpr uint64_t Round(uint64_t value) noexcept {
+	return RotateLeft(value * prime2, 31) * prime1;
+}
+
+// Cache file layout, all in native byte order which is checked by byteOrderMark:
+// magic, version, byteOrderMark, contentHash, contentLength, settingsHash, styledLength, lines,
+// styles[styledLength], lineStates[lines], foldLevels[lines], checksum.
+// The checksum covers styles, line states, and fold levels to detect truncated files.
+constexpr char magic[8] = { 'S', 'c', 'i', 'T', 'E', 'L', 'e', 'x' };
+constexpr uint32_t version = 2;
+constexpr uint32_t byteOrderMark = 0x01020304;
+
+struct Header {
+	char magic[8] {};
+	uint32_t version = 0;
+	uint32_t byteOrderMark = 0;
+	uint64_t contentHash = 0;
+	uint64_t contentLength = 0;
+	uint64_t settingsHash = 0;
+	uint64_t styledLength = 0;
+	uint64_t lines = 0;
+};
+
+static_assert(sizeof(int) == 4, "Line states and fold levels are written as 4 byte values");
+
+std::string_view BytesOf(const std::vector<int> &values) noexcept {
+	return std::string_view(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(int));
+}
+
+uint64_t Checksum(const LexerCacheEntry &entry) noexcept {
+	uint64_t checksum = HashBytes(entry.styles);
+	checksum = HashBytes(BytesOf(entry.lineStates), checksum);
+	return HashBytes(BytesOf(entry.foldLevels), checksum);
+}
+
+bool WriteBytes(FILE *fp, std::string_view bytes) noexcept {
+	return fwrite(bytes.data(), 1, bytes.length(), fp) == bytes.length();
+}
+
+bool ReadBytes(FILE *fp, void *data, size_t length) noexcept {
+	return fread(data, 1, length, fp) == length;
+}
+
+bool ReadHeader(FILE *fp, const LexerCacheKey &key, Header &header) noexcept {
+	return ReadBytes(fp, &header, sizeof(header)) &&
+		(memcmp(header.magic, magic, sizeof(magic)) == 0) &&
+		(header.version == version) &&
+		(header.byteOrderMark == byteOrderMark) &&
+		(header.contentHash == key.contentHash) &&
+		(header.contentLength == key.contentLength) &&
+		(header.settingsHash == key.settingsHash) &&
+		(header.styledLength > 0) && (header.styledLength <= header.contentLength) &&
+		(header.lines > 0) && (header.lines <= header.styledLength + 1);
+}
+
+}
+
+uint64_t HashBytes(std::string_view data, uint64_t seed) noexcept {
+	uint64_t hash = seed + prime5 + data.length();
+	while (data.length() >= 8) {
+		uint64_t block = 0;
+		memcpy(&block, data.data(), sizeof(block));
+		hash ^= Round(block);
+		hash = RotateLeft(hash, 27) * prime1 + prime4;
+		data.remove_prefix(8);
+	}
+	for (const char ch : data) {
+		hash ^= static_cast<unsigned char>(ch) * prime5;
+		hash = RotateLeft(hash, 11) * prime1;
+	}
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+GUI::gui_string LexerCacheKey::FileName() const {
+	char name[64] {};
+	snprintf(name, sizeof(name), "%016llx-%016llx.lexcache",
+		static_cast<unsigned long long>(contentHash),
+		static_cast<unsigned long long>(settingsHash));
+	return GUI::StringFromUTF8(name);
+}
+
+bool WriteLexerCache(const FilePath &path, const LexerCacheKey &key, const LexerCacheEntry &entry) {
+	if (entry.styles.empty() || (entry.styles.length() > key.contentLength) ||
+		entry.lineStates.empty() || (entry.lineStates.size() != entry.foldLevels.size())) {
+		return false;
+	}
+	FileHolder fp(path.Open(fileWrite));
+	if (!fp) {
+		return false;
+	}
+	Header header;
+	memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.byteOrderMark = byteOrderMark;
+	header.contentHash = key.contentHash;
+	header.contentLength = key.contentLength;
+	header.settingsHash = key.settingsHash;
+	header.styledLength = entry.styles.length();
+	header.lines = entry.lineStates.size();
+	const uint64_t checksum = Checksum(entry);
+	const bool written = WriteBytes(fp.get(), std::string_view(reinterpret_cast<const char *>(&header), sizeof(header))) &&
+		WriteBytes(fp.get(), entry.styles) &&
+		WriteBytes(fp.get(), BytesOf(entry.lineStates)) &&
+		WriteBytes(fp.get(), BytesOf(entry.foldLevels)) &&
+		WriteBytes(fp.get(), std::string_view(reinterpret_cast<const char *>(&checksum), sizeof(checksum)));
+	if (fclose(fp.release()) != 0 || !written) {
+		// Do not leave a partial file that would be rejected on every read
+		path.Remove();
+		return false;
+	}
+	return true;
+}
+
+bool ReadLexerCache(const FilePath &path, const LexerCacheKey &key, LexerCacheEntry &entry) {
+	FileHolder fp(path.Open(fileRead));
+	if (!fp) {
+		return false;
+	}
+	Header header;
+	if (!ReadHeader(fp.get(), key, header)) {
+		return false;
+	}
+	entry.styles.resize(static_cast<size_t>(header.styledLength));
+	entry.lineStates.resize(static_cast<size_t>(header.lines));
+	entry.foldLevels.resize(static_cast<size_t>(header.lines));
+	uint64_t checksum = 0;
+	if (!ReadBytes(fp.get(), entry.styles.data(), entry.styles.length()) ||
+		!ReadBytes(fp.get(), entry.lineStates.data(), entry.lineStates.size() * sizeof(int)) ||
+		!ReadBytes(fp.get(), entry.foldLevels.data(), entry.foldLevels.size() * sizeof(int)) ||
+		!ReadBytes(fp.get(), &checksum, sizeof(checksum)) ||
+		(fgetc(fp.get()) != EOF) ||
+		(checksum != Checksum(entry))) {
+		entry = LexerCacheEntry();
+		return false;
+	}
+	return true;
+}
+
+uint64_t LexerCacheStyledLength(const FilePath &path, const LexerCacheKey &key) {
+	FileHolder fp(path.Open(fileRead));
+	Header header;
+	if (!fp || !ReadHeader(fp.get(), key, header)) {
+		return 0;
+	}
+	return header.styledLength;
+}
@@ -0,0 +1,35 @@
+// SciTE - Scintilla based Text Editor
+/** @file LexerCache.h
+ ** Save and restore the results of lexing a document to avoid lexing it again when reopened.
+ **/
+// The License.txt file describes the conditions under which this software may be distributed.
+
+#ifndef LEXERCACHE_H
+#define LEXERCACHE_H
+
+uint64_t HashBytes(std::string_view data, uint64_t seed = 0) noexcept;
+
+// Identifies the lexing of a particular text with a particular lexer configuration.
+struct LexerCacheKey {
+	uint64_t contentHash = 0;
+	uint64_t contentLength = 0;
+	uint64_t settingsHash = 0;
+	GUI::gui_string FileName() const;
+};
+
+// Styles for each byte and line states and fold levels for each line from the start
+// of the document. When the document was not lexed to its end, the styles stop at
+// the start of the line after the last line.
+struct LexerCacheEntry {
+	std::string styles;
+	std::vector<int> lineStates;
+	std::vector<int> foldLevels;
+};
+
+bool WriteLexerCache(const FilePath &path, const LexerCacheKey &key, const LexerCacheEntry &entry);
+// Only succeeds when the file was written for key and is complete.
+bool ReadLexerCache(const FilePath &path, const LexerCacheKey &key, LexerCacheEntry &entry);
+// Number of styled bytes in the file written for key or 0 when there is no valid file.
+uint64_t LexerCacheStyledLength(const FilePath &path, const LexerCacheKey &key);
+
+#endif
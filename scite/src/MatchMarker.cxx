@@ -5,12 +5,15 @@
 // Copyright 1998-2011 by Neil Hodgson <neilh@scintilla.org>
 // The License.txt file describes the conditions under which this software may be distributed.
 
+#include <cstring>
+
 #include <string>
 #include <string_view>
 #include <vector>
 #include <set>
 #include <optional>
 #include <algorithm>
+#include <memory>
 #include <chrono>
 
 #include "ScintillaTypes.h"
@@ -18,6 +21,7 @@
 
 #include "GUI.h"
 
+#include "StringHelpers.h"
 #include "MatchMarker.h"
 
 namespace SA = Scintilla;
@@ -45,13 +49,20 @@ std::vector<LineRange> LinesBreak(SA::ScintillaCall *pSci) {
 }
 
 MatchMarker::MatchMarker() :
-	pSci(nullptr), styleMatch(-1), flagsMatch(static_cast<SA::FindOption>(0)), indicator(0), bookMark(-1) {
+	pSci(nullptr), styleMatch(-1), flagsMatch(static_cast<SA::FindOption>(0)), indicator(0), bookMark(-1),
+	backgroundSize(0), background(false), searchBackground(0), restartBackground(false), waiting(false) {
+}
+
+MatchMarker::~MatchMarker() = default;
+
+void MatchMarker::SetBackgroundSize(SA::Position backgroundSize_) noexcept {
+	backgroundSize = backgroundSize_;
 }
 
 void MatchMarker::StartMatch(SA::ScintillaCall *pSci_,
 			     const std::string &textMatch_, SA::FindOption flagsMatch_, int styleMatch_,
 			     int indicator_, int bookMark_, std::optional<Scintilla::Line> showContext_) {
-	lineRanges.clear();
+	Stop();
 	pSci = pSci_;
 	textMatch = textMatch_;
 	flagsMatch = flagsMatch_;
@@ -61,17 +72,90 @@ void MatchMarker::StartMatch(SA::ScintillaCall *pSci_,
 	showContext = showContext_;
 	lineRanges = LinesBreak(pSci);
 	matches.clear();
+	restartBackground = false;
+	background = (backgroundSize > 0) && !textMatch.empty() && (pSci->Length() >= backgroundSize);
 	// Perform the initial marking immediately to avoid flashing
 	Continue();
 }
 
+void MatchMarker::StartBackground() {
+	const LineRange rangeSearch = lineRanges[0];
+	const SA::Position positionStart = pSci->LineStart(rangeSearch.lineStart);
+	const SA::Position positionEnd = pSci->LineStart(rangeSearch.lineEnd);
+	pSci->SetSearchFlags(flagsMatch);
+	pSci->SetTarget(SA::Span(positionStart, positionEnd));
+	searchBackground = pSci->SearchAllInTarget(textMatch.length(), textMatch.c_str());
+	if (searchBackground) {
+		pSci->SetIndicatorCurrent(indicator);
+		pSci->IndicatorClearRange(positionStart, positionEnd - positionStart);
+	} else {
+		// Regular expressions and DBCS can not be searched on a thread so search in idle time
+		background = false;
+	}
+}
+
+void MatchMarker::ContinueBackground() {
+	waiting = false;
+	// Limit the time spent marking so the user is not blocked when there are many matches
+	GUI::ElapsedTime markElapsedTime;
+	pSci->SetIndicatorCurrent(indicator);
+	SA::Position positionFound = pSci->SearchAllNext(searchBackground);
+	while (positionFound >= 0) {
+		const SA::Span rangeFound(positionFound, pSci->TargetEnd());
+		if ((styleMatch < 0) || (styleMatch == pSci->UnsignedStyleAt(rangeFound.start))) {
+			MarkMatch(rangeFound);
+		}
+		if (markElapsedTime.Duration() > 0.05) {
+			return;
+		}
+		positionFound = pSci->SearchAllNext(searchBackground);
+	}
+	if (positionFound == -1) {
+		// No matches ready so the application should wait a while before continuing
+		waiting = true;
+		return;
+	}
+	searchBackground = 0;
+	lineRanges.erase(lineRanges.begin());
+	if (!lineRanges.empty()) {
+		StartBackground();
+	} else if (showContext) {
+		ShowContext();
+	}
+}
+
 bool MatchMarker::Complete() const noexcept {
 	return lineRanges.empty();
 }
 
+bool MatchMarker::Waiting() const noexcept {
+	return searchBackground && waiting;
+}
+
+void MatchMarker::MarkMatch(SA::Span rangeFound) {
+	pSci->IndicatorFillRange(rangeFound.start, rangeFound.Length());
+	const SA::Line line = pSci->LineFromPosition(rangeFound.start);
+	if ((bookMark >= 0) && (showContext != 0)) {
+		pSci->MarkerAdd(line, bookMark);
+	}
+	if (showContext >= 0) {
+		matches.insert(line);
+	}
+}
+
 void MatchMarker::Continue() {
 	constexpr int segment = 2000;
 
+	if (restartBackground) {
+		// The text was modified so search the remaining lines on a thread again
+		restartBackground = false;
+		StartBackground();
+	}
+	if (searchBackground) {
+		ContinueBackground();
+		return;
+	}
+
 	// Remove old indicators if any exist.
 	pSci->SetIndicatorCurrent(indicator);
 
@@ -101,14 +185,7 @@ void MatchMarker::Continue() {
 		}
 
 		if ((styleMatch < 0) || (styleMatch == pSci->UnsignedStyleAt(rangeFound.start))) {
-			pSci->IndicatorFillRange(rangeFound.start, rangeFound.Length());
-			const SA::Line line = pSci->LineFromPosition(rangeFound.start);
-			if ((bookMark >= 0) && (showContext != 0)) {
-				pSci->MarkerAdd(line, bookMark);
-			}
-			if (showContext >= 0) {
-				matches.insert(line);
-			}
+			MarkMatch(rangeFound);
 		}
 		if (rangeFound.Length() == 0) {
 			// Empty matches are possible for regex
@@ -128,43 +205,82 @@ void MatchMarker::Continue() {
 			lineRanges[0].lineStart = lineEndSegment;
 		}
 	}
+	if (background && !lineRanges.empty()) {
+		// The lines near the caret have been marked so search the rest on a thread
+		StartBackground();
+	}
 	if (lineRanges.empty() && showContext) {
-		// Hide / show lines so that matches and their context are visible
-		// Could do this incrementally but there are problems near segment edges
-		const SA::Line lineCount = pSci->LineCount();
-		std::vector<bool> visible(lineCount);
-		for (const SA::Line line : matches) {
-			for (SA::Line context = line - *showContext; context <= line + *showContext; context++) {
-				if (context >= 0 && context < lineCount) {
-					visible[context] = true;
-				}
+		ShowContext();
+	}
+}
+
+void MatchMarker::ShowContext() {
+	// Hide / show lines so that matches and their context are visible
+	// Could do this incrementally but there are problems near segment edges
+	const SA::Line lineCount = pSci->LineCount();
+	std::vector<bool> visible(lineCount);
+	for (const SA::Line line : matches) {
+		for (SA::Line context = line - *showContext; context <= line + *showContext; context++) {
+			if (context >= 0 && context < lineCount) {
+				visible[context] = true;
 			}
 		}
-		// Batch up show to minimize calls
-		// Seems a bit smoother to show/hide each group instead of
-		// hiding all then showing groups even though that means more calls
-		SA::Line startGroup = 0;
-		bool state = true;
-		for (SA::Line line = 0; line < lineCount; line++) {
-			if (state != visible[line]) {
-				if (state) {
-					pSci->ShowLines(startGroup, line - 1);
-				} else {
-					pSci->HideLines(startGroup, line - 1);
-				}
-				startGroup = line;
-				state = visible[line];
+	}
+	// Batch up show to minimize calls
+	// Seems a bit smoother to show/hide each group instead of
+	// hiding all then showing groups even though that means more calls
+	SA::Line startGroup = 0;
+	bool state = true;
+	for (SA::Line line = 0; line < lineCount; line++) {
+		if (state != visible[line]) {
+			if (state) {
+				pSci->ShowLines(startGroup, line - 1);
+			} else {
+				pSci->HideLines(startGroup, line - 1);
 			}
+			startGroup = line;
+			state = visible[line];
 		}
-		if (state) {
-			pSci->ShowLines(startGroup, lineCount - 1);
-		} else {
-			pSci->HideLines(startGroup, lineCount - 1);
-		}
+	}
+	if (state) {
+		pSci->ShowLines(startGroup, lineCount - 1);
+	} else {
+		pSci->HideLines(startGroup, lineCount - 1);
 	}
 }
 
-void MatchMarker::Stop() noexcept {
+void MatchMarker::Stop() {
+	if (searchBackground && pSci) {
+		pSci->SearchAllCancel(searchBackground);
+	}
+	searchBackground = 0;
+	restartBackground = false;
+	waiting = false;
 	pSci = nullptr;
 	lineRanges.clear();
 }
+
+void MatchMarker::DocumentModified(const SA::ScintillaCall *pSciModified, SA::Position position, SA::Line linesAdded) {
+	if ((pSci != pSciModified) || lineRanges.empty()) {
+		return;
+	}
+	// Move the lines still to be searched to follow the modification
+	const SA::Line line = pSci->LineFromPosition(position);
+	const auto moved = [line, linesAdded](SA::Line lineRange) noexcept {
+		return (lineRange > line) ? std::max(lineRange + linesAdded, line) : lineRange;
+	};
+	for (LineRange &lineRange : lineRanges) {
+		lineRange.lineStart = moved(lineRange.lineStart);
+		lineRange.lineEnd = moved(lineRange.lineEnd);
+	}
+	lineRanges.erase(std::remove_if(lineRanges.begin(), lineRanges.end(), [](const LineRange &lineRange) noexcept {
+		return lineRange.lineStart >= lineRange.lineEnd;
+	}), lineRanges.end());
+	// Scintilla discards the matches of a background search when the text is modified
+	// so search lineRanges[0] again from the next call to Continue
+	if (searchBackground) {
+		searchBackground = 0;
+		waiting = false;
+		restartBackground = !lineRanges.empty();
+	}
+}
@@ -26,14 +26,36 @@ class MatchMarker {
 	std::optional<Scintilla::Line> showContext;
 	std::vector<LineRange> lineRanges;
 	std::set<Scintilla::Line> matches;
+	// Documents at least this long are searched on a thread. 0 turns this off.
+	Scintilla::Position backgroundSize;
+	bool background;
+	// Identifies the search of lineRanges[0] on a thread by Scintilla, 0 when not searching
+	int searchBackground;
+	// The search on a thread was stopped by a modification and should be started again
+	bool restartBackground;
+	// The search on a thread had no matches ready when last continued
+	bool waiting;
+	void StartBackground();
+	void ContinueBackground();
+	void MarkMatch(Scintilla::Span rangeFound);
+	void ShowContext();
 public:
 	MatchMarker();	// Not noexcept as std::vector constructor throws
+	// Deleted so MatchMarker objects can not be copied.
+	MatchMarker(const MatchMarker &) = delete;
+	MatchMarker(MatchMarker &&) = delete;
+	MatchMarker &operator=(const MatchMarker &) = delete;
+	MatchMarker &operator=(MatchMarker &&) = delete;
+	~MatchMarker();
+	void SetBackgroundSize(Scintilla::Position backgroundSize_) noexcept;
 	void StartMatch(Scintilla::ScintillaCall *pSci_,
 			const std::string &textMatch_, Scintilla::FindOption flagsMatch_, int styleMatch_,
 			int indicator_, int bookMark_, std::optional<Scintilla::Line> showContext_={});
 	bool Complete() const noexcept;
+	bool Waiting() const noexcept;
 	void Continue();
-	void Stop() noexcept;
+	void Stop();
+	void DocumentModified(const Scintilla::ScintillaCall *pSciModified, Scintilla::Position position, Scintilla::Line linesAdded);
 };
 
 #endif
@@ -36,6 +36,7 @@
 
 #include "ScintillaTypes.h"
 #include "ScintillaMessages.h"
+#include "ScintillaStructures.h"
 #include "ScintillaCall.h"
 
 #include "Scintilla.h"
@@ -1251,6 +1252,9 @@ intptr_t SciTEBase::DoReplaceAll(bool inSelection) {
 	if ((posFind >= 0) && (posFind <= rangeSearch.end)) {
 		SA::Position lastMatch = posFind;
 		intptr_t replacements = 0;
+		// Literal replacements are collected while searching the unchanged document then
+		// performed together which is much faster than replacing each match as found.
+		std::vector<SA::TextReplacement> replacementRanges;
 		wEditor.BeginUndoAction();
 		// Replacement loop
 		while (posFind >= 0) {
@@ -1280,7 +1284,9 @@ intptr_t SciTEBase::DoReplaceAll(bool inSelection) {
 			if (regExp) {
 				lenReplaced = wEditor.ReplaceTargetRE(replaceTarget);
 			} else {
-				wEditor.ReplaceTarget(replaceTarget);
+				replacementRanges.push_back({ {posFind, posFind + lenTarget}, replaceTarget.c_str(), lenReplaced });
+				// Document is not changed until all matches found
+				lenReplaced = lenTarget;
 			}
 			// Modify for change caused by replacement
 			rangeSearch.end += lenReplaced - lenTarget;
@@ -1298,6 +1304,15 @@ intptr_t SciTEBase::DoReplaceAll(bool inSelection) {
 			}
 			replacements++;
 		}
+		if (!replacementRanges.empty()) {
+			wEditor.ReplaceRanges(replacementRanges.size(), replacementRanges.data());
+			SA::Position delta = 0;
+			for (const SA::TextReplacement &replacement : replacementRanges) {
+				delta += replacement.length - (replacement.chrg.cpMax - replacement.chrg.cpMin);
+			}
+			rangeSearch.end += delta;
+			lastMatch += delta;
+		}
 		if (inSelection) {
 			if (countSelections == 1)
 				SetSelection(rangeSearch.start, rangeSearch.end);
@@ -3952,6 +3967,11 @@ void SciTEBase::Modified(const SCNotification *notification) {
 		FlagIsSet(modificationType, SA::ModificationFlags::DeleteText);
 	if ((notification->nmhdr.idFrom == IDM_SRCWIN) && textWasModified)
 		CurrentBuffer()->DocumentModified();
+	if (textWasModified) {
+		const GUI::ScintillaWindow *pwModified = (notification->nmhdr.idFrom == IDM_SRCWIN) ? &wEditor : &wOutput;
+		findMarker.DocumentModified(pwModified, notification->position, notification->linesAdded);
+		matchMarker.DocumentModified(pwModified, notification->position, notification->linesAdded);
+	}
 	if (FlagIsSet(modificationType, SA::ModificationFlags::LastStepInUndoRedo)) {
 		// When the user hits undo or redo, several normal insert/delete
 		// notifications may fire, but we will end up here in the end
@@ -4311,15 +4331,29 @@ void SciTEBase::SetIdler(bool on) {
 	needIdle = on;
 }
 
+void SciTEBase::SetIdlerAfter(int /* milliseconds */) {
+	SetIdler(true);
+}
+
 void SciTEBase::OnIdle() {
+	// When a search on a thread has no matches ready, stop idling for a while instead of polling
+	constexpr int waitMilliseconds = 20;
 	if (!findMarker.Complete()) {
 		wEditor.SetRedraw(false);
 		findMarker.Continue();
 		wEditor.SetRedraw(true);
+		if (findMarker.Waiting()) {
+			SetIdler(false);
+			SetIdlerAfter(waitMilliseconds);
+		}
 		return;
 	}
 	if (!matchMarker.Complete()) {
 		matchMarker.Continue();
+		if (matchMarker.Waiting()) {
+			SetIdler(false);
+			SetIdlerAfter(waitMilliseconds);
+		}
 		return;
 	}
 	SetIdler(false);
@@ -77,6 +77,7 @@ public:
 };
 
 struct FileWorker;
+template <typename Item> class GrepPipeline;
 
 // Scintilla documents can only be released by calling a method on a Scintilla
 // instance so store a Scintilla instance in the release functor
@@ -600,6 +601,10 @@ protected:
 	bool OpenSelected();
 	void Revert();
 	std::string_view TextAsView();
+	FilePath LexerCacheDirectory();
+	std::string LexerCacheSettings();
+	void LoadLexerCache();
+	void SaveLexerCache();
 	FilePath SaveName(const char *ext) const;
 	enum SaveFlags {
 		sfNone = 0, 		// Default
@@ -895,6 +900,8 @@ protected:
 	virtual void TimerEnd(int mask);
 	void OnTimer();
 	virtual void SetIdler(bool on);
+	// Turn the idler on after a delay
+	virtual void SetIdlerAfter(int milliseconds);
 	void OnIdle();
 
 	void SetHomeProperties();
@@ -913,7 +920,7 @@ protected:
 	void OpenFromStdin(bool UseOutputPane);
 	void OpenFilesFromStdin();
 	virtual bool GrepIntoDirectory(const FilePath &directory);
-	void GrepRecursive(GrepFlags gf, const FilePath &baseDir, const char *searchString,
+	bool GrepRecursive(GrepFlags gf, const FilePath &baseDir, GrepPipeline<FilePath> &pipeline,
 		GUI::gui_string_view fileTypes, GUI::gui_string_view excludedTypes);
 	void InternalGrep(GrepFlags gf, const FilePath &directory, GUI::gui_string_view fileTypes, GUI::gui_string_view excludedTypes,
 			  std::string_view search, SA::Position &originalEnd);
@@ -980,6 +980,8 @@ void SciTEBase::Close(bool updateUI, bool loadingSession, bool makingRoomForNew)
 		extender->OnClose(filePath.AsUTF8().c_str());
 	}
 
+	SaveLexerCache();
+
 	if (buffers.size() == 1) {
 		// With no buffer list, Close means close from MRU
 		closingLast = !(recentFileStack[0].IsSet());
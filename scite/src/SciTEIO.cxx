@@ -20,19 +20,25 @@
 #include <string_view>
 #include <vector>
 #include <map>
+#include <deque>
 #include <set>
 #include <optional>
 #include <algorithm>
 #include <memory>
+#include <functional>
 #include <chrono>
+#include <system_error>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 
 #include <fcntl.h>
 
 #include "ILoader.h"
 
 #include "ScintillaTypes.h"
+#include "ScintillaStructures.h"
 #include "ScintillaCall.h"
 
 #include "GUI.h"
@@ -54,6 +60,8 @@
 #include "Searcher.h"
 #include "SciTEBase.h"
 #include "Utf8_16.h"
+#include "LexerCache.h"
+#include "Grep.h"
 
 #if defined(GTK)
 const GUI::gui_char propUserFileName[] = GUI_TEXT(".SciTEUser.properties");
@@ -281,6 +289,8 @@ void SciTEBase::OpenCurrentFile(long long fileSize, bool suppressMessage, bool a
 		wEditor.SetReadOnly(true);
 		assert(CurrentBufferConst()->pFileWorker == nullptr);
 		Scintilla::ILoader *pdocLoad;
+		const long long sizeMapped = props.GetLongLong("file.size.mapped");
+		const bool mapped = sizeMapped && (fileSize > sizeMapped);
 		try {
 			SA::DocumentOption docOptions = SA::DocumentOption::Default;
 
@@ -293,6 +303,11 @@ void SciTEBase::OpenCurrentFile(long long fileSize, bool suppressMessage, bool a
 				docOptions = static_cast<SA::DocumentOption>(
 						     static_cast<int>(docOptions) | static_cast<int>(SA::DocumentOption::StylesNone));
 
+			const long long sizeLazyStyles = props.GetLongLong("file.size.lazy.styles");
+			if (sizeLazyStyles && (fileSize > sizeLazyStyles))
+				docOptions = static_cast<SA::DocumentOption>(
+						     static_cast<int>(docOptions) | static_cast<int>(SA::DocumentOption::StylesLazy));
+
 			pdocLoad = static_cast<Scintilla::ILoader *>(
 					   wEditor.CreateLoader(static_cast<SA::Position>(fileSize) + 1000,
 								docOptions));
@@ -300,7 +315,7 @@ void SciTEBase::OpenCurrentFile(long long fileSize, bool suppressMessage, bool a
 			wEditor.SetStatus(SA::Status::Ok);
 			return;
 		}
-		CurrentBuffer()->pFileWorker = std::make_unique<FileLoader>(this, pdocLoad, filePath, static_cast<size_t>(fileSize), fp);
+		CurrentBuffer()->pFileWorker = std::make_unique<FileLoader>(this, pdocLoad, filePath, static_cast<size_t>(fileSize), fp, mapped);
 		CurrentBuffer()->pFileWorker->sleepTime = props.GetInt("asynchronous.sleep");
 		PerformOnNewThread(CurrentBuffer()->pFileWorker.get());
 	} else {
@@ -418,6 +433,7 @@ void SciTEBase::CompleteOpen(OpenCompletion oc) {
 	} else {
 		wEditor.SetSavePoint();
 	}
+	LoadLexerCache();
 	if (props.GetInt("fold.on.open") > 0) {
 		FoldAll();
 	}
@@ -831,6 +847,184 @@ std::string_view SciTEBase::TextAsView() {
 	return std::string_view(documentMemory, length);
 }
 
+namespace {
+
+LexerCacheKey LexerCacheKeyFor(std::string_view text, std::string_view settings) noexcept {
+	LexerCacheKey key;
+	key.contentHash = HashBytes(text);
+	key.contentLength = text.length();
+	key.settingsHash = HashBytes(settings);
+	return key;
+}
+
+// These lexers remember information about earlier lines outside the document, such
+// as the cpp lexer's preprocessor definitions, which restoring styles does not recreate.
+constexpr const char *lexersWithHiddenState[] = {
+	"abl", "cpp", "cppnocase", "python", "sql", "verilog",
+};
+
+bool LexerKeepsHiddenState(const std::string &language, const std::string &excluded) {
+	for (const char *lexer : lexersWithHiddenState) {
+		if (language == lexer) {
+			return true;
+		}
+	}
+	for (const std::string &lexer : StringSplit(excluded, ' ')) {
+		if (language == lexer) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
+
+// Returns the directory to cache lexer results for the current document or an
+// empty path when the cache is not used.
+FilePath SciTEBase::LexerCacheDirectory() {
+	const FilePath directory(GUI::StringFromUTF8(props.GetExpandedString("lexer.cache.directory")));
+	if (!directory.IsSet() || !directory.IsDirectory()) {
+		return FilePath();
+	}
+	if ((language == "null") || StartsWith(language, "script_") || filePath.IsUntitled()) {
+		return FilePath();
+	}
+	if (LexerKeepsHiddenState(language, props.GetExpandedString("lexer.cache.exclude"))) {
+		return FilePath();
+	}
+	if (wEditor.Length() < props.GetLongLong("file.size.lexer.cache", 1000000)) {
+		return FilePath();
+	}
+	return directory;
+}
+
+// Everything apart from the text that may change the results of lexing.
+std::string SciTEBase::LexerCacheSettings() {
+	const std::string fileNameForExtension = ExtensionFileName();
+	// Lexers may style differently after an upgrade or when another Lexilla is loaded
+	std::string settings = "SciTE " VERSION_SCITE " Lexilla " VERSION_LEXILLA "\n";
+	settings += props.GetExpandedString("lexilla.path");
+	settings += "\n";
+	settings += language;
+	settings += "\ncode.page=";
+	settings += StdStringFromInteger(codePage);
+	for (int wl = 0; wl <= SA::KeywordsetMax; wl++) {
+		std::string kwk = "keywords";
+		if (wl > 0) {
+			kwk += StdStringFromInteger(wl + 1);
+		}
+		kwk += '.';
+		settings += "\n";
+		settings += props.GetNewExpandString(kwk.c_str(), fileNameForExtension.c_str());
+	}
+	for (const unsigned char subStyleBase : wEditor.SubStyleBases()) {
+		const int subStyles = wEditor.SubStylesLength(subStyleBase);
+		settings += "\nsubstyles=";
+		settings += StdStringFromInteger(subStyleBase) + "." + StdStringFromInteger(subStyles);
+		for (int subStyle = 0; subStyle < subStyles; subStyle++) {
+			std::string ssWordsKey = "substylewords.";
+			ssWordsKey += StdStringFromInteger(subStyleBase);
+			ssWordsKey += ".";
+			ssWordsKey += StdStringFromInteger(subStyle + 1);
+			ssWordsKey += ".";
+			settings += "\n";
+			settings += props.GetNewExpandString(ssWordsKey.c_str(), fileNameForExtension.c_str());
+		}
+	}
+	const std::string propertyNames = wEditor.PropertyNames();
+	for (const std::string &name : StringSplit(propertyNames, '\n')) {
+		if (!name.empty()) {
+			settings += "\n";
+			settings += name;
+			settings += "=";
+			settings += wEditor.Property(name.c_str());
+		}
+	}
+	return settings;
+}
+
+// Restore the styles, line states, and fold levels saved by SaveLexerCache for a
+// document with the same text and lexer settings so it does not need to be lexed.
+void SciTEBase::LoadLexerCache() {
+	const FilePath directory = LexerCacheDirectory();
+	if (!directory.IsSet()) {
+		return;
+	}
+	const LexerCacheKey key = LexerCacheKeyFor(TextAsView(), LexerCacheSettings());
+	const FilePath pathCache(directory, FilePath(key.FileName()));
+	if (!pathCache.Exists()) {
+		return;
+	}
+	LexerCacheEntry entry;
+	const bool read = ReadLexerCache(pathCache, key, entry);
+	const SA::Line lines = static_cast<SA::Line>(entry.lineStates.size());
+	if (!read || (lines > wEditor.LineCount()) ||
+		(static_cast<SA::Position>(entry.styles.length()) != wEditor.LineStart(lines))) {
+		// Invalid or damaged so remove to allow a fresh file to be saved
+		pathCache.Remove();
+		return;
+	}
+	// When the styles stop before the end, lexing continues from there as usual
+	wEditor.StartStyling(0, 0);
+	wEditor.SetStylingEx(static_cast<SA::Position>(entry.styles.length()), entry.styles.data());
+	for (SA::Line line = 0; line < lines; line++) {
+		const int lineState = entry.lineStates[line];
+		if (lineState != 0) {
+			wEditor.SetLineState(line, lineState);
+		}
+		const SA::FoldLevel level = static_cast<SA::FoldLevel>(entry.foldLevels[line]);
+		if (level != SA::FoldLevel::Base) {
+			wEditor.SetFoldLevel(line, level);
+		}
+	}
+}
+
+// Only documents that match their file are saved as only those can be found again
+// when the file is reopened. The lines styled so far are saved and replace a cache
+// file that covers fewer of them.
+void SciTEBase::SaveLexerCache() {
+	const Buffer *buffer = CurrentBufferConst();
+	if (!buffer || buffer->isDirty || buffer->pFileWorker || (buffer->lifeState != Buffer::LifeState::opened)) {
+		return;
+	}
+	const FilePath directory = LexerCacheDirectory();
+	if (!directory.IsSet()) {
+		return;
+	}
+	// Only whole lines are saved so lexing can continue from a line start when restored
+	const SA::Position endStyled = wEditor.EndStyled();
+	const SA::Line lines = (endStyled >= wEditor.Length()) ? wEditor.LineCount() : wEditor.LineFromPosition(endStyled);
+	const SA::Position length = wEditor.LineStart(lines);
+	if (length <= 0) {
+		return;
+	}
+	const LexerCacheKey key = LexerCacheKeyFor(TextAsView(), LexerCacheSettings());
+	const FilePath pathCache(directory, FilePath(key.FileName()));
+	if (pathCache.Exists() && (LexerCacheStyledLength(pathCache, key) >= static_cast<uint64_t>(length))) {
+		return;
+	}
+
+	LexerCacheEntry entry;
+	entry.styles.reserve(length);
+	constexpr SA::Position blockLength = 0x10000;
+	std::vector<char> styledText(blockLength * 2 + 2);
+	for (SA::Position position = 0; position < length; position += blockLength) {
+		const SA::Position end = std::min(position + blockLength, length);
+		SA::TextRangeFull tr { { position, end }, styledText.data() };
+		wEditor.GetStyledTextFull(&tr);
+		for (SA::Position i = 0; i < end - position; i++) {
+			entry.styles.push_back(styledText[i * 2 + 1]);
+		}
+	}
+	entry.lineStates.reserve(lines);
+	entry.foldLevels.reserve(lines);
+	for (SA::Line line = 0; line < lines; line++) {
+		entry.lineStates.push_back(wEditor.LineState(line));
+		entry.foldLevels.push_back(static_cast<int>(wEditor.FoldLevel(line)));
+	}
+	WriteLexerCache(pathCache, key, entry);
+}
+
 void SciTEBase::CheckReload() {
 	if (props.GetInt("load.on.activate")) {
 		// Make a copy of fullPath as otherwise it gets aliased in Open
@@ -963,6 +1157,14 @@ SciTEBase::SaveResult SciTEBase::SaveIfUnsureAll() {
 		}
 	}
 
+	if (!props.GetExpandedString("lexer.cache.directory").empty()) {
+		// Save the lexing of each buffer so it can be restored when reopened
+		for (BufferIndex k = 0; k < buffers.lengthVisible; k++) {
+			SetDocumentAt(k);
+			SaveLexerCache();
+		}
+	}
+
 	// Any buffers that have been read but not marked read should be marked
 	// read and their loaders deleted
 	for (Buffer &buffer : buffers.buffers) {
@@ -1435,173 +1637,33 @@ void SciTEBase::OpenFilesFromStdin() {
 		Open(FilePath());
 }
 
-class BufferedFile {
-	FileHolder fp;
-	bool readAll;
-	bool exhausted;
-	enum {bufLen = 64 * 1024};
-	char buffer[bufLen];
-	size_t pos;
-	size_t valid;
-	void EnsureData() noexcept {
-		if (pos >= valid) {
-			if (readAll || !fp) {
-				exhausted = true;
-			} else {
-				valid = fread(buffer, 1, bufLen, fp.get());
-				if (valid < bufLen) {
-					readAll = true;
-				}
-				pos = 0;
-			}
-		}
-	}
-public:
-	explicit BufferedFile(const FilePath &fPath) : fp(fPath.Open(fileRead)) {
-		readAll = false;
-		exhausted = !fp;
-		buffer[0] = 0;
-		pos = 0;
-		valid = 0;
-	}
-	bool Exhausted() const noexcept {
-		return exhausted;
-	}
-	int NextByte() noexcept {
-		EnsureData();
-		if (pos >= valid) {
-			return 0;
-		}
-		return buffer[pos++];
-	}
-	bool BufferContainsNull() noexcept {
-		EnsureData();
-		for (size_t i = 0; i < valid; i++) {
-			if (buffer[i] == '\0')
-				return true;
-		}
-		return false;
-	}
-};
-
-class FileReader {
-	std::unique_ptr<BufferedFile> bf;
-	int lineNum;
-	bool lastWasCR;
-	std::string lineToCompare;
-	std::string lineToShow;
-	bool caseSensitive;
-public:
-	FileReader(const FilePath &fPath, bool caseSensitive_) : bf(std::make_unique<BufferedFile>(fPath)) {
-		lineNum = 0;
-		lastWasCR = false;
-		caseSensitive = caseSensitive_;
-	}
-	// Deleted so FileReader objects can not be copied.
-	FileReader(const FileReader &) = delete;
-	const char *Next() {
-		if (bf->Exhausted()) {
-			return nullptr;
-		}
-		lineToShow.clear();
-		while (!bf->Exhausted()) {
-			const int ch = bf->NextByte();
-			if (lastWasCR && ch == '\n' && lineToShow.empty()) {
-				lastWasCR = false;
-			} else if (ch == '\r' || ch == '\n') {
-				lastWasCR = ch == '\r';
-				break;
-			} else {
-				lineToShow.push_back(static_cast<char>(ch));
-			}
-		}
-		lineNum++;
-		lineToCompare = lineToShow;
-		if (!caseSensitive) {
-			LowerCaseAZ(lineToCompare);
-		}
-		return lineToCompare.c_str();
-	}
-	int LineNumber() const noexcept {
-		return lineNum;
-	}
-	const char *Original() const noexcept {
-		return lineToShow.c_str();
-	}
-	bool BufferContainsNull() noexcept {
-		return bf->BufferContainsNull();
-	}
-};
-
-constexpr bool IsWordCharacter(int ch) noexcept {
-	return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z')  || (ch >= '0' && ch <= '9')  || (ch == '_');
-}
-
 bool SciTEBase::GrepIntoDirectory(const FilePath &directory) {
 	const GUI::gui_char *sDirectory = directory.AsInternal();
 	return sDirectory[0] != '.';
 }
 
-void SciTEBase::GrepRecursive(GrepFlags gf, const FilePath &baseDir, const char *searchString,
+// Walks the directory tree queueing files to be searched in the same order as they are to be reported.
+bool SciTEBase::GrepRecursive(GrepFlags gf, const FilePath &baseDir, GrepPipeline<FilePath> &pipeline,
 	GUI::gui_string_view fileTypes, GUI::gui_string_view excludedTypes) {
-	constexpr int checkAfterLines = 10'000;
 	FilePathSet directories;
 	FilePathSet files;
 	baseDir.List(directories, files);
-	const size_t searchLength = strlen(searchString);
-	std::string os;
 	for (const FilePath &fPath : files) {
-		if (jobQueue.Cancelled())
-			return;
 		if ((fileTypes.empty() || fPath.Matches(fileTypes)) &&
 			((excludedTypes.empty() || !fPath.Matches(excludedTypes)))) {
-			//OutputAppendStringSynchronised(fPath.AsUTF8().c_str());
-			//OutputAppendStringSynchronised("\n");
-			FileReader fr(fPath, FlagIsSet(gf, GrepFlags::matchCase));
-			if (FlagIsSet(gf, GrepFlags::binary) || !fr.BufferContainsNull()) {
-				while (const char *line = fr.Next()) {
-					if (((fr.LineNumber() % checkAfterLines) == 0) && jobQueue.Cancelled())
-						return;
-					const char *match = strstr(line, searchString);
-					if (match) {
-						if (FlagIsSet(gf, GrepFlags::wholeWord)) {
-							const char *lineEnd = line + strlen(line);
-							while (match) {
-								if (((match == line) || !IsWordCharacter(match[-1])) &&
-										((match + searchLength == (lineEnd)) || !IsWordCharacter(match[searchLength]))) {
-									break;
-								}
-								match = strstr(match + 1, searchString);
-							}
-						}
-						if (match) {
-							os.append(fPath.AsUTF8());
-							os.append(":");
-							std::string lNumber = StdStringFromInteger(fr.LineNumber());
-							os.append(lNumber);
-							os.append(":");
-							os.append(fr.Original());
-							os.append("\n");
-						}
-					}
-				}
-			}
-		}
-	}
-	if (os.length()) {
-		if (FlagIsSet(gf, GrepFlags::stdOut)) {
-			fwrite(os.c_str(), os.length(), 1, stdout);
-		} else {
-			OutputAppendStringSynchronised(os.c_str());
+			if (!pipeline.Add(fPath))
+				return false;
 		}
 	}
 	for (const FilePath &fPath : directories) {
 		if (FlagIsSet(gf, GrepFlags::dot) || GrepIntoDirectory(fPath.Name())) {
 			if ((excludedTypes.empty() || !fPath.Matches(excludedTypes))) {
-				GrepRecursive(gf, fPath, searchString, fileTypes, excludedTypes);
+				if (!GrepRecursive(gf, fPath, pipeline, fileTypes, excludedTypes))
+					return false;
 			}
 		}
 	}
+	return true;
 }
 
 void SciTEBase::InternalGrep(GrepFlags gf, const FilePath &directory, GUI::gui_string_view fileTypes, GUI::gui_string_view excludedTypes,
@@ -1619,11 +1681,30 @@ void SciTEBase::InternalGrep(GrepFlags gf, const FilePath &directory, GUI::gui_s
 		ShowOutputOnMainThread();
 		originalEnd += os.length();
 	}
-	std::string searchString(search);
-	if (!FlagIsSet(gf, GrepFlags::matchCase)) {
-		LowerCaseAZ(searchString);
-	}
-	GrepRecursive(gf, directory, searchString.c_str(), fileTypes, excludedTypes);
+	const LiteralMatcher matcher(search, FlagIsSet(gf, GrepFlags::matchCase));
+	const std::function<bool()> cancelled = [this]() {
+		return jobQueue.Cancelled();
+	};
+	GrepPipeline<FilePath> pipeline(cancelled, [this, gf](const std::string &os) {
+		if (FlagIsSet(gf, GrepFlags::stdOut)) {
+			fwrite(os.c_str(), os.length(), 1, stdout);
+		} else {
+			OutputAppendStringSynchronised(os.c_str());
+		}
+	});
+	// Files are searched on worker threads while this thread walks the directories.
+	GrepConcurrently<FilePath>(pipeline, std::max(1U, std::thread::hardware_concurrency()),
+		[&]() {
+			GrepRecursive(gf, directory, pipeline, fileTypes, excludedTypes);
+		},
+		[&](const FilePath &fPath) {
+			FileHolder fp(fPath.Open(fileRead));
+			if (!fp) {
+				return std::string();
+			}
+			return GrepFile(fp.get(), fPath.AsUTF8(), matcher,
+				FlagIsSet(gf, GrepFlags::wholeWord), FlagIsSet(gf, GrepFlags::binary), cancelled);
+		});
 	if (!FlagIsSet(gf, GrepFlags::stdOut)) {
 		std::string sExitMessage(">");
 		if (jobQueue.TimeCommands()) {
@@ -1302,6 +1302,7 @@ void SciTEBase::ReadProperties() {
 
 	idleStyling = static_cast<SA::IdleStyling>(props.GetInt("idle.styling", static_cast<int>(SA::IdleStyling::None)));
 	wEditor.SetIdleStyling(idleStyling);
+	wEditor.SetIdleStylingThreaded(props.GetInt("idle.styling.threaded"));
 	wOutput.SetIdleStyling(static_cast<SA::IdleStyling>(props.GetInt("output.idle.styling", static_cast<int>(SA::IdleStyling::None))));
 
 	if (props.GetInt("os.x.home.end.keys")) {
@@ -1528,6 +1529,10 @@ void SciTEBase::ReadProperties() {
 	SetElementColour(SA::Element::FoldLine, "fold.line.colour");
 	SetElementColour(SA::Element::HiddenLine, "hidden.line.colour");
 
+	const SA::Position markBackgroundSize = props.GetLongLong("find.mark.background.size");
+	findMarker.SetBackgroundSize(markBackgroundSize);
+	matchMarker.SetBackgroundSize(markBackgroundSize);
+
 	currentWordHighlight.isEnabled = props.GetInt("highlight.current.word", 0) == 1;
 	if (currentWordHighlight.isEnabled) {
 		const std::string highlightCurrentWordIndicatorString = props.GetExpandedString("highlight.current.word.indicator");
@@ -481,6 +481,84 @@ std::string UnicodeUnEscape(std::string_view s) {
 	return result;
 }
 
+LiteralMatcher::LiteralMatcher(std::string_view search, bool caseSensitive_) :
+	needle(search), caseSensitive(caseSensitive_) {
+	if (!caseSensitive) {
+		LowerCaseAZ(needle);
+	}
+	if (!needle.empty()) {
+		firstLower = needle.front();
+		firstUpper = caseSensitive ? firstLower : MakeUpperCase(firstLower);
+		last = needle.back();
+	}
+}
+
+size_t LiteralMatcher::Length() const noexcept {
+	return needle.length();
+}
+
+bool LiteralMatcher::MatchesAt(const char *candidate) const noexcept {
+	const size_t length = needle.length();
+	if (caseSensitive) {
+		return (candidate[length - 1] == last) && (memcmp(candidate, needle.data(), length) == 0);
+	}
+	if (MakeLowerCase(candidate[length - 1]) != last) {
+		return false;
+	}
+	for (size_t i = 1; i < length - 1; i++) {
+		if (MakeLowerCase(candidate[i]) != needle[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const char *LiteralMatcher::ByteScan::Next(char ch, const char *start, const char *end) noexcept {
+	if (next && (next >= start)) {
+		// There is no occurrence between start and next
+		return (next < end) ? next : nullptr;
+	}
+	// When nothing was found, the text up to scanned does not need to be read again
+	const char *from = (!next && scanned && (scanned > start)) ? scanned : start;
+	next = (from < end) ? static_cast<const char *>(memchr(from, ch, end - from)) : nullptr;
+	scanned = end;
+	return next;
+}
+
+const char *LiteralMatcher::Find(const char *start, const char *end) const noexcept {
+	FindState state;
+	return Find(start, end, state);
+}
+
+const char *LiteralMatcher::Find(const char *start, const char *end, FindState &state) const noexcept {
+	const size_t length = needle.length();
+	if (length == 0) {
+		return start;
+	}
+	if (static_cast<size_t>(end - start) < length) {
+		return nullptr;
+	}
+	const char *const endStart = end - length + 1;
+	const char *p = start;
+	while (p < endStart) {
+		const char *candidate = state.lower.Next(firstLower, p, endStart);
+		if (firstUpper != firstLower) {
+			const char *candidateUpper = state.upper.Next(firstUpper, p, endStart);
+			if (candidateUpper && (!candidate || (candidateUpper < candidate))) {
+				candidate = candidateUpper;
+			}
+		}
+		if (!candidate) {
+			return nullptr;
+		}
+		if (MatchesAt(candidate)) {
+			return candidate;
+		}
+		p = candidate + 1;
+	}
+	return nullptr;
+}
+
 ComboMemory::ComboMemory(size_t sz_) : sz(sz_) {
 }
 
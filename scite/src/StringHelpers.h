@@ -156,6 +156,40 @@ public:
 	virtual GUI::gui_string Text(std::string_view sv, bool retainIfNotFound=true) const = 0;
 };
 
+/**
+ * LiteralMatcher finds a literal string in text. When case insensitive, only ASCII A-Z
+ * are folded as is done by LowerCaseAZ. Candidate positions are found with memchr on
+ * the first byte (in both cases when folding) and filtered on the last byte before
+ * comparing the whole string.
+ */
+
+class LiteralMatcher {
+	std::string needle;
+	bool caseSensitive;
+	char firstLower = 0;
+	char firstUpper = 0;
+	char last = 0;
+	bool MatchesAt(const char *candidate) const noexcept;
+public:
+	// The next position of one byte and how far the text has been scanned for it.
+	struct ByteScan {
+		const char *next = nullptr;
+		const char *scanned = nullptr;
+		const char *Next(char ch, const char *start, const char *end) noexcept;
+	};
+	// Remembers where each case of the first byte occurs so that a sequence of calls to Find
+	// over one block of text, with start never decreasing, reads the text only once.
+	struct FindState {
+		ByteScan lower;
+		ByteScan upper;
+	};
+	LiteralMatcher(std::string_view search, bool caseSensitive_);
+	size_t Length() const noexcept;
+	// Returns the first match starting in [start, end) and lying entirely before end or nullptr.
+	const char *Find(const char *start, const char *end) const noexcept;
+	const char *Find(const char *start, const char *end, FindState &state) const noexcept;
+};
+
 /**
  * ComboMemory is a fixed length list of strings suitable for display in combo boxes
  * as a memory of user entries.
@@ -0,0 +1,30 @@
+# Build the SciTE benchmarks with Microsoft Visual C++ using nmake
+# Tested with Visual C++ 2019
+# The harness is shared with the Scintilla benchmarks in scintilla/test/bench
+
+DEL = del /q
+EXE = benchmark.exe
+
+SCINTILLA = ../../../scintilla
+
+INCLUDEDIRS = /I../../src /I$(SCINTILLA)/include /I$(SCINTILLA)/src /I$(SCINTILLA)/test/bench
+
+CXXFLAGS = /MP /EHsc /std:c++17 /O2 /DNDEBUG /nologo /wd 4805 $(INCLUDEDIRS)
+
+# Files in this directory containing benchmarks and the harness
+BENCHSRC=bench*.cxx $(SCINTILLA)/test/bench/bench.cxx
+# Files being measured from scite/src directory
+BENCHEDSRC=\
+ ../../src/Grep.cxx \
+ ../../src/StringHelpers.cxx
+
+all: $(EXE)
+
+bench: $(EXE)
+	$(EXE)
+
+clean:
+	$(DEL) $(EXE) *.o *.obj *.exe
+
+$(EXE): $(BENCHSRC) $(BENCHEDSRC)
+	$(CXX) $(CXXFLAGS) /Fe$@ $**
@@ -0,0 +1,146 @@
+/** @file benchGrep.cxx
+ ** Benchmarks for SciTE's internal grep over a synthetic directory tree.
+ **/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <deque>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <system_error>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <filesystem>
+
+#include "GUI.h"
+#include "StringHelpers.h"
+#include "Grep.h"
+
+#include "Bench.h"
+
+namespace {
+
+constexpr int directories = 20;
+constexpr int filesPerDirectory = 40;
+constexpr size_t linesPerFile = 4000;
+
+// The tree is written once to a temporary directory, removed when the benchmark exits.
+class Tree {
+	std::filesystem::path root;
+public:
+	std::vector<std::string> files;
+	size_t bytes = 0;
+	Tree() {
+		root = std::filesystem::temp_directory_path() / "benchGrep";
+		std::filesystem::remove_all(root);
+		uint32_t seed = 1;
+		for (int directory = 0; directory < directories; directory++) {
+			const std::filesystem::path path = root / ("d" + std::to_string(directory));
+			std::filesystem::create_directories(path);
+			for (int file = 0; file < filesPerDirectory; file++) {
+				const std::string fileName = (path / ("f" + std::to_string(file) + ".cxx")).string();
+				const std::string text = Bench::GenerateText(linesPerFile, seed++);
+				FILE *fp = fopen(fileName.c_str(), "wb");
+				if (!fp) {
+					throw std::runtime_error("Can not write " + fileName);
+				}
+				fwrite(text.data(), 1, text.length(), fp);
+				fclose(fp);
+				files.push_back(fileName);
+				bytes += text.length();
+			}
+		}
+	}
+	~Tree() {
+		std::error_code ec;
+		std::filesystem::remove_all(root, ec);
+	}
+};
+
+const Tree &SyntheticTree() {
+	static const Tree tree;
+	return tree;
+}
+
+void GrepTree(Bench::Run &run, std::string_view search, bool caseSensitive, bool wholeWord, unsigned int threadCount) {
+	const Tree &tree = SyntheticTree();
+	const LiteralMatcher matcher(search, caseSensitive);
+	const std::function<bool()> cancelled = []() {
+		return false;
+	};
+	size_t output = 0;
+	GrepPipeline<std::string> pipeline(cancelled, [&output](const std::string &os) {
+		output += os.length();
+	});
+	run.Time(tree.bytes, [&]() {
+		GrepConcurrently<std::string>(pipeline, threadCount,
+			[&]() {
+				for (const std::string &file : tree.files) {
+					pipeline.Add(file);
+				}
+			},
+			[&](const std::string &file) {
+				FILE *fp = fopen(file.c_str(), "rb");
+				if (!fp) {
+					return std::string();
+				}
+				std::string os = GrepFile(fp, file, matcher, wholeWord, false, cancelled);
+				fclose(fp);
+				return os;
+			});
+	});
+	Bench::Consume(output);
+}
+
+unsigned int Threads() noexcept {
+	return std::max(1U, std::thread::hardware_concurrency());
+}
+
+void Sequential(Bench::Run &run) {
+	// No searcher threads so all files are searched after the walk as before threading
+	GrepTree(run, "42 nullptr", true, false, 0);
+}
+
+void SequentialCaseInsensitive(Bench::Run &run) {
+	// Many lines match so each block is searched with many calls to LiteralMatcher::Find
+	GrepTree(run, "NULLPTR", false, false, 0);
+}
+
+void OneThread(Bench::Run &run) {
+	GrepTree(run, "42 nullptr", true, false, 1);
+}
+
+void Threaded(Bench::Run &run) {
+	GrepTree(run, "42 nullptr", true, false, Threads());
+}
+
+void ThreadedCaseInsensitive(Bench::Run &run) {
+	GrepTree(run, "NULLPTR", false, false, Threads());
+}
+
+void ThreadedWholeWord(Bench::Run &run) {
+	GrepTree(run, "line", true, true, Threads());
+}
+
+const Bench::Registrar registrars[] = {
+	{ "Grep/Tree/Sequential", Sequential },
+	{ "Grep/Tree/SequentialCaseInsensitive", SequentialCaseInsensitive },
+	{ "Grep/Tree/OneThread", OneThread },
+	{ "Grep/Tree/Threaded", Threaded },
+	{ "Grep/Tree/ThreadedCaseInsensitive", ThreadedCaseInsensitive },
+	{ "Grep/Tree/ThreadedWholeWord", ThreadedWholeWord },
+};
+
+}
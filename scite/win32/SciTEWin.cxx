@@ -2170,7 +2170,12 @@ LRESULT SciTEWin::WndProc(UINT iMessage, WPARAM wParam, LPARAM lParam) {
 			break;
 
 		case WM_TIMER:
-			OnTimer();
+			if (wParam == idlerAfterID) {
+				::KillTimer(MainHWND(), idlerAfterID);
+				SetIdler(true);
+			} else {
+				OnTimer();
+			}
 			break;
 
 		case WM_DROPFILES:
@@ -105,6 +105,9 @@ constexpr int SCITE_DROP = WM_APP + 1;
 constexpr int SCITE_WORKER = WM_APP + 2;
 constexpr int SCITE_SHOWOUTPUT = WM_APP + 3;
 
+// Timers on the main window
+enum { tickerID = 100, idlerAfterID = 101 };
+
 enum {
 	WORK_EXECUTE = WORK_PLATFORM + 1
 };
@@ -239,6 +242,7 @@ protected:
 
 	void TimerStart(int mask) override;
 	void TimerEnd(int mask) override;
+	void SetIdlerAfter(int milliseconds) override;
 
 	void ShowOutputOnMainThread() override;
 	void SizeContentWindows() override;
@@ -371,8 +371,6 @@ void SciTEWin::ActivateWindow(const char *) {
 	// This does nothing as, on Windows, you can no longer activate yourself
 }
 
-enum { tickerID = 100 };
-
 void SciTEWin::TimerStart(int mask) {
 	const int maskNew = timerMask | mask;
 	if (timerMask != maskNew) {
@@ -394,6 +392,10 @@ void SciTEWin::TimerEnd(int mask) {
 	}
 }
 
+void SciTEWin::SetIdlerAfter(int milliseconds) {
+	::SetTimer(HwndOf(wSciTE), idlerAfterID, milliseconds, nullptr);
+}
+
 void SciTEWin::ShowOutputOnMainThread() {
 	::PostMessage(MainHWND(), SCITE_SHOWOUTPUT, 0, 0);
 }
@@ -391,6 +391,11 @@ FileWorker.obj: \
 	../src/Worker.h \
 	../src/FileWorker.h \
 	../src/Utf8_16.h
+Grep.obj: \
+	../src/Grep.cxx \
+	../src/GUI.h \
+	../src/StringHelpers.h \
+	../src/Grep.h
 IFaceTable.obj: \
 	../src/IFaceTable.cxx \
 	../src/GUI.h \
@@ -404,6 +409,11 @@ JobQueue.obj: \
 	../src/PropSetFile.h \
 	../src/SciTE.h \
 	../src/JobQueue.h
+LexerCache.obj: \
+	../src/LexerCache.cxx \
+	../src/GUI.h \
+	../src/FilePath.h \
+	../src/LexerCache.h
 LuaExtension.obj: \
 	../src/LuaExtension.cxx \
 	../../scintilla/include/ScintillaTypes.h \
@@ -464,6 +474,7 @@ SciTEBase.obj: \
 	../../scintilla/include/Sci_Position.h \
 	../../scintilla/include/ScintillaTypes.h \
 	../../scintilla/include/ScintillaMessages.h \
+	../../scintilla/include/ScintillaStructures.h \
 	../../scintilla/include/ScintillaCall.h \
 	../../scintilla/include/Scintilla.h \
 	../../lexilla/include/SciLexer.h \
@@ -514,6 +525,7 @@ SciTEIO.obj: \
 	../../scintilla/include/ILoader.h \
 	../../scintilla/include/Sci_Position.h \
 	../../scintilla/include/ScintillaTypes.h \
+	../../scintilla/include/ScintillaStructures.h \
 	../../scintilla/include/ScintillaCall.h \
 	../src/GUI.h \
 	../src/ScintillaWindow.h \
@@ -532,7 +544,9 @@ SciTEIO.obj: \
 	../src/MatchMarker.h \
 	../src/Searcher.h \
 	../src/SciTEBase.h \
-	../src/Utf8_16.h
+	../src/Utf8_16.h \
+	../src/LexerCache.h \
+	../src/Grep.h
 SciTEProps.obj: \
 	../src/SciTEProps.cxx \
 	../../scintilla/include/ILexer.h \
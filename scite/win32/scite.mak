@@ -84,8 +84,10 @@ SHAREDOBJS=\
 	FilePath.obj \
 	FileWorker.obj \
 	GUIWin.obj \
+	Grep.obj \
 	IFaceTable.obj \
 	JobQueue.obj \
+	LexerCache.obj \
 	LexillaAccess.obj \
 	MatchMarker.obj \
 	MultiplexExtension.obj \